@@ -0,0 +1,318 @@
+// Server-authoritative pong for opted-in game rooms
+//
+// Players only send inputs; the server runs the match at a fixed tick and
+// broadcasts compact snapshots, so neither client can stall or cheat the
+// other. Every room's state lives in one slot of a set of typed arrays
+// (struct-of-arrays, dense: a removed room's slot is filled with the last
+// one) and a single timer steps all rooms in one pass, so a process can host
+// thousands of matches without a timer or object graph per match.
+//
+// Wire format (binary, little-endian):
+//   input     [0x49 'I'][u8 buttons (1: up, 2: down)][i16 touchY, -1: none]
+//   snapshot  [0x53 'S'][u8 state][u32 frame][i16 paddle0][i16 paddle1]
+//             [i16 ballX][i16 ballY][i8 velX][i8 velY][u8 score0][u8 score1][u16 reserved]
+// JSON clients may send {type: 'input', buttons, touchY} instead.
+
+const WebSocket = require('ws');
+const spectators = require('./spectators');
+
+const TICK_HZ = parseInt(process.env.AUTHORITY_TICK_HZ) || 60;
+const SNAPSHOT_EVERY = parseInt(process.env.AUTHORITY_SNAPSHOT_EVERY) || 2; // ticks per snapshot
+const MAX_CATCHUP_TICKS = 5;  // after a stall, drop time rather than burst
+
+// Mirrors frontend/src/templates/multiplayer-pong/game/game.c, whose
+// authoritative mode renders these snapshots: game_start carries the speeds
+// and score limit (simInfo()) and the client warns if its build differs
+const WIDTH = 640;
+const HEIGHT = 480;
+const PADDLE_W = 10;
+const PADDLE_H = 80;
+const PADDLE_X = [20, WIDTH - 20 - PADDLE_W];
+const BALL = 10;
+const BALL_SPEED = 4;
+const PADDLE_SPEED = 5;
+const MAX_SCORE = 6;
+const GOAL_DELAY = 60;
+const VICTORY_HOLD = 180;     // ticks before the match restarts
+
+// GameState values from game.h
+const STATE_PLAYING = 1;
+const STATE_SCORE = 2;
+const STATE_VICTORY = 3;
+
+const INPUT_UP = 0x01;
+const INPUT_DOWN = 0x02;
+
+const MSG_INPUT = 0x49;       // 'I'
+const MSG_SNAPSHOT = 0x53;    // 'S'
+const INPUT_SIZE = 4;
+const SNAPSHOT_SIZE = 20;
+
+const INITIAL_CAPACITY = 64;
+
+class Authority {
+  constructor() {
+    this.count = 0;
+    this.rooms = [];          // slot -> room (for sending)
+    this.tickCount = 0;
+    this.timer = null;
+    this.lastTime = 0;
+    this.accumulator = 0;
+    this.tickMs = 0;          // smoothed cost of one pass over all rooms
+    this._allocate(INITIAL_CAPACITY);
+  }
+
+  _allocate(capacity) {
+    const old = this.capacity ? this : null;
+    const fields = {
+      frame: Uint32Array, state: Uint8Array, delay: Uint8Array, rng: Uint32Array,
+      ballX: Int16Array, ballY: Int16Array, velX: Int8Array, velY: Int8Array,
+    };
+    const pairs = {           // two per room, [slot * 2 + player]
+      paddleY: Int16Array, score: Uint8Array, buttons: Uint8Array, touchY: Int16Array,
+    };
+
+    for (const [name, Type] of Object.entries(fields)) {
+      const arr = new Type(capacity);
+      if (old) arr.set(old[name]);
+      this[name] = arr;
+    }
+    for (const [name, Type] of Object.entries(pairs)) {
+      const arr = new Type(capacity * 2);
+      if (old) arr.set(old[name]);
+      this[name] = arr;
+    }
+    this.capacity = capacity;
+  }
+
+  // ----------------------------------------------------------------------------
+  // Rooms
+  // ----------------------------------------------------------------------------
+
+  addRoom(room) {
+    if (room._authSlot !== undefined) return;
+    if (this.count === this.capacity) this._allocate(this.capacity * 2);
+
+    const i = this.count++;
+    this.rooms[i] = room;
+    room._authSlot = i;
+
+    this._resetMatch(i, (Math.random() * 0xffffffff) >>> 0 || 1);
+    this.buttons[i * 2] = this.buttons[i * 2 + 1] = 0;
+    this.touchY[i * 2] = this.touchY[i * 2 + 1] = -1;
+
+    if (!this.timer) this._start();
+  }
+
+  removeRoom(room) {
+    const i = room._authSlot;
+    if (i === undefined) return;
+    delete room._authSlot;
+
+    // Swap-remove: keep the live slots dense
+    const last = --this.count;
+    if (i !== last) {
+      this._copySlot(i, last);
+      this.rooms[i] = this.rooms[last];
+      this.rooms[i]._authSlot = i;
+    }
+    this.rooms[last] = undefined;
+
+    if (this.count === 0) this._stop();
+  }
+
+  _copySlot(dst, src) {
+    for (const name of ['frame', 'state', 'delay', 'rng', 'ballX', 'ballY', 'velX', 'velY']) {
+      this[name][dst] = this[name][src];
+    }
+    for (const name of ['paddleY', 'score', 'buttons', 'touchY']) {
+      this[name][dst * 2] = this[name][src * 2];
+      this[name][dst * 2 + 1] = this[name][src * 2 + 1];
+    }
+  }
+
+  // ----------------------------------------------------------------------------
+  // Input
+  // ----------------------------------------------------------------------------
+
+  input(room, playerIndex, buttons, touchY) {
+    const i = room._authSlot;
+    if (i === undefined || (playerIndex !== 0 && playerIndex !== 1)) return;
+    const touch = Number.isFinite(touchY) ? Math.max(-1, Math.min(HEIGHT - PADDLE_H, touchY | 0)) : -1;
+    this.buttons[i * 2 + playerIndex] = buttons & (INPUT_UP | INPUT_DOWN);
+    this.touchY[i * 2 + playerIndex] = touch;
+  }
+
+  // Binary message from a player of an authoritative room
+  handleMessage(ws, room, data) {
+    if (!Buffer.isBuffer(data) || data.length !== INPUT_SIZE || data[0] !== MSG_INPUT) return false;
+    this.input(room, ws._authIndex, data[1], data.readInt16LE(2));
+    return true;
+  }
+
+  // ----------------------------------------------------------------------------
+  // Simulation
+  // ----------------------------------------------------------------------------
+
+  _random(i) {
+    let x = this.rng[i];
+    x ^= x << 13; x >>>= 0;
+    x ^= x >>> 17;
+    x ^= x << 5; x >>>= 0;
+    this.rng[i] = x;
+    return x;
+  }
+
+  _resetBall(i) {
+    this.ballX[i] = (WIDTH - BALL) >> 1;
+    this.ballY[i] = (HEIGHT - BALL) >> 1;
+    this.velX[i] = this.velY[i] = 0;
+  }
+
+  _serve(i) {
+    this.state[i] = STATE_PLAYING;
+    this.velX[i] = (this._random(i) & 1) ? BALL_SPEED : -BALL_SPEED;
+    this.velY[i] = (this._random(i) & 1) ? BALL_SPEED : -BALL_SPEED;
+  }
+
+  _resetMatch(i, seed) {
+    if (seed !== undefined) this.rng[i] = seed;
+    this.frame[i] = 0;
+    this.paddleY[i * 2] = this.paddleY[i * 2 + 1] = (HEIGHT - PADDLE_H) >> 1;
+    this.score[i * 2] = this.score[i * 2 + 1] = 0;
+    this._resetBall(i);
+    this._serve(i);
+  }
+
+  _goal(i, scorer) {
+    const s = ++this.score[i * 2 + scorer];
+    this._resetBall(i);
+    if (s >= MAX_SCORE) {
+      this.state[i] = STATE_VICTORY;
+      this.delay[i] = VICTORY_HOLD;
+    } else {
+      this.state[i] = STATE_SCORE;
+      this.delay[i] = GOAL_DELAY;
+    }
+  }
+
+  _step(i) {
+    const state = this.state[i];
+
+    if (state !== STATE_VICTORY) {
+      for (let p = i * 2; p < i * 2 + 2; p++) {
+        let y = this.touchY[p] >= 0
+          ? this.touchY[p]
+          : this.paddleY[p] + (((this.buttons[p] & INPUT_DOWN) !== 0) - ((this.buttons[p] & INPUT_UP) !== 0)) * PADDLE_SPEED;
+        this.paddleY[p] = y < 0 ? 0 : (y > HEIGHT - PADDLE_H ? HEIGHT - PADDLE_H : y);
+      }
+    }
+
+    if (state === STATE_PLAYING) {
+      const x = this.ballX[i] += this.velX[i];
+      const y = this.ballY[i] += this.velY[i];
+
+      if (y <= 0 || y + BALL >= HEIGHT) this.velY[i] = this.velY[i] > 0 ? -BALL_SPEED : BALL_SPEED;
+
+      for (let p = 0; p < 2; p++) {
+        const py = this.paddleY[i * 2 + p];
+        const hit = x < PADDLE_X[p] + PADDLE_W && x + BALL > PADDLE_X[p] && y < py + PADDLE_H && y + BALL > py;
+        if (hit && p === 0 && this.velX[i] < 0) this.velX[i] = BALL_SPEED;
+        if (hit && p === 1 && this.velX[i] > 0) this.velX[i] = -BALL_SPEED;
+      }
+
+      if (x < -BALL) this._goal(i, 1);
+      else if (x > WIDTH) this._goal(i, 0);
+    } else if (state === STATE_SCORE) {
+      if (--this.delay[i] === 0) this._serve(i);
+    } else if (state === STATE_VICTORY) {
+      if (--this.delay[i] === 0) this._resetMatch(i);
+    }
+
+    this.frame[i]++;
+  }
+
+  _snapshot(i) {
+    const buf = Buffer.allocUnsafe(SNAPSHOT_SIZE);
+    buf[0] = MSG_SNAPSHOT;
+    buf[1] = this.state[i];
+    buf.writeUInt32LE(this.frame[i], 2);
+    buf.writeInt16LE(this.paddleY[i * 2], 6);
+    buf.writeInt16LE(this.paddleY[i * 2 + 1], 8);
+    buf.writeInt16LE(this.ballX[i], 10);
+    buf.writeInt16LE(this.ballY[i], 12);
+    buf.writeInt8(this.velX[i], 14);
+    buf.writeInt8(this.velY[i], 15);
+    buf[16] = this.score[i * 2];
+    buf[17] = this.score[i * 2 + 1];
+    buf.writeUInt16LE(0, 18);   // reserved
+    return buf;
+  }
+
+  // ----------------------------------------------------------------------------
+  // Tick loop
+  // ----------------------------------------------------------------------------
+
+  _start() {
+    this.lastTime = performance.now();
+    this.accumulator = 0;
+    this.timer = setInterval(() => this._tick(), 1000 / TICK_HZ);
+    console.log(`[Authority] Tick loop started (${TICK_HZ} Hz, snapshot every ${SNAPSHOT_EVERY} ticks)`);
+  }
+
+  _stop() {
+    clearInterval(this.timer);
+    this.timer = null;
+    console.log('[Authority] Tick loop stopped (no rooms)');
+  }
+
+  _tick() {
+    const start = performance.now();
+    const dt = 1000 / TICK_HZ;
+    this.accumulator = Math.min(this.accumulator + start - this.lastTime, dt * MAX_CATCHUP_TICKS);
+    this.lastTime = start;
+
+    let snapshot = false;
+    while (this.accumulator >= dt) {
+      this.accumulator -= dt;
+      for (let i = 0; i < this.count; i++) this._step(i);
+      if (++this.tickCount % SNAPSHOT_EVERY === 0) snapshot = true;
+    }
+
+    if (snapshot) {
+      for (let i = 0; i < this.count; i++) {
+        const room = this.rooms[i];
+        const buf = this._snapshot(i);
+        for (const player of room.players) {
+          if (player.readyState === WebSocket.OPEN) player.send(buf);
+        }
+        spectators.publishSnapshot(room, buf);   // same Buffer, sent at the spectator rate
+      }
+    }
+
+    this.tickMs += (performance.now() - start - this.tickMs) * 0.1;
+  }
+
+  // What a client needs to check it renders the same game, and at what rate
+  // (sent in game_start; stats() is for /health only)
+  simInfo() {
+    return {
+      ballSpeed: BALL_SPEED,
+      paddleSpeed: PADDLE_SPEED,
+      maxScore: MAX_SCORE,
+      tickHz: TICK_HZ,
+      snapshotEvery: SNAPSHOT_EVERY
+    };
+  }
+
+  stats() {
+    return {
+      rooms: this.count,
+      tickHz: TICK_HZ,
+      snapshotEvery: SNAPSHOT_EVERY,
+      tickMs: Math.round(this.tickMs * 1000) / 1000
+    };
+  }
+}
+
+module.exports = new Authority();
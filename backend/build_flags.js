@@ -0,0 +1,76 @@
+// emcc flags per build kind, shared by the workers and the build-time predictor
+
+// Default emcc flags for simple builds
+const DEFAULT_FLAGS = [
+    '-sUSE_SDL=2',
+    '-sALLOW_MEMORY_GROWTH=1',
+    '-sEXPORTED_RUNTIME_METHODS=[cwrap,addFunction,wasmMemory,wasmTable]',
+    '-sWASM_BIGINT',
+    '-O0',
+];
+
+// Default flags for live-coding MAIN module
+const MAIN_MODULE_FLAGS = [
+    '-sUSE_SDL=2',
+    '-sMAIN_MODULE=1',
+    '-sEXPORT_ALL=1',
+    '-sFORCE_FILESYSTEM=1',
+    '-sALLOW_MEMORY_GROWTH=1',
+    '-sEXPORTED_RUNTIME_METHODS=[cwrap,addFunction,wasmMemory,wasmTable]',
+    '-sWASM_BIGINT',
+    '-O0',
+];
+
+// Default flags for live-coding GAME module (side module)
+const GAME_MODULE_FLAGS = [
+    '-sUSE_SDL=2',
+    '-sSIDE_MODULE=2',
+    '-O0',
+];
+
+/**
+ * Flags and output file for a job, and what kind of link it is:
+ * 'side' (SIDE_MODULE), 'main' (MAIN_MODULE) or 'program'
+ */
+function resolveBuild(job) {
+    let flags;
+    let outputFile;
+
+    if (job.buildProfile && job.buildProfile.args) {
+        flags = job.buildProfile.args.filter(arg =>
+            arg !== job.entry && !arg.match(/^[a-zA-Z_][a-zA-Z0-9_]*\.(c|cpp|h|hpp)$/)
+        );
+
+        const oIndex = flags.indexOf('-o');
+        if (oIndex !== -1 && flags[oIndex + 1]) {
+            outputFile = flags[oIndex + 1];
+            flags.splice(oIndex, 2);
+        } else {
+            outputFile = 'index.js';
+        }
+    } else {
+        const isGameModule = job.entry && (
+            job.entry.includes('game/game.c') ||
+            job.entry.includes('game.wasm')
+        );
+
+        if (isGameModule) {
+            flags = [...GAME_MODULE_FLAGS];
+            outputFile = 'game.wasm';
+        } else if (job.files.some(f => f.path.includes('game/'))) {
+            flags = [...MAIN_MODULE_FLAGS];
+            outputFile = 'index.js';
+        } else {
+            flags = [...DEFAULT_FLAGS];
+            outputFile = 'index.js';
+        }
+    }
+
+    const kind = flags.some(f => f.startsWith('-sSIDE_MODULE')) ? 'side'
+        : flags.some(f => f.startsWith('-sMAIN_MODULE')) ? 'main'
+            : 'program';
+
+    return { flags, outputFile, kind };
+}
+
+module.exports = { DEFAULT_FLAGS, MAIN_MODULE_FLAGS, GAME_MODULE_FLAGS, resolveBuild };
@@ -0,0 +1,126 @@
+// Build-time predictor
+//
+// Estimates how long a job will take to build from what is known when it is
+// queued, so the queue can run short jobs first and tell the client when to
+// expect its build. One linear model per build kind (side module, MAIN_MODULE
+// link, plain program; their costs differ by an order of magnitude) over:
+//
+//   source KB, file count, asset KB, optimization level, emscripten ports,
+//   and how likely the emscripten cache is cold for this flag set
+//
+// The cache term: a flag set that has built successfully n times before is
+// taken as warm with probability n / (n + 1). The models start from rough
+// priors and learn online (normalized LMS) from every successful build.
+
+const { resolveBuild } = require('./build_flags');
+
+const MIN_MS = 100;
+const MAX_MS = 5 * 60 * 1000;
+const LEARNING_RATE = 0.2;
+const ERROR_SMOOTHING = 0.1;
+const MAX_SIGNATURES = 1000;
+
+const SOURCE_RE = /\.(c|cc|cpp|cxx|h|hpp)$/;
+
+// Weights, ms: [base, per 10 KB source, per 10 files, per opt level, cold cache, per port, per MB assets]
+const PRIORS = {
+    side: [500, 100, 100, 300, 500, 0, 500],
+    main: [5000, 300, 200, 1500, 3000, 500, 1000],
+    program: [2000, 300, 200, 1500, 3000, 500, 1000]
+};
+
+function optLevel(flags) {
+    for (const flag of flags) {
+        const m = /^-O([0-3sz])$/.exec(flag);
+        if (m) return /[sz]/.test(m[1]) ? 2 : Number(m[1]);
+    }
+    return 0;
+}
+
+class BuildPredictor {
+    constructor() {
+        this.models = {};
+        for (const [kind, weights] of Object.entries(PRIORS)) {
+            this.models[kind] = { weights: [...weights], samples: 0, meanAbsError: 0 };
+        }
+        this.signatures = new Map();   // flag set -> successful builds
+    }
+
+    /**
+     * Features and predicted time for a job (before it runs)
+     */
+    estimate(job) {
+        const { flags, kind } = resolveBuild(job);
+        const compiler = /\.(cc|cpp|cxx)$/.test(job.entry || '') ? 'em++' : 'emcc';
+        const signature = `${compiler} ${[...flags].sort().join(' ')}`;
+
+        let sourceBytes = 0;
+        let assetBytes = 0;
+        for (const file of job.files || []) {
+            const size = file.isBase64 ? Math.floor((file.content?.length || 0) * 3 / 4) : (file.content?.length || 0);
+            if (!file.isBase64 && SOURCE_RE.test(file.path || '')) sourceBytes += size;
+            else assetBytes += size;
+        }
+
+        const seen = this.signatures.get(signature) || 0;
+        const features = [
+            1,
+            sourceBytes / 10240,
+            (job.files?.length || 0) / 10,
+            optLevel(flags),
+            1 / (seen + 1),
+            flags.filter(f => /^-sUSE_\w+=(?!0)/.test(f)).length,
+            assetBytes / (1024 * 1024)
+        ];
+
+        return { kind, signature, features, ms: this._predict(kind, features) };
+    }
+
+    _predict(kind, features) {
+        const weights = this.models[kind].weights;
+        let ms = 0;
+        for (let i = 0; i < features.length; i++) ms += weights[i] * features[i];
+        return Math.round(Math.min(MAX_MS, Math.max(MIN_MS, ms)));
+    }
+
+    /**
+     * Learn from a successful build
+     */
+    observe(estimate, actualMs) {
+        const model = this.models[estimate?.kind];
+        if (!model || !(actualMs > 0)) return;
+
+        const { features } = estimate;
+        let predicted = 0;
+        for (let i = 0; i < features.length; i++) predicted += model.weights[i] * features[i];
+        const error = actualMs - predicted;
+
+        let norm = 0;
+        for (const x of features) norm += x * x;
+        for (let i = 0; i < features.length; i++) {
+            model.weights[i] += LEARNING_RATE * error * features[i] / norm;
+        }
+
+        model.samples++;
+        model.meanAbsError += (Math.abs(error) - model.meanAbsError) * (model.samples === 1 ? 1 : ERROR_SMOOTHING);
+
+        if (!this.signatures.has(estimate.signature) && this.signatures.size >= MAX_SIGNATURES) {
+            this.signatures.delete(this.signatures.keys().next().value);
+        }
+        this.signatures.set(estimate.signature, (this.signatures.get(estimate.signature) || 0) + 1);
+    }
+
+    getStats() {
+        const stats = {};
+        for (const [kind, model] of Object.entries(this.models)) {
+            stats[kind] = {
+                samples: model.samples,
+                meanAbsErrorMs: Math.round(model.meanAbsError),
+                baseMs: Math.round(model.weights[0])
+            };
+        }
+        return stats;
+    }
+}
+
+module.exports = { BuildPredictor };
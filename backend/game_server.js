@@ -0,0 +1,687 @@
+// Game server - hybrid multiplayer (binary + JSON)
+//
+// Matchmaking and the relay for multiplayer games, kept off the build
+// server's event loop. server.js hands WebSocket upgrades to createHost():
+//
+//   GAME_WORKERS=0   everything runs in the server.js process (default)
+//   GAME_WORKERS=N   N game worker processes (cluster), this file is their
+//                    entry point. The primary keeps the room directory
+//                    (room_directory.js) and passes each upgraded socket over
+//                    IPC to the worker that owns its room: ?room=<id> goes to
+//                    the room's owner, ?match=binary|quick|quick-auth to a
+//                    worker with a player waiting in that queue, else the
+//                    least loaded one. Only clients that say where they are
+//                    going can be paired across workers, so this is opt-in.
+//
+// A client that asks a worker to join a room hosted elsewhere is told to
+// reconnect with ?room=<id>. list_rooms reads the directory, so it covers
+// every worker, one page at a time.
+//
+// Any JSON client can watch a JSON room with {type: 'spectate', roomId}
+// (same ?room= routing); spectators get the match at a lower rate, see
+// spectators.js. Binary auto-match rooms can't be watched.
+
+const cluster = require('cluster');
+const path = require('path');
+const WebSocket = require('ws');
+const authority = require('./authority');
+const outbox = require('./outbox');
+const spectators = require('./spectators');
+const recorder = require('./relay_recorder');
+const { LocalDirectory, IpcDirectory } = require('./room_directory');
+
+const STATS_INTERVAL = 2000;     // worker -> primary load/health reports
+const RESPAWN_DELAY = 1000;
+
+const wssGame = new WebSocket.Server({ noServer: true });
+
+/**
+ * FIFO of waiting sockets as a doubly-linked list threaded through the
+ * sockets themselves (ws._waitNode), so a disconnect leaves its queue in
+ * O(1) and matching never scans. A socket is in at most one queue.
+ */
+class WaitQueue {
+  constructor(key) {
+    this.key = key;           // directory key, see reportWaiting()
+    this.head = null;
+    this.tail = null;
+    this.length = 0;
+  }
+
+  push(ws) {
+    if (ws._waitNode) ws._waitNode.queue.remove(ws);
+    const node = { ws, queue: this, prev: this.tail, next: null };
+    if (this.tail) this.tail.next = node;
+    else this.head = node;
+    this.tail = node;
+    ws._waitNode = node;
+    this.length++;
+  }
+
+  remove(ws) {
+    const node = ws._waitNode;
+    if (!node || node.queue !== this) return false;
+    if (node.prev) node.prev.next = node.next;
+    else this.head = node.next;
+    if (node.next) node.next.prev = node.prev;
+    else this.tail = node.prev;
+    delete ws._waitNode;
+    this.length--;
+    return true;
+  }
+
+  // Oldest open socket other than `ws`, removed from the queue (closed ones
+  // normally leave on 'close', any found here are dropped)
+  takeOpponent(ws) {
+    while (this.head) {
+      const opponent = this.head.ws;
+      this.remove(opponent);
+      if (opponent !== ws && opponent.readyState === WebSocket.OPEN) return opponent;
+    }
+    return null;
+  }
+}
+
+// Set by createHost() / runWorker()
+let directory = null;
+let processTag = 'p0';           // makes generated room ids unique across workers
+
+// Room-based game sessions (for JSON clients)
+const gameRooms = new Map();     // roomId -> { players: Set, spectators: Set, state: 'waiting'|'playing', authoritative }
+const playerToRoom = new Map();  // ws -> roomId
+
+// Waiting players, by matchmaking queue (O(1) push/take/remove, see WaitQueue)
+const quickQueue = new WaitQueue('quick');           // JSON quick match, relay
+const quickAuthQueue = new WaitQueue('quick-auth');  // JSON quick match, authoritative
+const binaryQueue = new WaitQueue('binary');         // legacy SDL_Net auto-match
+
+function logDirectoryError(err) {
+  console.error('[GameServer] Directory error:', err.message);
+}
+
+// Publishes a room's joinable state to the directory
+function syncRoom(room) {
+  directory.request('update', room.id, { players: room.players.size, state: room.state }).catch(logDirectoryError);
+}
+
+function sendJson(ws, msg) {
+  if (ws.readyState === WebSocket.OPEN) ws.send(JSON.stringify(msg));
+}
+
+// A room this process doesn't host: tell the client where it is, if anywhere
+function replyRoomElsewhere(ws, roomId) {
+  directory.request('lookup', roomId).then(owner => {
+    const message = owner === null ? 'Room not found'
+      : 'Room is hosted by another game process, reconnect with ?room=' + encodeURIComponent(roomId);
+    sendJson(ws, { type: 'error', message, roomId, reconnect: owner !== null });
+  }).catch(logDirectoryError);
+}
+
+function generateRoomId(kind) {
+  return `${kind}_${processTag}_${Date.now()}_${Math.random().toString(36).substr(2, 6)}`;
+}
+
+// Players waiting per matchmaking queue, reported when a count changes so
+// the primary can route the next connection of that kind here
+const reportedWaiting = new Map();
+
+function reportWaiting() {
+  for (const queue of [binaryQueue, quickQueue, quickAuthQueue]) {
+    if (reportedWaiting.get(queue.key) === queue.length) continue;
+    reportedWaiting.set(queue.key, queue.length);
+    directory.request('setWaiting', queue.key, queue.length).catch(logDirectoryError);
+  }
+}
+
+/**
+ * Create a new game room. Authoritative rooms are simulated by the server
+ * (authority.js) instead of relaying between the players. `reserved`: the
+ * id is already registered in the directory.
+ */
+function createRoom(roomId, authoritative = false, reserved = false) {
+  if (gameRooms.has(roomId)) return null;
+  const room = {
+    id: roomId,
+    players: new Set(),
+    spectators: new Set(),
+    state: 'waiting',
+    authoritative,
+    createdAt: Date.now()
+  };
+  gameRooms.set(roomId, room);
+  if (!reserved) directory.request('register', roomId).catch(logDirectoryError);
+  console.log(`[GameServer] Room ${roomId} created${authoritative ? ' (authoritative)' : ''}`);
+  return room;
+}
+
+/**
+ * Join a player to a room
+ */
+function joinRoom(ws, roomId) {
+  const room = gameRooms.get(roomId);
+  if (!room) return { error: 'Room not found' };
+  if (room.players.size >= 2) return { error: 'Room is full' };
+  if (room.state === 'playing') return { error: 'Game already in progress' };
+
+  room.players.add(ws);
+  playerToRoom.set(ws, roomId);
+
+  if (room.players.size === 2) {
+    startGame(room);
+  }
+  syncRoom(room);
+
+  return { success: true, room };
+}
+
+/**
+ * Start a game in a room
+ */
+function startGame(room) {
+  room.state = 'playing';
+  const players = Array.from(room.players);
+
+  console.log(`[GameServer] Game started in room ${room.id}`);
+
+  players.forEach((player, index) => {
+    if (player._isJson) {
+      player.send(JSON.stringify({
+        type: 'game_start',
+        roomId: room.id,
+        playerIndex: index,
+        message: 'Match started!',
+        ...(room.authoritative && { authoritative: true, ...authority.simInfo() })
+      }));
+    }
+  });
+  room.spectators.forEach(ws => sendJson(ws, { type: 'game_start', roomId: room.id, spectator: true, authoritative: room.authoritative }));
+
+  // Authoritative: inputs go to the simulation, snapshots come from its tick
+  if (room.authoritative) {
+    players.forEach((player, index) => {
+      player._authIndex = index;
+      player._gameMessageHandler = (data) => authority.handleMessage(player, room, data);
+    });
+    authority.addRoom(room);
+    return;
+  }
+
+  // Set up message forwarding (batched, see outbox.js); spectators keep the
+  // latest state frames, the recorder (if enabled) all of them
+  recorder.start(room, { kind: 'json', players: players.length });
+  players.forEach((player, index) => {
+    const opponent = players[1 - index];
+    player._gameMessageHandler = (data, isBinary) => {
+      recorder.record(room, index, data, isBinary);
+      outbox.send(opponent, data, isBinary);
+      spectators.publishRelay(room, index, data, isBinary);
+    };
+  });
+}
+
+/**
+ * Remove a player from their room
+ */
+function leaveRoom(ws) {
+  spectators.unwatch(ws);
+
+  const roomId = playerToRoom.get(ws);
+  if (!roomId) return;
+
+  const room = gameRooms.get(roomId);
+  if (room) {
+    if (room._recording) {
+      recorder.event(room, { event: 'leave', player: Array.from(room.players).indexOf(ws) });
+      recorder.stop(room);
+    }
+    room.players.delete(ws);
+    if (room.authoritative) authority.removeRoom(room);
+
+    room.players.forEach(player => {
+      if (player.readyState === WebSocket.OPEN) {
+        if (player._isJson) {
+          player.send(JSON.stringify({ type: 'player_left', message: 'Opponent disconnected' }));
+        }
+      }
+    });
+    room.spectators.forEach(spectator => sendJson(spectator, { type: 'player_left', message: 'A player disconnected' }));
+
+    if (room.players.size === 0) {
+      spectators.release(room).forEach(spectator => sendJson(spectator, { type: 'room_closed', roomId }));
+      gameRooms.delete(roomId);
+      directory.request('unregister', roomId).catch(logDirectoryError);
+      console.log(`[GameServer] Room ${roomId} deleted (empty)`);
+    } else {
+      room.state = 'waiting';
+      syncRoom(room);
+    }
+  }
+
+  playerToRoom.delete(ws);
+
+  // Remove from queues
+  if (ws._waitNode) {
+    ws._waitNode.queue.remove(ws);
+    reportWaiting();
+  }
+
+  delete ws._gameMessageHandler;
+  outbox.discard(ws);
+}
+
+/**
+ * Quick match - auto pair JSON players (only with the same authoritative choice)
+ */
+function quickMatch(ws, authoritative = false) {
+  const queue = authoritative ? quickAuthQueue : quickQueue;
+  const opponent = queue.takeOpponent(ws);
+  if (opponent) {
+    reportWaiting();
+    const roomId = generateRoomId('quick');
+    createRoom(roomId, authoritative);
+    joinRoom(opponent, roomId);
+    joinRoom(ws, roomId);
+    return { matched: true, roomId };
+  }
+
+  queue.push(ws);
+  reportWaiting();
+  return { matched: false, message: 'Waiting for opponent...' };
+}
+
+/**
+ * Binary auto-match for SDL_Net clients (legacy mode)
+ */
+function binaryMatch(ws) {
+  const opponent = binaryQueue.takeOpponent(ws);
+  if (opponent) {
+    // Pair them in a room
+    const roomId = generateRoomId('binary');
+    const room = createRoom(roomId);
+    room.binary = true;
+    room.players.add(opponent);
+    room.players.add(ws);
+    playerToRoom.set(opponent, roomId);
+    playerToRoom.set(ws, roomId);
+    room.state = 'playing';
+    syncRoom(room);
+    reportWaiting();
+
+    console.log(`[GameServer] Binary match started in room ${roomId}`);
+
+    // Set up bidirectional forwarding (batched, see outbox.js)
+    recorder.start(room, { kind: 'binary', players: 2 });
+    opponent._gameMessageHandler = (data, isBinary) => {
+      recorder.record(room, 0, data, isBinary);
+      outbox.send(ws, data, isBinary);
+    };
+    ws._gameMessageHandler = (data, isBinary) => {
+      recorder.record(room, 1, data, isBinary);
+      outbox.send(opponent, data, isBinary);
+    };
+
+    return true;
+  }
+
+  binaryQueue.push(ws);
+  reportWaiting();
+  console.log(`[GameServer] Binary player waiting (${binaryQueue.length} in queue)`);
+  return false;
+}
+
+/**
+ * Message channels, told apart by the first byte without decoding:
+ *   text frame, or binary starting with '{'   control, JSON (legacy clients)
+ *   binary starting with TAG_CONTROL          control, JSON after the tag
+ *   anything else                             data, forwarded as-is
+ * Only control messages are parsed; data frames go to the room's handler
+ * as the Buffer ws received, so relaying costs a send and nothing else.
+ * Once a client is known to be binary (SDL_Net), its first byte isn't even
+ * looked at. JSON messages with an unknown type are still relayed, as the
+ * old JSON clients expect.
+ */
+const TAG_CONTROL = 0x01;
+const TAG_JSON = 0x7b; // '{'
+
+function isControlMessage(data, isBinary) {
+  return !isBinary || data[0] === TAG_JSON || data[0] === TAG_CONTROL;
+}
+
+function parseControlMessage(data) {
+  try {
+    const json = data[0] === TAG_CONTROL ? data.subarray(1) : data;
+    return JSON.parse(json.toString());
+  } catch (e) {
+    return null;
+  }
+}
+
+wssGame.on('connection', (ws) => {
+  console.log('[GameServer] Client connected');
+
+  ws.on('error', console.error);
+  ws._isJson = false;
+  ws._firstMessage = true;
+
+  ws.on('message', (data, isBinary) => {
+    // Known binary client: everything is data
+    if (!ws._firstMessage && !ws._isJson) {
+      if (ws._gameMessageHandler) ws._gameMessageHandler(data, isBinary);
+      return;
+    }
+
+    if (isControlMessage(data, isBinary)) {
+      const msg = parseControlMessage(data);
+      if (msg) {
+        ws._firstMessage = false;
+        ws._isJson = true;
+        if (handleJsonMessage(ws, msg)) return;
+      }
+      // Legacy JSON clients relay their own game messages; fall through
+    }
+
+    // First data frame from an unknown client: legacy binary mode, auto-match
+    // (the frame itself is dropped, the opponent isn't known yet)
+    if (ws._firstMessage) {
+      ws._firstMessage = false;
+      console.log('[GameServer] Binary client detected, auto-matching...');
+      binaryMatch(ws);
+      return;
+    }
+
+    if (ws._gameMessageHandler) ws._gameMessageHandler(data, isBinary);
+  });
+
+  ws.on('close', () => {
+    leaveRoom(ws);
+    console.log('[GameServer] Client disconnected');
+  });
+});
+
+// Returns false for messages that aren't control messages (game data)
+function handleJsonMessage(ws, msg) {
+  switch (msg.type) {
+    case 'create': {
+      const roomId = msg.roomId || generateRoomId('room');
+      // Reserve the id across all workers first
+      directory.request('register', roomId).then(registered => {
+        // The creator may have left during the round trip: give the id back
+        if (ws.readyState !== WebSocket.OPEN) {
+          if (registered) directory.request('unregister', roomId).catch(logDirectoryError);
+          return;
+        }
+        const room = registered && createRoom(roomId, !!msg.authoritative, true);
+        if (!room) {
+          ws.send(JSON.stringify({ type: 'error', message: 'Room already exists' }));
+          return;
+        }
+        const result = joinRoom(ws, roomId);
+        ws.send(JSON.stringify({ type: 'room_created', roomId, ...result }));
+      }).catch(logDirectoryError);
+      break;
+    }
+
+    case 'join': {
+      if (!gameRooms.has(msg.roomId)) {
+        replyRoomElsewhere(ws, msg.roomId);
+        break;
+      }
+      const result = joinRoom(ws, msg.roomId);
+      if (result.error) {
+        ws.send(JSON.stringify({ type: 'error', message: result.error }));
+      } else {
+        ws.send(JSON.stringify({ type: 'room_joined', roomId: msg.roomId }));
+      }
+      break;
+    }
+
+    case 'spectate': {
+      const room = gameRooms.get(msg.roomId);
+      if (!room) {
+        replyRoomElsewhere(ws, msg.roomId);
+        break;
+      }
+      // Rollback pong relays only inputs: without the whole stream from the
+      // first frame there is nothing a spectator could show
+      if (room.binary) {
+        ws.send(JSON.stringify({ type: 'error', message: 'Binary rooms cannot be spectated', roomId: room.id }));
+        break;
+      }
+      leaveRoom(ws);
+      if (!spectators.watch(room, ws)) {
+        ws.send(JSON.stringify({ type: 'error', message: 'No spectator seats left' }));
+        break;
+      }
+      ws.send(JSON.stringify({
+        type: 'spectating',
+        roomId: room.id,
+        state: room.state,
+        players: room.players.size,
+        spectators: room.spectators.size,
+        authoritative: room.authoritative
+      }));
+      spectators.catchUp(ws);
+      break;
+    }
+
+    case 'quick_match': {
+      const result = quickMatch(ws, !!msg.authoritative);
+      ws.send(JSON.stringify({
+        type: result.matched ? 'matched' : 'waiting',
+        ...result
+      }));
+      break;
+    }
+
+    case 'list_rooms': {
+      // Paginated: { offset, limit } -> { rooms, total, offset, next }
+      directory.request('list', msg.offset, msg.limit).then(page => {
+        if (ws.readyState === WebSocket.OPEN) ws.send(JSON.stringify({ type: 'room_list', ...page }));
+      }).catch(logDirectoryError);
+      break;
+    }
+
+    case 'input': {
+      const room = gameRooms.get(playerToRoom.get(ws));
+      if (room?.authoritative) authority.input(room, ws._authIndex, msg.buttons | 0, msg.touchY);
+      break;
+    }
+
+    case 'leave': {
+      leaveRoom(ws);
+      ws.send(JSON.stringify({ type: 'left_room' }));
+      break;
+    }
+
+    default:
+      return false;
+  }
+  return true;
+}
+
+function handleUpgrade(request, socket, head) {
+  wssGame.handleUpgrade(request, socket, head, (ws) => {
+    wssGame.emit('connection', ws, request);
+  });
+}
+
+function localStats() {
+  return {
+    connections: wssGame.clients.size,
+    rooms: gameRooms.size,
+    waiting: binaryQueue.length + quickQueue.length + quickAuthQueue.length,
+    authority: authority.stats(),
+    relay: outbox.getStats(),
+    spectators: spectators.getStats(),
+    recorder: recorder.getStats()
+  };
+}
+
+// ============================================================================
+// PROCESS MODEL
+// ============================================================================
+
+/**
+ * Game worker: receives upgraded sockets from the primary
+ */
+function runWorker() {
+  directory = new IpcDirectory(process);
+  processTag = `w${cluster.worker.id}`;
+
+  // Until the primary has seen Node's handle ack it still reads the socket
+  // (and discards what it reads), so the 101 that lets the client start
+  // talking waits for a round trip: 'upgrade-ready' is answered only after
+  // the ack, which went out before this message.
+  const handoffs = new Map();    // upgrade id -> { request, socket, head }
+
+  process.on('message', (msg, socket) => {
+    if (!msg) return;
+    if (msg.cmd === 'upgrade' && socket) {
+      // Enough of an IncomingMessage for ws.handleUpgrade
+      const request = { method: msg.method, url: msg.url, headers: msg.headers };
+      handoffs.set(msg.id, { request, socket, head: Buffer.from(msg.head, 'base64') });
+      process.send({ cmd: 'upgrade-ready', id: msg.id });
+    } else if (msg.cmd === 'upgrade-go') {
+      const handoff = handoffs.get(msg.id);
+      if (!handoff) return;
+      handoffs.delete(msg.id);
+      handleUpgrade(handoff.request, handoff.socket, handoff.head);
+      handoff.socket.resume();
+    }
+  });
+
+  setInterval(() => process.send({ cmd: 'stats', stats: { ...localStats(), cpu: process.cpuUsage() } }), STATS_INTERVAL).unref();
+  console.log(`[GameServer] Worker ${cluster.worker.id} ready (pid ${process.pid})`);
+}
+
+/**
+ * Primary side: forks the game workers, serves the directory and routes
+ * upgrades. Returns { handleUpgrade, stats }.
+ */
+function createHost(workerCount) {
+  const store = new LocalDirectory();
+
+  if (workerCount <= 0) {
+    directory = store.forOwner(0);
+    console.log('[GameServer] Running in-process (GAME_WORKERS=0)');
+    return { handleUpgrade, stats: () => ({ workers: 0, ...localStats() }) };
+  }
+
+  const workers = new Map();     // id -> { worker, stats, routed }
+
+  cluster.setupPrimary({ exec: path.join(__dirname, 'game_server.js') });
+
+  function fork() {
+    const worker = cluster.fork({ GAME_WORKER: '1' });
+    workers.set(worker.id, { worker, stats: null, routed: 0 });
+
+    worker.on('message', (msg) => {
+      if (!msg) return;
+      if (msg.cmd === 'directory') {
+        let reply;
+        try {
+          reply = { cmd: 'directory-reply', id: msg.id, result: store.handle(worker.id, msg.op, msg.args) };
+        } catch (err) {
+          reply = { cmd: 'directory-reply', id: msg.id, error: err.message };
+        }
+        if (worker.isConnected()) worker.send(reply);
+      } else if (msg.cmd === 'upgrade-ready') {
+        if (worker.isConnected()) worker.send({ cmd: 'upgrade-go', id: msg.id });
+      } else if (msg.cmd === 'stats') {
+        const entry = workers.get(worker.id);
+        if (entry) {
+          entry.stats = msg.stats;
+          entry.routed = 0;
+        }
+      }
+    });
+
+    worker.on('exit', (code, signal) => {
+      workers.delete(worker.id);
+      store.dropOwner(worker.id);
+      console.error(`[GameServer] Worker ${worker.id} exited (${signal || code}), respawning`);
+      setTimeout(fork, RESPAWN_DELAY);
+    });
+  }
+
+  for (let i = 0; i < workerCount; i++) fork();
+
+  function load(entry) {
+    return (entry.stats ? entry.stats.connections : 0) + entry.routed;
+  }
+
+  function leastLoaded() {
+    let best = null;
+    for (const [id, entry] of workers) {
+      if (best === null || load(entry) < load(workers.get(best))) best = id;
+    }
+    return best;
+  }
+
+  // Room affinity first, then a worker with someone waiting in this queue.
+  // A connection without ?match= could be anything (a legacy binary client,
+  // a JSON client about to create or list rooms), so it follows a reported
+  // binary waiter but never adds a guess of its own.
+  function route(request) {
+    const params = new URL(request.url, 'http://localhost').searchParams;
+    const roomId = params.get('room');
+    if (roomId) {
+      const owner = store.lookup(roomId);
+      if (owner !== null && workers.has(owner)) return owner;
+      return leastLoaded();
+    }
+
+    const key = params.get('match');
+    if (workers.size === 0) return null;
+    if (!key) {
+      const waiting = store.ownerWaiting('binary');
+      return waiting !== null && workers.has(waiting) ? waiting : leastLoaded();
+    }
+
+    let id = store.ownerWaiting(key);
+    if (id !== null && workers.has(id)) {
+      store.setWaiting(id, key, 0);       // taken; the worker's next report corrects it
+    } else {
+      id = leastLoaded();
+      store.setWaiting(id, key, 1);       // the next one of this kind should meet it there
+    }
+    return id;
+  }
+
+  let nextUpgradeId = 1;
+
+  function routeUpgrade(request, socket, head) {
+    const id = route(request);
+    const entry = id !== null && workers.get(id);
+    if (!entry || !entry.worker.isConnected()) {
+      socket.destroy();
+      return;
+    }
+    entry.routed++;
+    socket.pause();
+    entry.worker.send({
+      cmd: 'upgrade',
+      id: nextUpgradeId++,
+      method: request.method,
+      url: request.url,
+      headers: request.headers,
+      head: head.toString('base64')
+    }, socket);
+  }
+
+  console.log(`[GameServer] Started ${workerCount} game workers`);
+  return {
+    handleUpgrade: routeUpgrade,
+    stats: () => ({
+      workers: workers.size,
+      rooms: store.size,
+      perWorker: Array.from(workers, ([id, entry]) => ({ id, pid: entry.worker.process.pid, ...entry.stats }))
+    })
+  };
+}
+
+if (require.main === module && cluster.isWorker && process.env.GAME_WORKER) {
+  runWorker();
+}
+
+module.exports = { createHost };
@@ -0,0 +1,60 @@
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game_loader.h"
+
+bool game_module_load(GameModule *module, const char *path) {
+    memset(module, 0, sizeof *module);
+
+    // RTLD_LOCAL: a reloaded module must not resolve symbols from the old one
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        fprintf(stderr, "[loader] dlopen(%s): %s\n", path, dlerror());
+        return false;
+    }
+
+    void *sym = dlsym(handle, "update_and_render");
+    if (!sym) {
+        fprintf(stderr, "[loader] %s: no update_and_render export\n", path);
+        dlclose(handle);
+        return false;
+    }
+
+    module->handle = handle;
+    // POSIX guarantees data/function pointer round-trips for dlsym results
+    *(void **)&module->update_and_render = sym;
+
+    // optional: context layout + migration (all three or none)
+    void *layout = dlsym(handle, "js_context_layout");
+    void *layout_size = dlsym(handle, "js_context_layout_size");
+    void *migrate = dlsym(handle, "js_migrate_context");
+    if (layout && layout_size && migrate) {
+        *(void **)&module->context_layout = layout;
+        *(void **)&module->context_layout_size = layout_size;
+        *(void **)&module->migrate_context = migrate;
+    }
+    return true;
+}
+
+void game_module_unload(GameModule *module) {
+    if (module->handle) dlclose(module->handle);
+    memset(module, 0, sizeof *module);
+}
+
+void *game_module_copy_layout(const GameModule *module) {
+    if (!module->context_layout) return NULL;
+    const void *layout = module->context_layout();
+    int size = module->context_layout_size();
+    if (!layout || size <= 0) return NULL;
+
+    void *copy = malloc((size_t)size);
+    if (copy) memcpy(copy, layout, (size_t)size);
+    return copy;
+}
+
+void *game_module_migrate(const GameModule *module, void *ctx, const void *old_layout) {
+    if (!module->migrate_context || !old_layout || !ctx) return ctx;
+    return module->migrate_context(ctx, old_layout);
+}
@@ -0,0 +1,37 @@
+#ifndef GAME_LOADER_H
+#define GAME_LOADER_H
+
+#include <stdbool.h>
+
+// Native counterpart of reload.js: opens the Game shared library and resolves
+// update_and_render. The context is opaque here; hosts own its layout.
+//
+// Games that describe their context (context_layout.h) also export the layout
+// and a migrate function; those are optional and NULL otherwise.
+
+typedef void (*update_and_render_fn)(void *ctx);
+typedef const void *(*context_layout_fn)(void);
+typedef int (*context_layout_size_fn)(void);
+typedef void *(*migrate_context_fn)(void *old_ctx, const void *old_layout);
+
+typedef struct {
+    void *handle;
+    update_and_render_fn update_and_render;
+
+    context_layout_fn context_layout;
+    context_layout_size_fn context_layout_size;
+    migrate_context_fn migrate_context;
+} GameModule;
+
+bool game_module_load(GameModule *module, const char *path);
+void game_module_unload(GameModule *module);
+
+// Copy of the module's context layout (malloc'd, caller frees), NULL if it
+// doesn't export one. Take it before unloading: the layout lives in the module.
+void *game_module_copy_layout(const GameModule *module);
+
+// Hands the context and the previous module's layout to the module; returns
+// the context to keep using (unchanged if there's nothing to migrate)
+void *game_module_migrate(const GameModule *module, void *ctx, const void *old_layout);
+
+#endif
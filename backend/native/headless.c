@@ -0,0 +1,125 @@
+// ----------------------------------------------------------------------------
+// Headless benchmark driver
+//
+// Loads the Game shared library, runs update_and_render for N frames against
+// the stub SDL backend with scripted input, and reports simulation cost
+// (ns/frame) and render submission cost (draw calls/frame). No window, no
+// browser; the virtual clock advances one display frame per iteration.
+//
+//   Headless [--frames N] [--warmup N] [--dt-us N] [--script FILE] [--lib PATH]
+//
+// Input script format: see input_script.h.
+// ----------------------------------------------------------------------------
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_net.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game.h"
+#include "game_loader.h"
+#include "input_script.h"
+#include "sdl_stub.h"
+
+#ifndef GAME_LIBRARY_PATH
+#define GAME_LIBRARY_PATH "./Game.so"
+#endif
+
+// Lives for the whole process, like the one in sdl_app.c (the game may hang
+// its own allocations off it, which the host can't free)
+static GameContext *ctx;
+
+static Uint64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Uint64)ts.tv_sec * 1000000000u + (Uint64)ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    Uint64 x = *(const Uint64 *)a, y = *(const Uint64 *)b;
+    return (x > y) - (x < y);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s [--frames N] [--warmup N] [--dt-us N] [--script FILE] [--lib PATH]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    int frames = 3600;
+    int warmup = 120;
+    int dt_us = 16667;
+    const char *lib = GAME_LIBRARY_PATH;
+    const char *script_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--frames") && has_value)      frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--warmup") && has_value) warmup = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--dt-us") && has_value)  dt_us = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--script") && has_value) script_path = argv[++i];
+        else if (!strcmp(argv[i], "--lib") && has_value)    lib = argv[++i];
+        else { usage(argv[0]); return 2; }
+    }
+    if (frames <= 0 || warmup < 0 || dt_us <= 0) { usage(argv[0]); return 2; }
+
+    InputScript script = { 0 };
+    if (script_path && !input_script_load(&script, script_path)) return 1;
+
+    GameModule game;
+    if (!game_module_load(&game, lib)) return 1;
+
+    SDL_Init(SDL_INIT_VIDEO);
+    SDLNet_Init();
+    SDL_Window *win = SDL_CreateWindow("headless", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                       WINDOW_WIDTH, WINDOW_HEIGHT, 0);
+
+    ctx = calloc(1, sizeof(GameContext));
+    ctx->renderer = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED);
+
+    Uint64 *samples = malloc(sizeof(Uint64) * frames);
+    SDLStub_Stats stats;
+
+    for (int frame = 0; frame < warmup + frames; frame++) {
+        if (frame == warmup) SDLStub_ResetStats();
+
+        input_script_feed(&script, frame);
+        SDLStub_AdvanceClock((Uint64)dt_us * 1000u);
+
+        Uint64 t0 = now_ns();
+        game.update_and_render(ctx);
+        Uint64 t1 = now_ns();
+
+        if (frame >= warmup) samples[frame - warmup] = t1 - t0;
+    }
+    SDLStub_GetStats(&stats);
+
+    Uint64 total = 0;
+    for (int i = 0; i < frames; i++) total += samples[i];
+    qsort(samples, frames, sizeof(Uint64), compare_u64);
+
+    printf("\n=== headless: %s ===\n", lib);
+    printf("frames        %d (+%d warmup), game ctx %zu bytes\n", frames, warmup, sizeof(GameContext));
+    printf("ns/frame      mean %llu  p50 %llu  p99 %llu  max %llu\n",
+           (unsigned long long)(total / frames),
+           (unsigned long long)samples[frames / 2],
+           (unsigned long long)samples[(int)((frames - 1) * 0.99)],
+           (unsigned long long)samples[frames - 1]);
+    printf("draws/frame   %.1f (primitives %.1f, state changes %.1f, presents %.2f)\n",
+           (double)stats.draw_calls / frames,
+           (double)stats.primitives / frames,
+           (double)stats.state_changes / frames,
+           (double)stats.presents / frames);
+
+    free(samples);
+    input_script_free(&script);
+    SDL_DestroyRenderer(ctx->renderer);
+    SDL_DestroyWindow(win);
+    game_module_unload(&game);
+    SDLNet_Quit();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,239 @@
+#ifndef SDL_STUB_SDL_H
+#define SDL_STUB_SDL_H
+
+// ----------------------------------------------------------------------------
+// Headless SDL2 stand-in for the native build (see native/sdl_stub.c).
+//
+// Only the subset of the SDL2 API the games use. Types, enum values and
+// signatures match SDL2 so game.c compiles unchanged; the renderer draws
+// nothing and counts calls instead.
+// ----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int8_t   Sint8;
+typedef uint8_t  Uint8;
+typedef int16_t  Sint16;
+typedef uint16_t Uint16;
+typedef int32_t  Sint32;
+typedef uint32_t Uint32;
+typedef int64_t  Sint64;
+typedef uint64_t Uint64;
+
+typedef enum { SDL_FALSE = 0, SDL_TRUE = 1 } SDL_bool;
+
+// --- init -------------------------------------------------------------------
+
+#define SDL_INIT_TIMER          0x00000001u
+#define SDL_INIT_AUDIO          0x00000010u
+#define SDL_INIT_VIDEO          0x00000020u
+#define SDL_INIT_EVENTS         0x00004000u
+#define SDL_INIT_EVERYTHING     0x0000FFFFu
+
+int  SDL_Init(Uint32 flags);
+void SDL_Quit(void);
+const char *SDL_GetError(void);
+
+// --- geometry ---------------------------------------------------------------
+
+typedef struct SDL_Point  { int x, y; } SDL_Point;
+typedef struct SDL_FPoint { float x, y; } SDL_FPoint;
+typedef struct SDL_Rect   { int x, y, w, h; } SDL_Rect;
+typedef struct SDL_FRect  { float x, y, w, h; } SDL_FRect;
+typedef struct SDL_Color  { Uint8 r, g, b, a; } SDL_Color;
+
+typedef struct SDL_Vertex {
+    SDL_FPoint position;
+    SDL_Color  color;
+    SDL_FPoint tex_coord;
+} SDL_Vertex;
+
+SDL_bool SDL_HasIntersection(const SDL_Rect *a, const SDL_Rect *b);
+
+// --- video / renderer -------------------------------------------------------
+
+typedef struct SDL_Window   SDL_Window;
+typedef struct SDL_Renderer SDL_Renderer;
+typedef struct SDL_Texture  SDL_Texture;
+
+#define SDL_WINDOWPOS_UNDEFINED     0x1FFF0000u
+#define SDL_WINDOWPOS_CENTERED      0x2FFF0000u
+
+#define SDL_WINDOW_SHOWN            0x00000004u
+#define SDL_WINDOW_RESIZABLE        0x00000020u
+
+#define SDL_RENDERER_SOFTWARE       0x00000001u
+#define SDL_RENDERER_ACCELERATED    0x00000002u
+#define SDL_RENDERER_PRESENTVSYNC   0x00000004u
+
+typedef enum {
+    SDL_BLENDMODE_NONE  = 0x00000000,
+    SDL_BLENDMODE_BLEND = 0x00000001,
+    SDL_BLENDMODE_ADD   = 0x00000002,
+    SDL_BLENDMODE_MOD   = 0x00000004
+} SDL_BlendMode;
+
+SDL_Window *SDL_CreateWindow(const char *title, int x, int y, int w, int h, Uint32 flags);
+void        SDL_DestroyWindow(SDL_Window *window);
+
+SDL_Renderer *SDL_CreateRenderer(SDL_Window *window, int index, Uint32 flags);
+void          SDL_DestroyRenderer(SDL_Renderer *renderer);
+
+int  SDL_SetRenderDrawColor(SDL_Renderer *renderer, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+int  SDL_GetRenderDrawColor(SDL_Renderer *renderer, Uint8 *r, Uint8 *g, Uint8 *b, Uint8 *a);
+int  SDL_SetRenderDrawBlendMode(SDL_Renderer *renderer, SDL_BlendMode mode);
+int  SDL_RenderSetViewport(SDL_Renderer *renderer, const SDL_Rect *rect);
+
+int  SDL_RenderClear(SDL_Renderer *renderer);
+int  SDL_RenderDrawPoint(SDL_Renderer *renderer, int x, int y);
+int  SDL_RenderDrawLine(SDL_Renderer *renderer, int x1, int y1, int x2, int y2);
+int  SDL_RenderDrawRect(SDL_Renderer *renderer, const SDL_Rect *rect);
+int  SDL_RenderDrawRects(SDL_Renderer *renderer, const SDL_Rect *rects, int count);
+int  SDL_RenderFillRect(SDL_Renderer *renderer, const SDL_Rect *rect);
+int  SDL_RenderFillRects(SDL_Renderer *renderer, const SDL_Rect *rects, int count);
+int  SDL_RenderGeometry(SDL_Renderer *renderer, SDL_Texture *texture,
+                        const SDL_Vertex *vertices, int num_vertices,
+                        const int *indices, int num_indices);
+void SDL_RenderPresent(SDL_Renderer *renderer);
+
+// --- timer ------------------------------------------------------------------
+
+Uint32 SDL_GetTicks(void);
+Uint64 SDL_GetTicks64(void);
+Uint64 SDL_GetPerformanceCounter(void);
+Uint64 SDL_GetPerformanceFrequency(void);
+void   SDL_Delay(Uint32 ms);
+
+// --- keyboard ---------------------------------------------------------------
+
+typedef enum {
+    SDL_SCANCODE_UNKNOWN = 0,
+
+    SDL_SCANCODE_A = 4,  SDL_SCANCODE_B = 5,  SDL_SCANCODE_C = 6,  SDL_SCANCODE_D = 7,
+    SDL_SCANCODE_E = 8,  SDL_SCANCODE_F = 9,  SDL_SCANCODE_G = 10, SDL_SCANCODE_H = 11,
+    SDL_SCANCODE_I = 12, SDL_SCANCODE_J = 13, SDL_SCANCODE_K = 14, SDL_SCANCODE_L = 15,
+    SDL_SCANCODE_M = 16, SDL_SCANCODE_N = 17, SDL_SCANCODE_O = 18, SDL_SCANCODE_P = 19,
+    SDL_SCANCODE_Q = 20, SDL_SCANCODE_R = 21, SDL_SCANCODE_S = 22, SDL_SCANCODE_T = 23,
+    SDL_SCANCODE_U = 24, SDL_SCANCODE_V = 25, SDL_SCANCODE_W = 26, SDL_SCANCODE_X = 27,
+    SDL_SCANCODE_Y = 28, SDL_SCANCODE_Z = 29,
+
+    SDL_SCANCODE_RETURN = 40,
+    SDL_SCANCODE_ESCAPE = 41,
+    SDL_SCANCODE_SPACE  = 44,
+
+    SDL_SCANCODE_RIGHT = 79,
+    SDL_SCANCODE_LEFT  = 80,
+    SDL_SCANCODE_DOWN  = 81,
+    SDL_SCANCODE_UP    = 82,
+
+    SDL_NUM_SCANCODES = 512
+} SDL_Scancode;
+
+typedef Sint32 SDL_Keycode;
+
+#define SDLK_SCANCODE_MASK (1 << 30)
+#define SDL_SCANCODE_TO_KEYCODE(X) ((X) | SDLK_SCANCODE_MASK)
+
+enum {
+    SDLK_UNKNOWN = 0,
+    SDLK_RETURN  = '\r',
+    SDLK_ESCAPE  = '\x1B',
+    SDLK_SPACE   = ' ',
+
+    SDLK_a = 'a', SDLK_b = 'b', SDLK_c = 'c', SDLK_d = 'd', SDLK_e = 'e', SDLK_f = 'f',
+    SDLK_g = 'g', SDLK_h = 'h', SDLK_i = 'i', SDLK_j = 'j', SDLK_k = 'k', SDLK_l = 'l',
+    SDLK_m = 'm', SDLK_n = 'n', SDLK_o = 'o', SDLK_p = 'p', SDLK_q = 'q', SDLK_r = 'r',
+    SDLK_s = 's', SDLK_t = 't', SDLK_u = 'u', SDLK_v = 'v', SDLK_w = 'w', SDLK_x = 'x',
+    SDLK_y = 'y', SDLK_z = 'z',
+
+    SDLK_RIGHT = SDL_SCANCODE_TO_KEYCODE(SDL_SCANCODE_RIGHT),
+    SDLK_LEFT  = SDL_SCANCODE_TO_KEYCODE(SDL_SCANCODE_LEFT),
+    SDLK_DOWN  = SDL_SCANCODE_TO_KEYCODE(SDL_SCANCODE_DOWN),
+    SDLK_UP    = SDL_SCANCODE_TO_KEYCODE(SDL_SCANCODE_UP)
+};
+
+typedef struct SDL_Keysym {
+    SDL_Scancode scancode;
+    SDL_Keycode  sym;
+    Uint16       mod;
+    Uint32       unused;
+} SDL_Keysym;
+
+// --- events -----------------------------------------------------------------
+
+typedef enum {
+    SDL_FIRSTEVENT      = 0,
+    SDL_QUIT            = 0x100,
+    SDL_KEYDOWN         = 0x300,
+    SDL_KEYUP,
+    SDL_MOUSEMOTION     = 0x400,
+    SDL_MOUSEBUTTONDOWN,
+    SDL_MOUSEBUTTONUP,
+    SDL_FINGERDOWN      = 0x700,
+    SDL_FINGERUP,
+    SDL_FINGERMOTION,
+    SDL_USEREVENT       = 0x8000
+} SDL_EventType;
+
+#define SDL_RELEASED 0
+#define SDL_PRESSED  1
+
+typedef Sint64 SDL_TouchID;
+typedef Sint64 SDL_FingerID;
+
+typedef struct SDL_KeyboardEvent {
+    Uint32 type;
+    Uint32 timestamp;
+    Uint32 windowID;
+    Uint8  state;
+    Uint8  repeat;
+    Uint8  padding2;
+    Uint8  padding3;
+    SDL_Keysym keysym;
+} SDL_KeyboardEvent;
+
+typedef struct SDL_MouseButtonEvent {
+    Uint32 type;
+    Uint32 timestamp;
+    Uint32 windowID;
+    Uint32 which;
+    Uint8  button;
+    Uint8  state;
+    Uint8  clicks;
+    Uint8  padding1;
+    Sint32 x, y;
+} SDL_MouseButtonEvent;
+
+typedef struct SDL_TouchFingerEvent {
+    Uint32 type;
+    Uint32 timestamp;
+    SDL_TouchID  touchId;
+    SDL_FingerID fingerId;
+    float x, y;
+    float dx, dy;
+    float pressure;
+    Uint32 windowID;
+} SDL_TouchFingerEvent;
+
+typedef union SDL_Event {
+    Uint32 type;
+    SDL_KeyboardEvent    key;
+    SDL_MouseButtonEvent button;
+    SDL_TouchFingerEvent tfinger;
+    Uint8 padding[56];
+} SDL_Event;
+
+int SDL_PollEvent(SDL_Event *event);
+int SDL_PushEvent(SDL_Event *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDL_STUB_SDL_H
@@ -0,0 +1,44 @@
+#ifndef SDL_STUB_SDL_NET_H
+#define SDL_STUB_SDL_NET_H
+
+// Headless SDL_net stand-in: every connect attempt fails, so networked games
+// fall back to their offline path (see native/sdl_stub.c).
+
+#include "SDL.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    Uint32 host;
+    Uint16 port;
+} IPaddress;
+
+typedef struct _TCPsocket *TCPsocket;
+typedef struct _SDLNet_SocketSet *SDLNet_SocketSet;
+typedef struct _SDLNet_GenericSocket { int ready; } *SDLNet_GenericSocket;
+
+int  SDLNet_Init(void);
+void SDLNet_Quit(void);
+const char *SDLNet_GetError(void);
+
+int       SDLNet_ResolveHost(IPaddress *address, const char *host, Uint16 port);
+TCPsocket SDLNet_TCP_Open(IPaddress *ip);
+void      SDLNet_TCP_Close(TCPsocket sock);
+int       SDLNet_TCP_Send(TCPsocket sock, const void *data, int len);
+int       SDLNet_TCP_Recv(TCPsocket sock, void *data, int maxlen);
+
+SDLNet_SocketSet SDLNet_AllocSocketSet(int maxsockets);
+void SDLNet_FreeSocketSet(SDLNet_SocketSet set);
+int  SDLNet_AddSocket(SDLNet_SocketSet set, SDLNet_GenericSocket sock);
+int  SDLNet_DelSocket(SDLNet_SocketSet set, SDLNet_GenericSocket sock);
+int  SDLNet_CheckSockets(SDLNet_SocketSet set, Uint32 timeout);
+
+#define SDLNet_SocketReady(sock) ((sock) != NULL && ((SDLNet_GenericSocket)(sock))->ready)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDL_STUB_SDL_NET_H
@@ -0,0 +1,10 @@
+#ifndef SDL_STUB_EMSCRIPTEN_H
+#define SDL_STUB_EMSCRIPTEN_H
+
+// Native build: keep exported game entry points visible in the shared library.
+#define EMSCRIPTEN_KEEPALIVE __attribute__((used, visibility("default")))
+
+// No JavaScript natively
+static inline void emscripten_run_script(const char *script) { (void)script; }
+
+#endif // SDL_STUB_EMSCRIPTEN_H
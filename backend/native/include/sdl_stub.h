@@ -0,0 +1,40 @@
+#ifndef SDL_STUB_H
+#define SDL_STUB_H
+
+// Control surface of the headless SDL stub, used by the native hosts.
+// Games never include this; they only see the regular SDL2 headers.
+
+#include <SDL2/SDL.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    Uint64 draw_calls;      // every SDL_Render* call that would reach the GPU
+    Uint64 primitives;      // rects, lines, points and triangles submitted
+    Uint64 state_changes;   // draw color / blend mode / viewport changes
+    Uint64 clears;
+    Uint64 presents;
+} SDLStub_Stats;
+
+// Counters accumulate until reset; hosts typically snapshot them per frame.
+void SDLStub_GetStats(SDLStub_Stats *out);
+void SDLStub_ResetStats(void);
+
+// Virtual clock backing SDL_GetTicks/SDL_GetPerformanceCounter (1ns ticks).
+// It only moves when the host advances it, so runs are reproducible. It does
+// not move during a frame, so in-game timings (profiler zones, the stress
+// test's update/render/present) read 0 natively; the hosts time frames with
+// CLOCK_MONOTONIC around update_and_render instead.
+void   SDLStub_AdvanceClock(Uint64 ns);
+Uint64 SDLStub_GetClock(void);
+
+// Scripted input: queues one SDL_KEYDOWN (down != 0) or SDL_KEYUP event.
+int SDLStub_PushKey(SDL_Scancode scancode, SDL_Keycode sym, int down);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDL_STUB_H
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "input_script.h"
+#include "sdl_stub.h"
+
+static const KeyName KEY_NAMES[] = {
+    { "up",    SDL_SCANCODE_UP,    SDLK_UP    },
+    { "down",  SDL_SCANCODE_DOWN,  SDLK_DOWN  },
+    { "left",  SDL_SCANCODE_LEFT,  SDLK_LEFT  },
+    { "right", SDL_SCANCODE_RIGHT, SDLK_RIGHT },
+    { "w",     SDL_SCANCODE_W,     SDLK_w     },
+    { "a",     SDL_SCANCODE_A,     SDLK_a     },
+    { "s",     SDL_SCANCODE_S,     SDLK_s     },
+    { "d",     SDL_SCANCODE_D,     SDLK_d     },
+    { "l",     SDL_SCANCODE_L,     SDLK_l     },
+    { "b",     SDL_SCANCODE_B,     SDLK_b     },
+    { "r",     SDL_SCANCODE_R,     SDLK_r     },
+    { "space", SDL_SCANCODE_SPACE, SDLK_SPACE },
+};
+
+static const KeyName *find_key(const char *name) {
+    for (size_t i = 0; i < sizeof KEY_NAMES / sizeof KEY_NAMES[0]; i++) {
+        if (strcmp(KEY_NAMES[i].name, name) == 0) return &KEY_NAMES[i];
+    }
+    return NULL;
+}
+
+bool input_script_load(InputScript *script, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "[input] cannot open script %s\n", path);
+        return false;
+    }
+
+    int capacity = 64;
+    script->events = malloc(sizeof(ScriptEvent) * capacity);
+    script->count = 0;
+
+    char line[256];
+    int lineno = 0;
+    while (fgets(line, sizeof line, f)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        int frame;
+        char action[16], key[16];
+        int n = sscanf(line, "%d %15s %15s", &frame, action, key);
+        if (n <= 0) continue;
+
+        const KeyName *k = (n == 3) ? find_key(key) : NULL;
+        bool down = strcmp(action, "down") == 0;
+        if (!k || frame < 0 || (!down && strcmp(action, "up") != 0)) {
+            fprintf(stderr, "[input] %s:%d: expected \"<frame> <down|up> <key>\"\n", path, lineno);
+            fclose(f);
+            input_script_free(script);
+            return false;
+        }
+
+        if (script->count == capacity) {
+            capacity *= 2;
+            script->events = realloc(script->events, sizeof(ScriptEvent) * capacity);
+        }
+        script->events[script->count++] = (ScriptEvent){ frame, down, k };
+    }
+    fclose(f);
+
+    // Stable insertion sort: events on the same frame keep file order
+    for (int i = 1; i < script->count; i++) {
+        ScriptEvent e = script->events[i];
+        int j = i - 1;
+        while (j >= 0 && script->events[j].frame > e.frame) {
+            script->events[j + 1] = script->events[j];
+            j--;
+        }
+        script->events[j + 1] = e;
+    }
+    script->next = 0;
+    return true;
+}
+
+static void push_key(const KeyName *k, int down) {
+    SDLStub_PushKey(k->scancode, k->sym, down);
+}
+
+void input_script_feed(InputScript *script, int frame) {
+    if (script->events) {
+        while (script->next < script->count && script->events[script->next].frame <= frame) {
+            ScriptEvent *e = &script->events[script->next++];
+            push_key(e->key, e->down);
+        }
+        return;
+    }
+
+    // Built-in pattern: 1s up, 1s down; space tapped every 5s (ready/fire)
+    const KeyName *up = find_key("up"), *down = find_key("down"), *space = find_key("space");
+    int phase = frame % 120;
+    if (phase == 0)  { push_key(down, 0); push_key(up, 1); }
+    if (phase == 60) { push_key(up, 0); push_key(down, 1); }
+    if (frame % 300 == 1)  push_key(space, 1);
+    if (frame % 300 == 20) push_key(space, 0);
+}
+
+void input_script_free(InputScript *script) {
+    free(script->events);
+    script->events = NULL;
+    script->count = script->next = 0;
+}
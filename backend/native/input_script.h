@@ -0,0 +1,36 @@
+#ifndef INPUT_SCRIPT_H
+#define INPUT_SCRIPT_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// Scripted keyboard input for the native hosts, fed through the SDL stub's
+// event queue so the game sees ordinary SDL_KEYDOWN/SDL_KEYUP events.
+//
+// Script lines: "<frame> <down|up> <key>", '#' starts a comment.
+// Keys: up down left right w a s d l b r space.
+
+typedef struct {
+    const char  *name;
+    SDL_Scancode scancode;
+    SDL_Keycode  sym;
+} KeyName;
+
+typedef struct {
+    int frame;
+    int down;
+    const KeyName *key;
+} ScriptEvent;
+
+// Zero-initialised script = built-in pattern (alternating up/down, space taps)
+typedef struct {
+    ScriptEvent *events;
+    int count;
+    int next;
+} InputScript;
+
+bool input_script_load(InputScript *script, const char *path);
+void input_script_feed(InputScript *script, int frame);
+void input_script_free(InputScript *script);
+
+#endif
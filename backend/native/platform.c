@@ -0,0 +1,256 @@
+// ----------------------------------------------------------------------------
+// Native hot-reload host
+//
+// Same contract as sdl_app.c + reload.js in the browser: the host owns one
+// GameContext* for the whole session and only swaps update_and_render when
+// the Game module is rebuilt. Sources in GAME_DIR are polled; on change the
+// host runs `cmake --build --target Game`, copies the library to a unique
+// name (dlopen caches by path) and swaps it in between frames. If the game
+// exports a context layout, the new module migrates ctx to its own layout
+// (fields added/removed/reordered in game.h) before its first frame.
+//
+//   Platform [--frames N] [--script FILE] [--no-watch]
+//
+// Runs at 60Hz wall-clock against the stub renderer and prints frame cost
+// every few seconds, so it can sit under perf or a sanitizer build.
+// ----------------------------------------------------------------------------
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_net.h>
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "game_loader.h"
+#include "input_script.h"
+#include "sdl_stub.h"
+
+#ifndef GAME_LIBRARY_PATH
+#define GAME_LIBRARY_PATH "./libGame.so"
+#endif
+#ifndef GAME_SOURCE_DIR
+#define GAME_SOURCE_DIR "game"
+#endif
+#ifndef GAME_BUILD_DIR
+#define GAME_BUILD_DIR "."
+#endif
+#ifndef GAME_CMAKE_COMMAND
+#define GAME_CMAKE_COMMAND "cmake"
+#endif
+
+static const Uint64 FRAME_NS = 16666667u;
+static const int WATCH_INTERVAL_FRAMES = 15;    // ~4 polls per second
+static const int REPORT_INTERVAL_FRAMES = 300;
+
+
+typedef struct {
+    GameModule module;
+    char loaded_path[512];
+    int generation;
+    Uint64 sources_stamp;
+} HotGame;
+
+// Lives for the whole process, like the one in sdl_app.c (the game may hang
+// its own allocations off it, which the host can't free). A migrating reload
+// replaces it, so after startup the host only passes it through: the layout
+// this file was compiled against may be stale.
+static GameContext *ctx;
+
+static Uint64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Uint64)ts.tv_sec * 1000000000u + (Uint64)ts.tv_nsec;
+}
+
+static void sleep_ns(Uint64 ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000u), (long)(ns % 1000000000u) };
+    nanosleep(&ts, NULL);
+}
+
+static bool is_source_file(const char *name) {
+    size_t n = strlen(name);
+    return n > 2 && name[n - 2] == '.' && (name[n - 1] == 'c' || name[n - 1] == 'h');
+}
+
+// Fingerprint of every *.c / *.h in GAME_SOURCE_DIR: names and mtimes, mixed
+// per file and combined order-independently (readdir order isn't stable), so
+// an edit, a new file or a removed one all change it
+static Uint64 sources_fingerprint(void) {
+    DIR *dir = opendir(GAME_SOURCE_DIR);
+    if (!dir) return 0;
+
+    Uint64 stamp = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!is_source_file(entry->d_name)) continue;
+
+        char path[512];
+        snprintf(path, sizeof path, "%s/%s", GAME_SOURCE_DIR, entry->d_name);
+        struct stat st;
+        if (stat(path, &st) != 0) continue;
+
+        Uint64 h = 14695981039346656037u;   // FNV-1a
+        for (const char *c = entry->d_name; *c; c++) h = (h ^ (unsigned char)*c) * 1099511628211u;
+        h ^= (Uint64)st.st_mtim.tv_sec * 1000000000u + (Uint64)st.st_mtim.tv_nsec;
+        h *= 1099511628211u;
+        stamp += h;
+    }
+    closedir(dir);
+    return stamp;
+}
+
+// true if any game source changed since the last call
+static bool sources_changed(HotGame *hot) {
+    Uint64 stamp = sources_fingerprint();
+    if (stamp == hot->sources_stamp) return false;
+    hot->sources_stamp = stamp;
+    return true;
+}
+
+static bool copy_file(const char *from, const char *to) {
+    FILE *in = fopen(from, "rb");
+    if (!in) return false;
+    FILE *out = fopen(to, "wb");
+    if (!out) { fclose(in); return false; }
+
+    char buf[1 << 16];
+    size_t n;
+    bool ok = true;
+    while ((n = fread(buf, 1, sizeof buf, in)) > 0) {
+        if (fwrite(buf, 1, n, out) != n) { ok = false; break; }
+    }
+    fclose(in);
+    if (fclose(out) != 0) ok = false;
+    return ok;
+}
+
+// Load a private copy of the freshly built library and swap it in.
+// On failure the previous module stays active.
+static bool hot_load(HotGame *hot) {
+    char path[512];
+    snprintf(path, sizeof path, "%s/hot_reload", GAME_BUILD_DIR);
+    mkdir(path, 0755);
+    snprintf(path, sizeof path, "%s/hot_reload/Game_%d_%d.so", GAME_BUILD_DIR, (int)getpid(), hot->generation + 1);
+
+    if (!copy_file(GAME_LIBRARY_PATH, path)) {
+        fprintf(stderr, "[platform] cannot copy %s\n", GAME_LIBRARY_PATH);
+        return false;
+    }
+
+    GameModule next;
+    if (!game_module_load(&next, path)) {
+        unlink(path);
+        return false;
+    }
+
+    void *old_layout = NULL;
+    if (hot->module.handle) {
+        old_layout = game_module_copy_layout(&hot->module);
+        game_module_unload(&hot->module);
+        unlink(hot->loaded_path);
+    }
+    hot->module = next;
+
+    if (ctx) ctx = game_module_migrate(&hot->module, ctx, old_layout);
+    free(old_layout);
+    snprintf(hot->loaded_path, sizeof hot->loaded_path, "%s", path);
+    hot->generation++;
+    return true;
+}
+
+static bool rebuild_game(void) {
+    char cmd[1024];
+    snprintf(cmd, sizeof cmd, "\"%s\" --build \"%s\" --target Game", GAME_CMAKE_COMMAND, GAME_BUILD_DIR);
+    return system(cmd) == 0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [--frames N] [--script FILE] [--no-watch]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    int max_frames = 0;     // 0 = run until killed
+    bool watch = true;
+    const char *script_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--frames") && has_value)      max_frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--script") && has_value) script_path = argv[++i];
+        else if (!strcmp(argv[i], "--no-watch"))            watch = false;
+        else { usage(argv[0]); return 2; }
+    }
+
+    InputScript script = { 0 };
+    if (script_path && !input_script_load(&script, script_path)) return 1;
+
+    HotGame hot;
+    memset(&hot, 0, sizeof hot);
+    sources_changed(&hot);
+    if (!hot_load(&hot)) return 1;
+
+    SDL_Init(SDL_INIT_VIDEO);
+    SDLNet_Init();
+    SDL_Window *win = SDL_CreateWindow("Platform", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                       WINDOW_WIDTH, WINDOW_HEIGHT, 0);
+
+    SDL_Renderer *renderer = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    ctx = calloc(1, sizeof(GameContext));
+    ctx->renderer = renderer;
+
+    printf("[platform] watching %s (pid %d)\n", GAME_SOURCE_DIR, (int)getpid());
+
+    Uint64 report_ns = 0;
+    Uint64 last = now_ns();
+    for (int frame = 0; max_frames == 0 || frame < max_frames; frame++) {
+        if (watch && frame % WATCH_INTERVAL_FRAMES == 0 && sources_changed(&hot)) {
+            Uint64 t0 = now_ns();
+            bool built = rebuild_game();
+            Uint64 t1 = now_ns();
+            if (built && hot_load(&hot)) {
+                printf("[platform] reload #%d: build %.1f ms, swap %.2f ms\n", hot.generation,
+                       (t1 - t0) / 1e6, (now_ns() - t1) / 1e6);
+            } else {
+                printf("[platform] rebuild failed, keeping module #%d\n", hot.generation);
+            }
+            last = now_ns();    // don't feed the build time to the game clock
+        }
+
+        input_script_feed(&script, frame);
+
+        Uint64 start = now_ns();
+        SDLStub_AdvanceClock(start - last);
+        last = start;
+
+        hot.module.update_and_render(ctx);
+        Uint64 spent = now_ns() - start;
+        report_ns += spent;
+
+        if ((frame + 1) % REPORT_INTERVAL_FRAMES == 0) {
+            SDLStub_Stats stats;
+            SDLStub_GetStats(&stats);
+            printf("[platform] frame %d: %.0f ns/frame, %.1f draws/frame\n", frame + 1,
+                   (double)report_ns / REPORT_INTERVAL_FRAMES,
+                   (double)stats.draw_calls / REPORT_INTERVAL_FRAMES);
+            SDLStub_ResetStats();
+            report_ns = 0;
+        }
+
+        if (spent < FRAME_NS) sleep_ns(FRAME_NS - spent);
+    }
+
+    input_script_free(&script);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(win);
+    game_module_unload(&hot.module);
+    unlink(hot.loaded_path);
+    SDLNet_Quit();
+    SDL_Quit();
+    return 0;
+}
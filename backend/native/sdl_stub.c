@@ -0,0 +1,244 @@
+// ----------------------------------------------------------------------------
+// Headless SDL2 stub
+//
+// Built as a shared library so the host and every loaded Game module share
+// one copy of the state below (event queue, clock, counters). Nothing is
+// drawn: render calls validate their arguments and bump counters, which is
+// what the benchmark cares about.
+// ----------------------------------------------------------------------------
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_net.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sdl_stub.h"
+
+#define STUB_EVENT_QUEUE_SIZE 256
+
+struct SDL_Window {
+    int w, h;
+};
+
+struct SDL_Renderer {
+    SDL_Window *window;
+    SDL_Color   color;
+    SDL_BlendMode blend;
+    SDL_Rect    viewport;
+};
+
+static SDLStub_Stats g_stats;
+static Uint64 g_clock_ns;
+static const char *g_error = "";
+
+static SDL_Event g_events[STUB_EVENT_QUEUE_SIZE];
+static int g_event_head;
+static int g_event_count;
+
+static int stub_fail(const char *msg) {
+    g_error = msg;
+    return -1;
+}
+
+// --- control surface --------------------------------------------------------
+
+void SDLStub_GetStats(SDLStub_Stats *out) { *out = g_stats; }
+void SDLStub_ResetStats(void) { memset(&g_stats, 0, sizeof g_stats); }
+
+void   SDLStub_AdvanceClock(Uint64 ns) { g_clock_ns += ns; }
+Uint64 SDLStub_GetClock(void) { return g_clock_ns; }
+
+int SDLStub_PushKey(SDL_Scancode scancode, SDL_Keycode sym, int down) {
+    SDL_Event e;
+    memset(&e, 0, sizeof e);
+    e.key.type = down ? SDL_KEYDOWN : SDL_KEYUP;
+    e.key.timestamp = (Uint32)(g_clock_ns / 1000000u);
+    e.key.state = down ? SDL_PRESSED : SDL_RELEASED;
+    e.key.keysym.scancode = scancode;
+    e.key.keysym.sym = sym;
+    return SDL_PushEvent(&e);
+}
+
+// --- init -------------------------------------------------------------------
+
+int SDL_Init(Uint32 flags) { (void)flags; return 0; }
+void SDL_Quit(void) { g_event_count = 0; }
+const char *SDL_GetError(void) { return g_error; }
+
+SDL_bool SDL_HasIntersection(const SDL_Rect *a, const SDL_Rect *b) {
+    if (!a || !b) return SDL_FALSE;
+    if (a->w <= 0 || a->h <= 0 || b->w <= 0 || b->h <= 0) return SDL_FALSE;
+    if (a->x >= b->x + b->w || b->x >= a->x + a->w) return SDL_FALSE;
+    if (a->y >= b->y + b->h || b->y >= a->y + a->h) return SDL_FALSE;
+    return SDL_TRUE;
+}
+
+// --- video / renderer -------------------------------------------------------
+
+SDL_Window *SDL_CreateWindow(const char *title, int x, int y, int w, int h, Uint32 flags) {
+    (void)title; (void)x; (void)y; (void)flags;
+    SDL_Window *win = calloc(1, sizeof *win);
+    if (!win) { stub_fail("out of memory"); return NULL; }
+    win->w = w;
+    win->h = h;
+    return win;
+}
+
+void SDL_DestroyWindow(SDL_Window *window) { free(window); }
+
+SDL_Renderer *SDL_CreateRenderer(SDL_Window *window, int index, Uint32 flags) {
+    (void)index; (void)flags;
+    SDL_Renderer *ren = calloc(1, sizeof *ren);
+    if (!ren) { stub_fail("out of memory"); return NULL; }
+    ren->window = window;
+    ren->color = (SDL_Color){ 0, 0, 0, 255 };
+    ren->viewport = (SDL_Rect){ 0, 0, window ? window->w : 0, window ? window->h : 0 };
+    return ren;
+}
+
+void SDL_DestroyRenderer(SDL_Renderer *renderer) { free(renderer); }
+
+int SDL_SetRenderDrawColor(SDL_Renderer *renderer, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    if (!renderer) return stub_fail("invalid renderer");
+    renderer->color = (SDL_Color){ r, g, b, a };
+    g_stats.state_changes++;
+    return 0;
+}
+
+int SDL_GetRenderDrawColor(SDL_Renderer *renderer, Uint8 *r, Uint8 *g, Uint8 *b, Uint8 *a) {
+    if (!renderer) return stub_fail("invalid renderer");
+    if (r) *r = renderer->color.r;
+    if (g) *g = renderer->color.g;
+    if (b) *b = renderer->color.b;
+    if (a) *a = renderer->color.a;
+    return 0;
+}
+
+int SDL_SetRenderDrawBlendMode(SDL_Renderer *renderer, SDL_BlendMode mode) {
+    if (!renderer) return stub_fail("invalid renderer");
+    renderer->blend = mode;
+    g_stats.state_changes++;
+    return 0;
+}
+
+int SDL_RenderSetViewport(SDL_Renderer *renderer, const SDL_Rect *rect) {
+    if (!renderer) return stub_fail("invalid renderer");
+    if (rect) renderer->viewport = *rect;
+    g_stats.state_changes++;
+    return 0;
+}
+
+int SDL_RenderClear(SDL_Renderer *renderer) {
+    if (!renderer) return stub_fail("invalid renderer");
+    g_stats.draw_calls++;
+    g_stats.clears++;
+    return 0;
+}
+
+static int stub_draw(SDL_Renderer *renderer, Uint64 primitives) {
+    if (!renderer) return stub_fail("invalid renderer");
+    g_stats.draw_calls++;
+    g_stats.primitives += primitives;
+    return 0;
+}
+
+int SDL_RenderDrawPoint(SDL_Renderer *renderer, int x, int y) {
+    (void)x; (void)y;
+    return stub_draw(renderer, 1);
+}
+
+int SDL_RenderDrawLine(SDL_Renderer *renderer, int x1, int y1, int x2, int y2) {
+    (void)x1; (void)y1; (void)x2; (void)y2;
+    return stub_draw(renderer, 1);
+}
+
+int SDL_RenderDrawRect(SDL_Renderer *renderer, const SDL_Rect *rect) {
+    (void)rect;
+    return stub_draw(renderer, 1);
+}
+
+int SDL_RenderDrawRects(SDL_Renderer *renderer, const SDL_Rect *rects, int count) {
+    if (!rects || count < 0) return stub_fail("invalid rects");
+    return stub_draw(renderer, (Uint64)count);
+}
+
+int SDL_RenderFillRect(SDL_Renderer *renderer, const SDL_Rect *rect) {
+    (void)rect;
+    return stub_draw(renderer, 1);
+}
+
+int SDL_RenderFillRects(SDL_Renderer *renderer, const SDL_Rect *rects, int count) {
+    if (!rects || count < 0) return stub_fail("invalid rects");
+    return stub_draw(renderer, (Uint64)count);
+}
+
+int SDL_RenderGeometry(SDL_Renderer *renderer, SDL_Texture *texture,
+                       const SDL_Vertex *vertices, int num_vertices,
+                       const int *indices, int num_indices) {
+    (void)texture;
+    if (!vertices || num_vertices < 0) return stub_fail("invalid vertices");
+    int count = indices ? num_indices : num_vertices;
+    if (count < 0 || count % 3 != 0) return stub_fail("geometry is not a triangle list");
+    if (indices) {
+        for (int i = 0; i < num_indices; i++) {
+            if (indices[i] < 0 || indices[i] >= num_vertices) return stub_fail("index out of range");
+        }
+    }
+    return stub_draw(renderer, (Uint64)(count / 3));
+}
+
+void SDL_RenderPresent(SDL_Renderer *renderer) {
+    if (!renderer) return;
+    g_stats.presents++;
+}
+
+// --- timer ------------------------------------------------------------------
+
+Uint32 SDL_GetTicks(void) { return (Uint32)(g_clock_ns / 1000000u); }
+Uint64 SDL_GetTicks64(void) { return g_clock_ns / 1000000u; }
+Uint64 SDL_GetPerformanceCounter(void) { return g_clock_ns; }
+Uint64 SDL_GetPerformanceFrequency(void) { return 1000000000u; }
+void   SDL_Delay(Uint32 ms) { g_clock_ns += (Uint64)ms * 1000000u; }
+
+// --- events -----------------------------------------------------------------
+
+int SDL_PollEvent(SDL_Event *event) {
+    if (g_event_count == 0) return 0;
+    if (event) {
+        *event = g_events[g_event_head];
+        g_event_head = (g_event_head + 1) % STUB_EVENT_QUEUE_SIZE;
+        g_event_count--;
+    }
+    return 1;
+}
+
+int SDL_PushEvent(SDL_Event *event) {
+    if (!event) return stub_fail("invalid event");
+    if (g_event_count == STUB_EVENT_QUEUE_SIZE) return stub_fail("event queue full");
+    g_events[(g_event_head + g_event_count) % STUB_EVENT_QUEUE_SIZE] = *event;
+    g_event_count++;
+    return 1;
+}
+
+// --- SDL_net: no network in headless runs ------------------------------------
+
+int  SDLNet_Init(void) { return 0; }
+void SDLNet_Quit(void) {}
+const char *SDLNet_GetError(void) { return "networking is not available in the headless build"; }
+
+int SDLNet_ResolveHost(IPaddress *address, const char *host, Uint16 port) {
+    (void)host;
+    if (address) { address->host = 0; address->port = port; }
+    return -1;
+}
+
+TCPsocket SDLNet_TCP_Open(IPaddress *ip) { (void)ip; return NULL; }
+void SDLNet_TCP_Close(TCPsocket sock) { (void)sock; }
+int  SDLNet_TCP_Send(TCPsocket sock, const void *data, int len) { (void)sock; (void)data; (void)len; return 0; }
+int  SDLNet_TCP_Recv(TCPsocket sock, void *data, int maxlen) { (void)sock; (void)data; (void)maxlen; return -1; }
+
+SDLNet_SocketSet SDLNet_AllocSocketSet(int maxsockets) { (void)maxsockets; return NULL; }
+void SDLNet_FreeSocketSet(SDLNet_SocketSet set) { (void)set; }
+int  SDLNet_AddSocket(SDLNet_SocketSet set, SDLNet_GenericSocket sock) { (void)set; (void)sock; return -1; }
+int  SDLNet_DelSocket(SDLNet_SocketSet set, SDLNet_GenericSocket sock) { (void)set; (void)sock; return -1; }
+int  SDLNet_CheckSockets(SDLNet_SocketSet set, Uint32 timeout) { (void)set; (void)timeout; return 0; }
@@ -0,0 +1,147 @@
+// Batched outbound queues for the game relay
+//
+// Relayed messages are queued per receiving socket and written on a shared
+// tick: every socket with pending data gets all of it in one corked write,
+// so the syscall rate follows the tick instead of the senders' frame rate.
+//
+// State-type messages coalesce latest-wins: a newer one drops the queued one
+// of the same kind and is queued at the end, so a slow tick or a slow
+// receiver drops stale positions instead of queueing them, and what is sent
+// stays in the order it arrived (pong drops any packet whose seq is not newer
+// than the last one it took). Everything else is delivered in order.
+//
+//   binary [0x03 TAG_STATE][u8 channel]...   coalesced per channel
+//   pong NetHeader ("PG" magic), per type    coalesced: every input packet
+//                                            repeats the unacked inputs
+//   anything else                            in order, never dropped
+//
+// Pong packets are only recognised as such when one WebSocket message is
+// exactly one packet (header + its length byte of payload), which is how
+// the pong client sends them. The client still parses what it receives as
+// a byte stream; a message holding more or less than one packet is relayed
+// in order, untouched.
+//
+// A socket whose bufferedAmount is over RELAY_MAX_BUFFERED is skipped until
+// it drains; its coalesced messages stay at one per kind, and if its ordered
+// backlog passes RELAY_MAX_QUEUED it is closed as too slow.
+
+const WebSocket = require('ws');
+
+const TICK_MS = process.env.RELAY_TICK_MS !== undefined ? (parseInt(process.env.RELAY_TICK_MS) || 0) : 8; // 0: send immediately
+const MAX_BUFFERED = parseInt(process.env.RELAY_MAX_BUFFERED) || 64 * 1024;  // bytes in ws
+const MAX_QUEUED = parseInt(process.env.RELAY_MAX_QUEUED) || 1024;           // ordered messages
+
+const TAG_STATE = 0x03;
+const PONG_MAGIC_LO = 0x50;   // NET_MAGIC 0x4750, little-endian
+const PONG_MAGIC_HI = 0x47;
+const PONG_HEADER_SIZE = 8;
+
+// Coalescing key, or -1 for ordered messages
+function coalesceKey(data) {
+  if (!Buffer.isBuffer(data) || data.length < 2) return -1;
+  if (data[0] === TAG_STATE) return 0x100 | data[1];
+  if (data[0] === PONG_MAGIC_LO && data[1] === PONG_MAGIC_HI && data.length >= PONG_HEADER_SIZE &&
+      data.length === PONG_HEADER_SIZE + data[3]) return 0x200 | data[2];
+  return -1;
+}
+
+class Outbox {
+  constructor() {
+    this.pending = new Set();   // sockets with queued messages
+    this.timer = null;
+    this.stats = { queued: 0, sent: 0, coalesced: 0, deferred: 0, writes: 0, closed: 0 };
+  }
+
+  send(ws, data, isBinary) {
+    if (ws.readyState !== WebSocket.OPEN) return;
+    if (TICK_MS <= 0) {
+      ws.send(data, { binary: isBinary });
+      this.stats.sent++;
+      this.stats.writes++;
+      return;
+    }
+
+    let box = ws._outbox;
+    if (!box) box = ws._outbox = { messages: [], slots: new Map(), ordered: 0, dropped: 0 };
+
+    const key = coalesceKey(data);
+    const entry = { data, isBinary };
+    this.stats.queued++;
+    if (key >= 0 && box.slots.has(key)) {
+      box.messages[box.slots.get(key)] = null;    // superseded; the new one goes last
+      box.dropped++;
+      this.stats.coalesced++;
+      if (box.dropped > 32 && box.dropped * 2 > box.messages.length) this.compact(box);
+    }
+    if (key >= 0) box.slots.set(key, box.messages.length);
+    else box.ordered++;
+    box.messages.push(entry);
+
+    if (box.ordered > MAX_QUEUED) {
+      console.warn(`[Relay] Closing slow receiver (${box.ordered} queued, ${ws.bufferedAmount} bytes buffered)`);
+      this.stats.closed++;
+      this.discard(ws);
+      ws.close(1013, 'Receiver too slow');
+      return;
+    }
+
+    this.pending.add(ws);
+    if (!this.timer) this.timer = setTimeout(() => this.flush(), TICK_MS);
+  }
+
+  flush() {
+    this.timer = null;
+    for (const ws of this.pending) {
+      const box = ws._outbox;
+      if (ws.readyState !== WebSocket.OPEN) {
+        this.discard(ws);
+        continue;
+      }
+      if (ws.bufferedAmount > MAX_BUFFERED) {
+        this.stats.deferred++;
+        continue;
+      }
+
+      const socket = ws._socket;
+      socket?.cork();
+      for (const entry of box.messages) {
+        if (!entry) continue;
+        ws.send(entry.data, { binary: entry.isBinary });
+        this.stats.sent++;
+      }
+      socket?.uncork();
+      this.stats.writes++;
+
+      box.messages.length = 0;
+      box.slots.clear();
+      box.ordered = 0;
+      box.dropped = 0;
+      this.pending.delete(ws);
+    }
+
+    // Deferred sockets retry next tick
+    if (this.pending.size > 0 && !this.timer) this.timer = setTimeout(() => this.flush(), TICK_MS);
+  }
+
+  // Squeezes out superseded entries (a receiver deferred for many ticks)
+  compact(box) {
+    box.messages = box.messages.filter(entry => entry);
+    box.slots.clear();
+    box.messages.forEach((entry, index) => {
+      const key = coalesceKey(entry.data);
+      if (key >= 0) box.slots.set(key, index);
+    });
+    box.dropped = 0;
+  }
+
+  discard(ws) {
+    this.pending.delete(ws);
+    delete ws._outbox;
+  }
+
+  getStats() {
+    return { tickMs: TICK_MS, pendingSockets: this.pending.size, ...this.stats };
+  }
+}
+
+module.exports = new Outbox();
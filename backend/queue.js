@@ -1,5 +1,6 @@
 // Priority queue with job lifecycle management for build jobs
 const { EventEmitter } = require('events');
+const { BuildPredictor } = require('./build_predictor');
 
 // Priority levels
 const PRIORITY = {
@@ -8,6 +9,54 @@ const PRIORITY = {
     NORMAL: 1
 };
 
+// Fair share across clients (weighted fair queuing on build time)
+//
+// Every client (IP) has a virtual finish time. A job
+// starts at max(virtual clock, its client's finish time) and finishes its
+// predicted build time (build_predictor.js, in seconds) divided by its
+// weight later; that finish is the client's new finish time. A client with
+// many queued jobs pushes its own later jobs back, while a client's first
+// job starts at the current virtual clock. The clock advances to the start
+// tag of each job that is dequeued.
+//
+// The heap key is fixed at enqueue: finish tag minus a priority credit, ties
+// broken by enqueue order. Ordering by finish tag runs the shortest
+// expected job first among jobs that start together, so a side module isn't
+// held up behind a MAIN_MODULE link. Because the clock only moves forward,
+// new jobs get ever larger keys, so a waiting job ages: it can only be
+// passed by jobs that finish (minus credit) before it does, and each of
+// those has to be paid for by its own client.
+//
+// Sessions (the X-Client-Id a browser tab sends, unauthenticated) split
+// their client's share without adding to it. A second fair queue runs among
+// a client's sessions, in the client's own virtual time, and the client's
+// pending jobs take its chain of tags in that order (see _rechain). A tab's
+// first job isn't stuck behind another tab's backlog, but ten tabs on one IP
+// get what one tab gets.
+const MAX_WEIGHT = 4;       // LIVE_CODING gets this share of NORMAL
+const MAX_CREDIT = 1;       // ... and may pass up to a second of NORMAL build time
+const COST_UNIT_MS = 1000;
+const MAX_TRACKED_CLIENTS = 1024;
+
+// Quick lane: jobs predicted at most this long are kept apart, and a pool of
+// at least QUICK_LANE_MIN_WORKERS holds its last free worker for them (see
+// WorkerPool.dispatch) until the oldest pending long job has waited
+// QUICK_LANE_MAX_WAIT_MS. A smaller pool would run long jobs at half
+// capacity, so it has no lane.
+const SHORT_JOB_MS = 2000;
+const QUICK_LANE_MAX_WAIT_MS = 10000;
+const QUICK_LANE_MIN_WORKERS = 3;
+
+function classWeight(priority) {
+    const p = Math.min(Math.max(priority, PRIORITY.NORMAL), PRIORITY.LIVE_CODING);
+    return 1 + (MAX_WEIGHT - 1) * (p - PRIORITY.NORMAL) / (PRIORITY.LIVE_CODING - PRIORITY.NORMAL);
+}
+
+function priorityCredit(priority) {
+    const p = Math.min(Math.max(priority, PRIORITY.NORMAL), PRIORITY.LIVE_CODING);
+    return MAX_CREDIT * (p - PRIORITY.NORMAL) / (PRIORITY.LIVE_CODING - PRIORITY.NORMAL);
+}
+
 // Job states
 const STATE = {
     PENDING: 'pending',
@@ -18,6 +67,12 @@ const STATE = {
     TIMEOUT: 'timeout'
 };
 
+// Heap order: item.key, then item.seq (enqueue order)
+function before(a, b) {
+    return a.key < b.key || (a.key === b.key && a.seq < b.seq);
+}
+
+// Min-heap in `before` order
 class PriorityHeap {
     constructor() {
         this.heap = [];
@@ -63,7 +118,7 @@ class PriorityHeap {
     _bubbleUp(idx) {
         while (idx > 0) {
             const parent = Math.floor((idx - 1) / 2);
-            if (this.heap[parent].priority >= this.heap[idx].priority) break;
+            if (!before(this.heap[idx], this.heap[parent])) break;
             [this.heap[parent], this.heap[idx]] = [this.heap[idx], this.heap[parent]];
             idx = parent;
         }
@@ -74,18 +129,18 @@ class PriorityHeap {
         while (true) {
             const left = 2 * idx + 1;
             const right = 2 * idx + 2;
-            let largest = idx;
+            let first = idx;
 
-            if (left < len && this.heap[left].priority > this.heap[largest].priority) {
-                largest = left;
+            if (left < len && before(this.heap[left], this.heap[first])) {
+                first = left;
             }
-            if (right < len && this.heap[right].priority > this.heap[largest].priority) {
-                largest = right;
+            if (right < len && before(this.heap[right], this.heap[first])) {
+                first = right;
             }
-            if (largest === idx) break;
+            if (first === idx) break;
 
-            [this.heap[idx], this.heap[largest]] = [this.heap[largest], this.heap[idx]];
-            idx = largest;
+            [this.heap[idx], this.heap[first]] = [this.heap[first], this.heap[idx]];
+            idx = first;
         }
     }
 }
@@ -94,9 +149,17 @@ class BuildQueue extends EventEmitter {
     constructor(options = {}) {
         super();
         this.jobs = new Map();
-        this.pending = new PriorityHeap();
+        this.pendingShort = new PriorityHeap();   // predicted <= SHORT_JOB_MS
+        this.pendingLong = new PriorityHeap();
+        this.predictor = new BuildPredictor();
+        this.workerCount = null;                  // set by the worker pool, for estimates
         this.processing = new Set();
 
+        // Fair share state (see the fair share notes above)
+        this.virtualTime = 0;
+        this.clients = new Map();        // clientId -> fair share state, see _client()
+        this.seq = 0;
+
         // Configuration
         this.maxConcurrency = options.maxConcurrency || 4;
         this.jobTimeout = options.jobTimeout || 5 * 60 * 1000; // 5 minutes
@@ -139,9 +202,30 @@ class BuildQueue extends EventEmitter {
                     PRIORITY.NORMAL
         );
 
+        // Fair share: tag the job within its session, then lay the client's
+        // pending jobs on its chain of tags (which may move its other jobs)
+        const clientId = job.clientId || 'anonymous';
+        const sessionId = job.sessionId || '';
+        const prediction = this.predictor.estimate(job);
+        const cost = prediction.ms / COST_UNIT_MS / classWeight(priority);
+        const client = this._client(clientId);
+        const innerStart = Math.max(client.clock, client.sessions.get(sessionId) || 0);
+        client.sessions.set(sessionId, innerStart + cost);
+
         const enrichedJob = {
             ...job,
+            clientId,
+            sessionId,
             priority,
+            cost,
+            arrival: this.virtualTime,
+            innerStart,
+            innerKey: innerStart + cost - priorityCredit(priority),
+            fairStart: null,
+            fairFinish: null,
+            short: prediction.ms <= SHORT_JOB_MS,
+            seq: this.seq++,
+            prediction,
             state: STATE.PENDING,
             enqueuedAt: Date.now(),
             startedAt: null,
@@ -149,7 +233,8 @@ class BuildQueue extends EventEmitter {
         };
 
         this.jobs.set(job.id, enrichedJob);
-        this.pending.push({ id: job.id, priority });
+        client.pending.add(job.id);
+        this._rechain(client);
         this.metrics.totalEnqueued++;
 
         this.emit('job:added', enrichedJob);
@@ -159,22 +244,35 @@ class BuildQueue extends EventEmitter {
     }
 
     /**
-     * Dequeue the highest priority job
+     * Dequeue the job with the smallest fair share key. `shortOnly`: only a
+     * quick job, unless a long one has waited past QUICK_LANE_MAX_WAIT_MS.
      */
-    dequeue() {
+    dequeue({ shortOnly = false } = {}) {
         if (this.processing.size >= this.maxConcurrency) {
             return null;
         }
 
-        const item = this.pending.pop();
-        if (!item) return null;
+        const short = this.pendingShort.peek();
+        const long = this.pendingLong.peek();
+        let heap = null;
+        if (long && !(shortOnly && Date.now() < this.quickLaneOpensAt())) {
+            heap = this.pendingLong;
+        }
+        if (short && (!heap || before(short, long))) {
+            heap = this.pendingShort;
+        }
+        if (!heap) return null;
 
+        const item = heap.pop();
         const job = this.jobs.get(item.id);
         if (!job || job.state !== STATE.PENDING) {
             // Job was cancelled or already processed, try next
-            return this.dequeue();
+            return this.dequeue({ shortOnly });
         }
 
+        this.virtualTime = Math.max(this.virtualTime, job.fairStart);
+        this._releaseClient(job, true);
+
         job.state = STATE.PROCESSING;
         job.startedAt = Date.now();
         this.processing.add(job.id);
@@ -206,6 +304,7 @@ class BuildQueue extends EventEmitter {
             job.completedAt = job.completedAt || Date.now();
             this.processing.delete(id);
             this._recordProcessingTime(job);
+            if (job.startedAt) this.predictor.observe(job.prediction, job.completedAt - job.startedAt);
             this.metrics.totalCompleted++;
         } else if (updates.status === 'error' || updates.state === STATE.ERROR) {
             job.state = STATE.ERROR;
@@ -234,7 +333,9 @@ class BuildQueue extends EventEmitter {
             job.state = STATE.CANCELLED;
             job.error = reason;
             job.completedAt = Date.now();
-            this.pending.remove(item => item.id === id);
+            (job.short ? this.pendingShort : this.pendingLong).remove(item => item.id === id);
+            // Refunded: the client's later jobs move up its chain
+            this._releaseClient(job, false);
             this.metrics.totalCancelled++;
             this.emit('job:cancelled', job);
             this.emit(`job:${id}`, { type: 'error', message: reason, cancelled: true });
@@ -244,11 +345,100 @@ class BuildQueue extends EventEmitter {
         return false;
     }
 
+    get pendingCount() {
+        return this.pendingShort.length + this.pendingLong.length;
+    }
+
+    // Whether the pool holds its last free worker for quick jobs
+    get quickLaneReserved() {
+        return Math.min(this.maxConcurrency, this.workerCount || this.maxConcurrency) >= QUICK_LANE_MIN_WORKERS;
+    }
+
+    /**
+     * When long jobs may take the quick lane's worker: once the oldest
+     * pending one has waited QUICK_LANE_MAX_WAIT_MS. Null with no long job.
+     */
+    quickLaneOpensAt() {
+        let oldest = Infinity;
+        for (const item of this.pendingLong.heap) {
+            const job = this.jobs.get(item.id);
+            if (job && job.state === STATE.PENDING) oldest = Math.min(oldest, job.enqueuedAt);
+        }
+        return oldest === Infinity ? null : oldest + QUICK_LANE_MAX_WAIT_MS;
+    }
+
+    /**
+     * Expected start and finish of a job. For a pending one: the running
+     * jobs' predicted remaining time and every pending job ahead of it,
+     * list-scheduled onto the workers (jobs queued later can still move
+     * ahead of it). With the quick lane a long job needs a second free
+     * worker, or has to wait for the lane to open.
+     */
+    estimateSchedule(id) {
+        const job = this.jobs.get(id);
+        if (!job) return null;
+        if (job.state === STATE.PROCESSING) {
+            return { buildMs: job.prediction.ms, ahead: 0, startAt: job.startedAt, finishAt: job.startedAt + job.prediction.ms };
+        }
+        if (job.state !== STATE.PENDING) return null;
+
+        const now = Date.now();
+        const slots = [];
+        for (const runningId of this.processing) {
+            const running = this.jobs.get(runningId);
+            slots.push(Math.max(0, running.startedAt + running.prediction.ms - now));
+        }
+        const workers = Math.min(this.maxConcurrency, this.workerCount || this.maxConcurrency);
+        while (slots.length < workers) slots.push(0);
+
+        const mine = [...this.pendingShort.heap, ...this.pendingLong.heap].find(item => item.id === id);
+        const ahead = [...this.pendingShort.heap, ...this.pendingLong.heap]
+            .filter(item => item !== mine && before(item, mine))
+            .sort((a, b) => (before(a, b) ? -1 : 1));
+
+        // Start (ms from now) of `other` on the earliest free worker. A long
+        // job held back by the quick lane starts when a second worker frees
+        // (and takes that one) or when the lane opens; until then the worker
+        // it waits on still runs quick jobs (`lane`, approximately: a quick
+        // job running past the opening doesn't delay it here).
+        const opensAt = this.quickLaneReserved ? this.quickLaneOpensAt() : null;
+        const laneOpensIn = opensAt === null ? 0 : opensAt - now;
+        let lane = null;
+        const place = (other) => {
+            slots.sort((a, b) => a - b);
+            if (other.short && lane !== null && lane < laneOpensIn && lane <= slots[0]) {
+                const start = lane;
+                lane += other.prediction.ms;
+                return start;
+            }
+            let slot = 0;
+            let start = slots[0];
+            if (!other.short && laneOpensIn > slots[0]) {
+                if (laneOpensIn < slots[1]) {
+                    if (lane === null) lane = slots[0];
+                    start = laneOpensIn;
+                } else {
+                    slot = 1;
+                    start = slots[1];
+                }
+            }
+            slots[slot] = start + other.prediction.ms;
+            return start;
+        };
+        for (const item of ahead) {
+            const other = this.jobs.get(item.id);
+            if (other && other.state === STATE.PENDING) place(other);
+        }
+
+        const startAt = now + place(job);
+        return { buildMs: job.prediction.ms, ahead: ahead.length, startAt, finishAt: startAt + job.prediction.ms };
+    }
+
     /**
      * Check if there are pending jobs available to process
      */
     hasPending() {
-        return this.pending.length > 0 && this.processing.size < this.maxConcurrency;
+        return this.pendingCount > 0 && this.processing.size < this.maxConcurrency;
     }
 
     /**
@@ -256,10 +446,17 @@ class BuildQueue extends EventEmitter {
      */
     getStats() {
         return {
-            pending: this.pending.length,
+            pending: this.pendingCount,
             processing: this.processing.size,
             total: this.jobs.size,
             maxConcurrency: this.maxConcurrency,
+            fairShare: {
+                virtualTime: Math.round(this.virtualTime * 1000) / 1000,
+                activeClients: Array.from(this.clients.values()).filter(client => client.pending.size > 0).length,
+                pendingShort: this.pendingShort.length,
+                pendingLong: this.pendingLong.length
+            },
+            predictor: this.predictor.getStats(),
             metrics: { ...this.metrics }
         };
     }
@@ -305,6 +502,77 @@ class BuildQueue extends EventEmitter {
         }
     }
 
+    _client(clientId) {
+        let client = this.clients.get(clientId);
+        if (!client) {
+            if (this.clients.size >= MAX_TRACKED_CLIENTS) this._pruneClients();
+            client = {
+                finish: 0,              // fair finish of its latest started job
+                pending: new Set(),     // its pending job ids
+                clock: 0,               // virtual time among its sessions
+                sessions: new Map()     // sessionId -> session's virtual finish
+            };
+            this.clients.set(clientId, client);
+        }
+        return client;
+    }
+
+    /**
+     * Lay a client's pending jobs on its chain of fair share tags in session
+     * order (inner key), rekeying the ones whose tags changed. A client rarely
+     * has more than a few jobs pending, so the linear heap removes are cheap.
+     */
+    _rechain(client) {
+        const jobs = Array.from(client.pending, id => this.jobs.get(id))
+            .sort((a, b) => a.innerKey - b.innerKey || a.seq - b.seq);
+        let finish = client.finish;
+        for (const job of jobs) {
+            const fairStart = Math.max(job.arrival, finish);
+            finish = fairStart + job.cost;
+            if (job.fairStart === fairStart && job.fairFinish === finish) continue;
+
+            job.fairStart = fairStart;
+            job.fairFinish = finish;
+            const heap = job.short ? this.pendingShort : this.pendingLong;
+            heap.remove(item => item.id === job.id);
+            heap.push({ id: job.id, key: finish - priorityCredit(job.priority), seq: job.seq });
+        }
+    }
+
+    // A pending job leaves its client: started, or cancelled (refunded)
+    _releaseClient(job, started) {
+        const client = this.clients.get(job.clientId);
+        if (!client || !client.pending.delete(job.id)) return;
+
+        if (started) {
+            client.finish = Math.max(client.finish, job.fairFinish);
+            client.clock = Math.max(client.clock, job.innerStart);
+        } else {
+            if (client.sessions.get(job.sessionId) === job.innerStart + job.cost) {
+                client.sessions.set(job.sessionId, job.innerStart);
+            }
+            this._rechain(client);
+        }
+
+        // Nothing pending: sessions start over
+        if (client.pending.size === 0) {
+            client.clock = 0;
+            client.sessions.clear();
+        }
+    }
+
+    /**
+     * Forget idle clients whose finish the virtual clock has passed (they
+     * would start at the clock anyway)
+     */
+    _pruneClients() {
+        for (const [clientId, client] of this.clients) {
+            if (client.finish <= this.virtualTime && client.pending.size === 0) {
+                this.clients.delete(clientId);
+            }
+        }
+    }
+
     /**
      * Record processing time for metrics
      */
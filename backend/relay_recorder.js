@@ -0,0 +1,183 @@
+// Relay recorder: an append-only log of every relayed frame, per match
+//
+// Off unless RELAY_RECORD_DIR is set. Each match a relay room plays (from
+// game start until a player leaves) gets its own file there,
+// <start ms>_<room id>.rlog, written in chunks through an append stream so
+// the relay path only copies the frame into a buffer. tools/replay.js reads
+// the logs back.
+//
+// Format (little-endian):
+//   header   "RLOG" [u8 version][u8 reserved][u16 reserved][f64 start, epoch ms]
+//   record   [u32 µs since the previous record][u16 length][u8 from][u8 flags][payload]
+//            from: player index (the frame went to the other player), 0xff: event
+//            flags: 1 binary, 2 event (payload is JSON: start, leave, gap)
+//
+// If the disk can't keep up (more than RELAY_RECORD_MAX_PENDING bytes not yet
+// written) frames are dropped, not queued, and a gap event records how many.
+// Frames over 64 KB are counted as dropped too.
+
+const fs = require('fs');
+const path = require('path');
+
+const RECORD_DIR = process.env.RELAY_RECORD_DIR || null;
+const FLUSH_MS = 250;
+const CHUNK_SIZE = 64 * 1024;
+const MAX_PENDING = parseInt(process.env.RELAY_RECORD_MAX_PENDING) || 4 * 1024 * 1024;
+
+const MAGIC = 'RLOG';
+const VERSION = 1;
+const HEADER_SIZE = 16;
+const RECORD_HEADER_SIZE = 8;
+const MAX_FRAME = 0xffff;
+const FROM_EVENT = 0xff;
+const FLAG_BINARY = 1;
+const FLAG_EVENT = 2;
+
+class RelayRecorder {
+  constructor() {
+    this.enabled = RECORD_DIR !== null;
+    this.open = new Set();      // rooms being recorded
+    this.timer = null;
+    this.stats = { files: 0, records: 0, bytes: 0, dropped: 0 };
+
+    if (this.enabled) fs.mkdirSync(RECORD_DIR, { recursive: true });
+  }
+
+  // ----------------------------------------------------------------------------
+  // Recording
+  // ----------------------------------------------------------------------------
+
+  start(room, info) {
+    if (!this.enabled || room._recording) return;
+
+    const startedAt = Date.now();
+    const safeId = String(room.id).replace(/[^\w.-]/g, '_');
+    const file = path.join(RECORD_DIR, `${startedAt}_${safeId}.rlog`);
+    const stream = fs.createWriteStream(file, { flags: 'a' });
+    stream.on('error', (err) => {
+      console.error(`[Recorder] ${file}: ${err.message}`);
+      this.stop(room);
+    });
+
+    const header = Buffer.alloc(HEADER_SIZE);
+    header.write(MAGIC, 0, 'latin1');
+    header[4] = VERSION;
+    header.writeDoubleLE(startedAt, 8);
+    stream.write(header);
+
+    room._recording = { file, stream, chunk: Buffer.allocUnsafe(CHUNK_SIZE), length: 0, last: performance.now(), dropped: 0 };
+    this.open.add(room);
+    this.stats.files++;
+    this.event(room, { event: 'start', roomId: room.id, ...info });
+
+    if (!this.timer) this.timer = setInterval(() => this.open.forEach(r => this._flush(r._recording)), FLUSH_MS);
+  }
+
+  // A relayed frame from player `from`
+  record(room, from, data, isBinary) {
+    const rec = room._recording;
+    if (rec) this._append(rec, from, isBinary ? FLAG_BINARY : 0, data);
+  }
+
+  event(room, info) {
+    const rec = room._recording;
+    if (rec) this._append(rec, FROM_EVENT, FLAG_EVENT, Buffer.from(JSON.stringify(info)));
+  }
+
+  stop(room) {
+    const rec = room._recording;
+    if (!rec) return;
+    delete room._recording;
+    this._flush(rec);
+    rec.stream.end();
+    this.open.delete(room);
+    if (this.open.size === 0) {
+      clearInterval(this.timer);
+      this.timer = null;
+    }
+  }
+
+  _append(rec, from, flags, data) {
+    const length = data.length;
+    if (length > MAX_FRAME || rec.stream.writableLength > MAX_PENDING) {
+      rec.dropped++;
+      this.stats.dropped++;
+      return;
+    }
+    if (rec.dropped > 0 && flags !== FLAG_EVENT) {
+      const dropped = rec.dropped;
+      rec.dropped = 0;
+      this._append(rec, FROM_EVENT, FLAG_EVENT, Buffer.from(JSON.stringify({ event: 'gap', dropped })));
+    }
+
+    if (rec.length + RECORD_HEADER_SIZE + length > CHUNK_SIZE) this._flush(rec);
+
+    const now = performance.now();
+    const dt = Math.min(0xffffffff, Math.max(0, Math.round((now - rec.last) * 1000)));
+    rec.last = now;
+
+    // A frame bigger than a chunk gets a chunk of its own
+    const chunk = RECORD_HEADER_SIZE + length > CHUNK_SIZE ? Buffer.allocUnsafe(RECORD_HEADER_SIZE + length) : rec.chunk;
+    let offset = chunk === rec.chunk ? rec.length : 0;
+    chunk.writeUInt32LE(dt, offset);
+    chunk.writeUInt16LE(length, offset + 4);
+    chunk[offset + 6] = from;
+    chunk[offset + 7] = flags;
+    offset += RECORD_HEADER_SIZE;
+    data.copy(chunk, offset);
+
+    if (chunk === rec.chunk) rec.length = offset + length;
+    else rec.stream.write(chunk);
+
+    this.stats.records++;
+    this.stats.bytes += RECORD_HEADER_SIZE + length;
+  }
+
+  _flush(rec) {
+    if (rec.length === 0) return;
+    // The stream keeps the buffer until written; start a new one
+    rec.stream.write(rec.chunk.subarray(0, rec.length));
+    rec.chunk = Buffer.allocUnsafe(CHUNK_SIZE);
+    rec.length = 0;
+  }
+
+  getStats() {
+    return { enabled: this.enabled, recording: this.open.size, ...this.stats };
+  }
+
+  // ----------------------------------------------------------------------------
+  // Reading (tools/replay.js)
+  // ----------------------------------------------------------------------------
+
+  // Parses a whole log: { startedAt, records: [{ t (ms since start), from,
+  // binary, event, data }] }. A record cut off at the end (crash while
+  // writing) is ignored.
+  readLog(buf) {
+    if (buf.length < HEADER_SIZE || buf.toString('latin1', 0, 4) !== MAGIC) throw new Error('Not a relay log');
+    if (buf[4] !== VERSION) throw new Error(`Unsupported relay log version ${buf[4]}`);
+
+    const records = [];
+    let t = 0;
+    let offset = HEADER_SIZE;
+    while (offset + RECORD_HEADER_SIZE <= buf.length) {
+      const length = buf.readUInt16LE(offset + 4);
+      const end = offset + RECORD_HEADER_SIZE + length;
+      if (end > buf.length) break;
+
+      t += buf.readUInt32LE(offset) / 1000;
+      const flags = buf[offset + 7];
+      const data = buf.subarray(offset + RECORD_HEADER_SIZE, end);
+      records.push({
+        t,
+        from: buf[offset + 6],
+        binary: (flags & FLAG_BINARY) !== 0,
+        event: (flags & FLAG_EVENT) ? JSON.parse(data.toString()) : null,
+        data
+      });
+      offset = end;
+    }
+    return { startedAt: buf.readDoubleLE(8), records };
+  }
+}
+
+module.exports = new RelayRecorder();
@@ -40,8 +40,11 @@
 
             js_get_event_count: Module._js_get_event_count,
             js_get_sim_speed: Module._js_get_sim_speed,
+            js_get_turbo: Module._js_get_turbo,
+            js_get_memory_used: Module._js_get_memory_used,
 
             js_set_sim_speed: Module._js_set_sim_speed,
+            js_set_turbo: Module._js_set_turbo,
             js_start_recording: Module._js_start_recording,
             js_stop_recording: Module._js_stop_recording,
             js_start_playback: Module._js_start_playback,
@@ -54,9 +57,173 @@
             js_play: Module._js_play,
             js_go_live: Module._js_go_live,
             js_trim_end: Module._js_trim_end,
+
+            js_export_recording: Module._js_export_recording,
+            js_get_export_data: Module._js_get_export_data,
+            js_free_export: Module._js_free_export,
+            js_import_recording: Module._js_import_recording,
+
+            js_profiler_set_enabled: Module._js_profiler_set_enabled,
+            js_profiler_collect: Module._js_profiler_collect,
+            js_profiler_get_data: Module._js_profiler_get_data,
+            js_profiler_get_names: Module._js_profiler_get_names,
+
+            js_context_layout: Module._js_context_layout,
+            js_context_layout_size: Module._js_context_layout_size,
+            js_migrate_context: Module._js_migrate_context,
+
+            js_save_state: Module._js_save_state,
+            js_load_state: Module._js_load_state,
         };
     }
 
+    // Side modules share the main module's memory; HEAPU8 may be stale after growth
+    function heapU8() {
+        const memory = Module.wasmMemory || (typeof wasmMemory !== 'undefined' ? wasmMemory : null);
+        return memory ? new Uint8Array(memory.buffer) : Module.HEAPU8;
+    }
+
+    // Copy the recording out of the wasm heap and hand it to the editor
+    function exportRecording(A) {
+        const size = A.js_export_recording?.() ?? 0;
+        if (!size) {
+            window.parent.postMessage({ type: 'timeline-recording', error: 'Nothing to export' }, '*');
+            return;
+        }
+
+        const ptr = A.js_get_export_data();
+        const bytes = heapU8().slice(ptr, ptr + size);
+        A.js_free_export?.();
+
+        window.parent.postMessage({ type: 'timeline-recording', bytes: bytes.buffer }, '*', [bytes.buffer]);
+    }
+
+    function importRecording(A, buffer) {
+        if (!A.js_import_recording) return;
+
+        const bytes = new Uint8Array(buffer);
+        const ptr = Module._malloc(bytes.byteLength);
+        if (!ptr) return;
+
+        try {
+            heapU8().set(bytes, ptr);
+            const ok = A.js_import_recording(ptr, bytes.byteLength) === 1;
+            window.parent.postMessage({ type: 'timeline-import-result', ok }, '*');
+        } finally {
+            Module._free(ptr);
+        }
+    }
+
+    // Saved session (SavedStateHeader in game.h): the editor asks for one
+    // before it tears the preview down and keeps it in IndexedDB; the next
+    // preview gets it back. Restores wait for a frame so the game has its
+    // context and memory.
+    let pendingRestore = null;
+    let lastAutosave = null;
+
+    // Autosaves are quiet, and skipped (reply `unchanged`) while the timeline
+    // hasn't moved since the last one: a save copies the whole recording
+    function saveState(A, requestId, autosave) {
+        if (autosave) {
+            const position = `${A.js_get_end_frame?.()}:${A.js_get_current_frame?.()}`;
+            if (position === lastAutosave) {
+                window.parent.postMessage({ type: 'game-state', requestId, unchanged: true }, '*');
+                return;
+            }
+            lastAutosave = position;
+        }
+
+        const size = A.js_save_state?.(autosave ? 1 : 0) ?? 0;
+        if (!size) {
+            window.parent.postMessage({ type: 'game-state', requestId, error: 'Nothing to save' }, '*');
+            return;
+        }
+
+        const ptr = A.js_get_export_data();
+        const bytes = heapU8().slice(ptr, ptr + size);
+        A.js_free_export?.();
+
+        window.parent.postMessage({ type: 'game-state', requestId, bytes: bytes.buffer }, '*', [bytes.buffer]);
+    }
+
+    function applyPendingRestore() {
+        const A = getTimelineAPI();
+        const buffer = pendingRestore;
+        pendingRestore = null;
+        if (!A.js_load_state) return;
+
+        const bytes = new Uint8Array(buffer);
+        const ptr = Module._malloc(bytes.byteLength);
+        if (!ptr) return;
+
+        try {
+            heapU8().set(bytes, ptr);
+            const ok = A.js_load_state(ptr, bytes.byteLength) === 1;
+            window.parent.postMessage({ type: 'game-state-restored', ok }, '*');
+        } finally {
+            Module._free(ptr);
+        }
+    }
+
+    // Profiler panel: frames newer than the last one sent, as the raw float
+    // layout from profiler.h (the panel parses it) plus the zone name table
+    let profilerEnabled = false;
+    let profilerLastFrame = -1;
+
+    function readCString(ptr) {
+        if (!ptr) return '';
+        const heap = heapU8();
+        let end = ptr;
+        while (heap[end] !== 0) end++;
+        return new TextDecoder().decode(heap.subarray(ptr, end));
+    }
+
+    function sendProfilerFrames(A) {
+        if (!profilerEnabled || !A.js_profiler_collect) return;
+
+        const count = A.js_profiler_collect(profilerLastFrame);
+        if (!count) return;
+
+        const ptr = A.js_profiler_get_data();
+        const floats = new Float32Array(heapU8().buffer, ptr, count).slice();
+
+        // Walk the frame headers to find the newest frame number
+        for (let i = 0; i < count; i += 4 + floats[i + 2] * 4) profilerLastFrame = floats[i];
+
+        window.parent.postMessage({
+            type: 'profiler-frames',
+            names: readCString(A.js_profiler_get_names()).split('\n'),
+            data: floats.buffer,
+        }, '*', [floats.buffer]);
+    }
+
+    // GameContext layout of the running game.wasm (context_layout.h), copied
+    // out of the heap before the swap so the new build can migrate from it
+    function captureContextLayout(exports) {
+        if (!exports?.js_context_layout || !exports.js_context_layout_size) return null;
+        const ptr = exports.js_context_layout();
+        return ptr ? heapU8().slice(ptr, ptr + exports.js_context_layout_size()) : null;
+    }
+
+    function migrateContext(exports, oldLayout) {
+        if (!oldLayout || !exports.js_migrate_context || !Module._get_game_context) return;
+
+        const ptr = Module._malloc(oldLayout.byteLength);
+        if (!ptr) return;
+
+        try {
+            heapU8().set(oldLayout, ptr);
+            const oldCtx = Module._get_game_context();
+            const newCtx = exports.js_migrate_context(oldCtx, ptr);
+            if (newCtx && newCtx !== oldCtx) {
+                Module._set_game_context(newCtx);
+                console.log('[HotReload] GameContext migrated to a new layout');
+            }
+        } finally {
+            Module._free(ptr);
+        }
+    }
+
     async function reloadWasm() {
         if (!isLiveCoding) return;
 
@@ -64,6 +231,7 @@
             const url = `${Module.locateFile('game.wasm')}?t=${Date.now()}`;
             const response = await fetch(url);
             const binary = await response.arrayBuffer();
+            const oldLayout = captureContextLayout(gameExports);
 
             // Use Emscripten's native loadWebAssemblyModule for proper side module loading
             gameExports = Module.loadWebAssemblyModule(
@@ -84,6 +252,9 @@
                 }
             }
 
+            // Move the state over before the new code runs a frame on it
+            migrateContext(gameExports, oldLayout);
+
             // update function used by main loop
             updateAndRender = gameExports.update_and_render ?? (() => console.error("update_and_render not exported"));
 
@@ -161,7 +332,10 @@
 
             // Main module calls this function pointer each frame.
             // We provide a wrapper that forwards to the latest hot-reloaded updateAndRender.
-            Module._set_update_and_render_func?.(Module.addFunction(ptr => updateAndRender(ptr), 'vi'));
+            Module._set_update_and_render_func?.(Module.addFunction(ptr => {
+                updateAndRender(ptr);
+                if (pendingRestore) applyPendingRestore();
+            }, 'vi'));
 
             // Load side module once at startup
             await reloadWasm();
@@ -202,6 +376,8 @@
                     isPaused: (A.js_is_paused?.() ?? 0) === 1,
                     eventCount: A.js_get_event_count?.() ?? 0,
                     simSpeed: A.js_get_sim_speed?.() ?? 1,
+                    turboSteps: A.js_get_turbo?.() ?? 0,
+                    memoryUsed: A.js_get_memory_used?.() ?? 0,
                 };
 
                 window.parent.postMessage(state, '*');
@@ -262,11 +438,37 @@
                             A.js_set_sim_speed?.(data.speed);
                         }
                         break;
+                    case 'set-turbo':
+                        if (typeof data.steps === 'number') {
+                            A.js_set_turbo?.(Math.round(data.steps));
+                        }
+                        break;
                     case 'trim-end':
                         if (typeof data.frame === 'number') {
                             A.js_trim_end?.(Math.round(data.frame));
                         }
                         break;
+                    case 'export-recording':
+                        exportRecording(A);
+                        break;
+                    case 'import-recording':
+                        if (data.bytes instanceof ArrayBuffer) {
+                            importRecording(A, data.bytes);
+                        }
+                        break;
+                    case 'save-state':
+                        saveState(A, data.requestId, !!data.autosave);
+                        break;
+                    case 'restore-state':
+                        if (data.bytes instanceof ArrayBuffer) {
+                            pendingRestore = data.bytes;
+                        }
+                        break;
+                    case 'profiler-enable':
+                        profilerEnabled = !!data.enabled;
+                        profilerLastFrame = -1;
+                        A.js_profiler_set_enabled?.(profilerEnabled ? 1 : 0);
+                        break;
                     case 'get-state':
                         sendTimelineState();
                         break;
@@ -282,6 +484,15 @@
         // Poll and send state every 50ms for smoother updates
         setInterval(sendTimelineState, 50);
 
+        // Profiler frames: the ring holds 128 frames, ~2s at 60fps
+        setInterval(() => {
+            try {
+                sendProfilerFrames(getTimelineAPI());
+            } catch {
+                // not ready yet
+            }
+        }, 250);
+
         window.parent.postMessage({ type: 'timeline-bridge-ready' }, '*');
         console.log('[TimelineBridge] Initialized');
     }
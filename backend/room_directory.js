@@ -0,0 +1,162 @@
+// Room directory: which game process owns which room
+//
+// The relay forwards between sockets of the same process, so both players of
+// a room have to be connected to the process that owns it. The directory
+// records each room's owner (and what list_rooms shows) and, per matchmaking
+// queue, which processes have a player waiting, so the primary can hand the
+// next connection to a process where it will find an opponent.
+//
+// LocalDirectory is the store. With GAME_WORKERS=0 the game server uses it
+// in-process; otherwise it lives in the primary and game workers reach it
+// through IpcDirectory. Both expose request(op, ...args) -> Promise.
+
+// Ops that act on behalf of a process: the owner is filled in by whoever
+// knows the caller (the primary for IPC, forOwner() in-process)
+const OWNED_OPS = new Set(['register', 'update', 'unregister', 'setWaiting']);
+const QUERY_OPS = new Set(['lookup', 'list']);
+
+// list_rooms pages come from a snapshot of the joinable set, rebuilt at most
+// this often, so a burst of listings costs one copy rather than one each
+const LIST_SNAPSHOT_MS = 250;
+const LIST_PAGE_SIZE = 50;
+const LIST_MAX_PAGE_SIZE = 200;
+
+class LocalDirectory {
+  constructor() {
+    this.rooms = new Map();     // roomId -> { owner, players, state }
+    this.joinable = new Map();  // roomId -> entry, maintained on every change
+    this.waiting = new Map();   // queue key -> Map(owner -> waiting players)
+
+    this.snapshot = null;       // [{ id, players }] of joinable, for list()
+    this.snapshotAt = 0;
+    this.snapshotDirty = true;
+  }
+
+  _index(roomId, entry) {
+    const open = entry !== null && entry.state === 'waiting' && entry.players < 2;
+    if (open) this.joinable.set(roomId, entry);
+    else if (!this.joinable.delete(roomId)) return;
+    this.snapshotDirty = true;
+  }
+
+  register(owner, roomId, info = {}) {
+    if (this.rooms.has(roomId)) return false;
+    const entry = { owner, players: 0, state: 'waiting', ...info };
+    this.rooms.set(roomId, entry);
+    this._index(roomId, entry);
+    return true;
+  }
+
+  update(owner, roomId, info) {
+    const entry = this.rooms.get(roomId);
+    if (!entry || entry.owner !== owner) return;
+    Object.assign(entry, info);
+    this._index(roomId, entry);
+  }
+
+  unregister(owner, roomId) {
+    const entry = this.rooms.get(roomId);
+    if (!entry || entry.owner !== owner) return;
+    this.rooms.delete(roomId);
+    this._index(roomId, null);
+  }
+
+  lookup(roomId) {
+    const entry = this.rooms.get(roomId);
+    return entry ? entry.owner : null;
+  }
+
+  // One page of the rooms that can be joined (oldest first); may lag
+  // changes by up to LIST_SNAPSHOT_MS
+  list(offset = 0, limit = LIST_PAGE_SIZE) {
+    offset = Math.max(0, offset | 0);
+    limit = Math.min(LIST_MAX_PAGE_SIZE, Math.max(1, limit | 0 || LIST_PAGE_SIZE));
+
+    const now = Date.now();
+    if (!this.snapshot || (this.snapshotDirty && now - this.snapshotAt >= LIST_SNAPSHOT_MS)) {
+      this.snapshot = Array.from(this.joinable, ([id, entry]) => ({ id, players: entry.players }));
+      this.snapshotAt = now;
+      this.snapshotDirty = false;
+    }
+
+    const total = this.snapshot.length;
+    const rooms = this.snapshot.slice(offset, offset + limit);
+    return { rooms, total, offset, next: offset + limit < total ? offset + limit : null };
+  }
+
+  setWaiting(owner, key, count) {
+    let owners = this.waiting.get(key);
+    if (!owners) this.waiting.set(key, owners = new Map());
+    if (count > 0) owners.set(owner, count);
+    else owners.delete(owner);
+  }
+
+  // Some process with a player waiting in `key`, or null
+  ownerWaiting(key) {
+    const owners = this.waiting.get(key);
+    if (!owners) return null;
+    for (const owner of owners.keys()) return owner;
+    return null;
+  }
+
+  // A process went away: forget its rooms and waiting players
+  dropOwner(owner) {
+    this.rooms.forEach((entry, id) => {
+      if (entry.owner !== owner) return;
+      this.rooms.delete(id);
+      this._index(id, null);
+    });
+    this.waiting.forEach(owners => owners.delete(owner));
+  }
+
+  get size() {
+    return this.rooms.size;
+  }
+
+  // Serves a request from `owner` (IPC or in-process)
+  handle(owner, op, args) {
+    if (OWNED_OPS.has(op)) return this[op](owner, ...args);
+    if (QUERY_OPS.has(op)) return this[op](...args);
+    throw new Error(`Unknown directory op ${op}`);
+  }
+
+  forOwner(owner) {
+    return {
+      request: (op, ...args) => {
+        try {
+          return Promise.resolve(this.handle(owner, op, args));
+        } catch (err) {
+          return Promise.reject(err);
+        }
+      }
+    };
+  }
+}
+
+// Game worker side: requests go to the primary over the cluster IPC channel
+class IpcDirectory {
+  constructor(channel = process) {
+    this.channel = channel;
+    this.nextId = 1;
+    this.pending = new Map();   // request id -> { resolve, reject }
+
+    channel.on('message', (msg) => {
+      if (!msg || msg.cmd !== 'directory-reply') return;
+      const request = this.pending.get(msg.id);
+      if (!request) return;
+      this.pending.delete(msg.id);
+      if (msg.error) request.reject(new Error(msg.error));
+      else request.resolve(msg.result);
+    });
+  }
+
+  request(op, ...args) {
+    const id = this.nextId++;
+    return new Promise((resolve, reject) => {
+      this.pending.set(id, { resolve, reject });
+      this.channel.send({ cmd: 'directory', id, op, args });
+    });
+  }
+}
+
+module.exports = { LocalDirectory, IpcDirectory };
@@ -9,12 +9,18 @@ const WebSocket = require('ws');
 const rateLimit = require('express-rate-limit');
 const queue = require('./queue');
 const worker = require('./worker');
+const gameServer = require('./game_server');
 
 
 const app = express();
 app.set('trust proxy', 1); // Enable trust proxy for KTH Cloud load balancer
 const PORT = process.env.PORT || 3001;
 
+// Game relay processes (see game_server.js); 0 keeps it in this process.
+// Off by default: matchmaking across workers relies on clients sending
+// ?match= / ?room=, which a client of the old protocol doesn't
+const GAME_WORKERS = parseInt(process.env.GAME_WORKERS) || 0;
+
 // Create HTTP server (needed for WebSocket upgrade)
 const server = http.createServer(app);
 
@@ -87,6 +93,16 @@ const sseConnections = new Map(); // buildId -> Set of response objects
 // API ROUTES
 // ============================================================================
 
+// Fair-share identity for the build queue: the share belongs to the IP. The
+// browser's X-Client-Id is unauthenticated, so it only splits its IP's share
+// between sessions (see queue.js); a fresh id buys no extra capacity.
+const SESSION_ID_RE = /^[\w-]{8,64}$/;
+
+function buildSessionId(req) {
+  const session = req.get('X-Client-Id');
+  return session && SESSION_ID_RE.test(session) ? session : '';
+}
+
 // POST /api/build - Submit a new build
 app.post('/api/build', buildLimiter, (req, res) => {
   try {
@@ -110,15 +126,19 @@ app.post('/api/build', buildLimiter, (req, res) => {
       buildProfile,
       buildConfig,
       targetBuildId,
+      clientId: `ip:${req.ip}`,
+      sessionId: buildSessionId(req),
       status: 'queued',
       phase: 'queued',
       createdAt: Date.now()
     };
 
     queue.enqueue(job);
-    console.log(`[Server] Build ${buildId} queued with ${files.length} files`);
+    const estimate = queue.estimateSchedule(buildId);
+    console.log(`[Server] Build ${buildId} queued with ${files.length} files (~${estimate?.buildMs} ms, ${estimate?.ahead} ahead)`);
 
-    res.json({ buildId, status: 'queued' });
+    // estimate: { buildMs, ahead, startAt, finishAt } (epoch ms)
+    res.json({ buildId, status: 'queued', estimate });
 
   } catch (err) {
     console.error('[Server] Build submission error:', err);
@@ -233,9 +253,165 @@ app.get('/preview/:id', (req, res) => {
   res.redirect(`/preview/${req.params.id}/index.html`);
 });
 
+// ============================================================================
+// TIMELINE RECORDINGS
+// ============================================================================
+
+// Recordings use the fixed-stride layout from game.h (RecordingHeader), so
+// they are stored as-is and individual keyframes are served with ranged reads.
+const RECORDINGS_DIR = process.env.RECORDINGS_DIR || path.join(__dirname, 'recordings');
+const MAX_RECORDING_SIZE = 64 * 1024 * 1024; // 64 MB
+const RECORDING_MAGIC = 0x43455247;          // "GREC"
+const RECORDING_HEADER_SIZE = 64;
+const RECORDING_ID_RE = /^[0-9a-f-]{36}$/;
+
+if (!fs.existsSync(RECORDINGS_DIR)) {
+  fs.mkdirSync(RECORDINGS_DIR, { recursive: true });
+}
+
+const recordingLimiter = rateLimit({
+  windowMs: 60 * 1000,
+  max: 20,
+  message: { error: 'Too many uploads, please wait' },
+  standardHeaders: true,
+  legacyHeaders: false,
+});
+
+function parseRecordingHeader(buf) {
+  if (buf.length < RECORDING_HEADER_SIZE) return null;
+  const header = {
+    magic: buf.readUInt32LE(0),
+    version: buf.readUInt32LE(4),
+    headerSize: buf.readUInt32LE(8),
+    keyframeStride: buf.readUInt32LE(12),
+    eventStride: buf.readUInt32LE(16),
+    startFrame: buf.readInt32LE(20),
+    endFrame: buf.readInt32LE(24),
+    keyframeCount: buf.readInt32LE(28),
+    eventCount: buf.readInt32LE(32),
+    keyframeOffset: buf.readUInt32LE(36),
+    eventOffset: buf.readUInt32LE(40),
+    totalSize: buf.readUInt32LE(44),
+  };
+  return header.magic === RECORDING_MAGIC ? header : null;
+}
+
+// Every section must lie inside the file; /frames/:frame reads from these
+function recordingLayoutValid(header) {
+  const keyframeEnd = header.keyframeOffset + header.keyframeCount * header.keyframeStride;
+  const eventEnd = header.eventOffset + header.eventCount * header.eventStride;
+  return header.headerSize >= RECORDING_HEADER_SIZE &&
+    header.keyframeStride > 0 && header.eventStride > 0 &&
+    header.startFrame >= 0 && header.keyframeCount > 0 &&
+    header.keyframeCount === header.endFrame - header.startFrame + 1 &&
+    header.eventCount >= 0 &&
+    header.keyframeOffset >= header.headerSize && keyframeEnd <= header.totalSize &&
+    header.eventOffset >= header.headerSize && eventEnd <= header.totalSize;
+}
+
+function readRecordingHeader(filePath) {
+  const fd = fs.openSync(filePath, 'r');
+  try {
+    const buf = Buffer.alloc(RECORDING_HEADER_SIZE);
+    const n = fs.readSync(fd, buf, 0, RECORDING_HEADER_SIZE, 0);
+    return parseRecordingHeader(buf.subarray(0, n));
+  } finally {
+    fs.closeSync(fd);
+  }
+}
+
+function recordingPath(id) {
+  return RECORDING_ID_RE.test(id) ? path.join(RECORDINGS_DIR, `${id}.grec`) : null;
+}
+
+// POST /api/recordings - Stream a recording to storage (application/octet-stream)
+app.post('/api/recordings', recordingLimiter, (req, res) => {
+  const recordingId = uuidv4();
+  const finalPath = recordingPath(recordingId);
+  const partPath = `${finalPath}.part`;
+  const out = fs.createWriteStream(partPath);
+  let received = 0;
+  let failed = false;
+
+  const fail = (status, error) => {
+    if (failed) return;
+    failed = true;
+    req.unpipe(out);
+    out.destroy();
+    fs.rm(partPath, { force: true }, () => { });
+    if (!res.headersSent) res.status(status).json({ error });
+  };
+
+  req.on('data', (chunk) => {
+    received += chunk.length;
+    if (received > MAX_RECORDING_SIZE) {
+      fail(413, 'Recording too large');
+      req.resume();
+    }
+  });
+  req.on('aborted', () => fail(400, 'Upload aborted'));
+  out.on('error', (err) => fail(500, err.message));
+
+  out.on('finish', () => {
+    if (failed) return;
+
+    const header = readRecordingHeader(partPath);
+    if (!header || header.totalSize !== received || !recordingLayoutValid(header)) {
+      return fail(400, 'Not a valid recording');
+    }
+
+    fs.rename(partPath, finalPath, (err) => {
+      if (err) return fail(500, err.message);
+      console.log(`[Server] Recording ${recordingId} stored (${received} bytes, frames ${header.startFrame}-${header.endFrame})`);
+      res.json({
+        recordingId,
+        size: received,
+        startFrame: header.startFrame,
+        endFrame: header.endFrame,
+      });
+    });
+  });
+
+  req.pipe(out);
+});
+
+// GET /api/recordings/:id - Whole file (supports Range requests)
+app.get('/api/recordings/:id', (req, res) => {
+  const filePath = recordingPath(req.params.id);
+  if (!filePath) return res.status(400).json({ error: 'Invalid recording id' });
+
+  res.sendFile(filePath, { headers: { 'Content-Type': 'application/octet-stream' } }, (err) => {
+    if (err && !res.headersSent) res.status(404).json({ error: 'Recording not found' });
+  });
+});
+
+// GET /api/recordings/:id/frames/:frame - Single keyframe, one header read + one ranged read
+app.get('/api/recordings/:id/frames/:frame', (req, res) => {
+  const filePath = recordingPath(req.params.id);
+  if (!filePath) return res.status(400).json({ error: 'Invalid recording id' });
+
+  let header;
+  try {
+    header = readRecordingHeader(filePath);
+  } catch (e) {
+    return res.status(404).json({ error: 'Recording not found' });
+  }
+  if (!header || !recordingLayoutValid(header)) return res.status(422).json({ error: 'Corrupt recording' });
+
+  const frame = parseInt(req.params.frame, 10);
+  if (!Number.isInteger(frame) || frame < header.startFrame || frame > header.endFrame) {
+    return res.status(416).json({ error: `Frame out of range (${header.startFrame}-${header.endFrame})` });
+  }
+
+  const start = header.keyframeOffset + (frame - header.startFrame) * header.keyframeStride;
+  res.setHeader('Content-Type', 'application/octet-stream');
+  res.setHeader('Content-Length', header.keyframeStride);
+  fs.createReadStream(filePath, { start, end: start + header.keyframeStride - 1 }).pipe(res);
+});
+
 // Health check
 app.get('/health', (req, res) => {
-  res.json({ status: 'ok', uptime: process.uptime() });
+  res.json({ status: 'ok', uptime: process.uptime(), cpu: process.cpuUsage(), game: game.stats() });
 });
 
 // KTH Cloud health check
@@ -258,12 +434,12 @@ server.on('upgrade', (request, socket, head) => {
     });
   } else {
     // Route all other WebSocket connections to the game server
-    wssGame.handleUpgrade(request, socket, head, (ws) => {
-      wssGame.emit('connection', ws, request);
-    });
+    game.handleUpgrade(request, socket, head);
   }
 });
 
+const game = gameServer.createHost(GAME_WORKERS);
+
 
 server.listen(PORT, '0.0.0.0', () => {
   console.log(`[Server] Build server running on http://localhost:${PORT}`);
@@ -273,6 +449,8 @@ server.listen(PORT, '0.0.0.0', () => {
   console.log(`  GET  /api/build/:id/events - SSE stream`);
   console.log(`  GET  /api/build/:id/result - Poll status`);
   console.log(`  GET  /preview/:id/*      - Serve built files`);
+  console.log(`  POST /api/recordings     - Upload timeline recording`);
+  console.log(`  GET  /api/recordings/:id - Download timeline recording`);
 
   // Wire up hot-reload notifications
   worker.onBuildComplete = (jobId, event) => {
@@ -292,292 +470,3 @@ process.on('SIGINT', () => {
   worker.stop();
   process.exit(0);
 });
-
-// ============================================================================
-// GAME SERVER - Hybrid Multiplayer (Binary + JSON)
-// ============================================================================
-
-const wssGame = new WebSocket.Server({ noServer: true });
-
-// Room-based game sessions (for JSON clients)
-const gameRooms = new Map();     // roomId -> { players: Set, state: 'waiting'|'playing' }
-const playerToRoom = new Map();  // ws -> roomId
-const quickMatchQueue = [];      // Array of waiting players for auto-match
-
-// Legacy binary matching (for SDL_Net clients)
-const binaryQueue = [];          // Waiting binary players
-
-/**
- * Create a new game room
- */
-function createRoom(roomId) {
-  if (gameRooms.has(roomId)) return null;
-  const room = {
-    id: roomId,
-    players: new Set(),
-    state: 'waiting',
-    createdAt: Date.now()
-  };
-  gameRooms.set(roomId, room);
-  console.log(`[GameServer] Room ${roomId} created`);
-  return room;
-}
-
-/**
- * Join a player to a room
- */
-function joinRoom(ws, roomId) {
-  const room = gameRooms.get(roomId);
-  if (!room) return { error: 'Room not found' };
-  if (room.players.size >= 2) return { error: 'Room is full' };
-  if (room.state === 'playing') return { error: 'Game already in progress' };
-
-  room.players.add(ws);
-  playerToRoom.set(ws, roomId);
-
-  if (room.players.size === 2) {
-    startGame(room);
-  }
-
-  return { success: true, room };
-}
-
-/**
- * Start a game in a room
- */
-function startGame(room) {
-  room.state = 'playing';
-  const players = Array.from(room.players);
-
-  console.log(`[GameServer] Game started in room ${room.id}`);
-
-  players.forEach((player, index) => {
-    if (player._isJson) {
-      player.send(JSON.stringify({
-        type: 'game_start',
-        roomId: room.id,
-        playerIndex: index,
-        message: 'Match started!'
-      }));
-    }
-  });
-
-  // Set up message forwarding
-  players.forEach((player, index) => {
-    const opponent = players[1 - index];
-    player._gameMessageHandler = (data) => {
-      if (opponent.readyState === WebSocket.OPEN) {
-        opponent.send(data);
-      }
-    };
-    player.on('message', player._gameMessageHandler);
-  });
-}
-
-/**
- * Remove a player from their room
- */
-function leaveRoom(ws) {
-  const roomId = playerToRoom.get(ws);
-  if (!roomId) return;
-
-  const room = gameRooms.get(roomId);
-  if (room) {
-    room.players.delete(ws);
-
-    room.players.forEach(player => {
-      if (player.readyState === WebSocket.OPEN) {
-        if (player._isJson) {
-          player.send(JSON.stringify({ type: 'player_left', message: 'Opponent disconnected' }));
-        }
-      }
-    });
-
-    if (room.players.size === 0) {
-      gameRooms.delete(roomId);
-      console.log(`[GameServer] Room ${roomId} deleted (empty)`);
-    } else {
-      room.state = 'waiting';
-    }
-  }
-
-  playerToRoom.delete(ws);
-
-  // Remove from queues
-  let idx = quickMatchQueue.indexOf(ws);
-  if (idx !== -1) quickMatchQueue.splice(idx, 1);
-
-  idx = binaryQueue.indexOf(ws);
-  if (idx !== -1) binaryQueue.splice(idx, 1);
-
-  if (ws._gameMessageHandler) {
-    ws.off('message', ws._gameMessageHandler);
-  }
-}
-
-/**
- * Quick match - auto pair JSON players
- */
-function quickMatch(ws) {
-  while (quickMatchQueue.length > 0) {
-    const opponent = quickMatchQueue.shift();
-    if (opponent.readyState === WebSocket.OPEN && opponent !== ws) {
-      const roomId = `quick_${Date.now()}_${Math.random().toString(36).substr(2, 6)}`;
-      const room = createRoom(roomId);
-      joinRoom(opponent, roomId);
-      joinRoom(ws, roomId);
-      return { matched: true, roomId };
-    }
-  }
-
-  quickMatchQueue.push(ws);
-  return { matched: false, message: 'Waiting for opponent...' };
-}
-
-/**
- * Binary auto-match for SDL_Net clients (legacy mode)
- */
-function binaryMatch(ws) {
-  while (binaryQueue.length > 0) {
-    const opponent = binaryQueue.shift();
-    if (opponent.readyState === WebSocket.OPEN && opponent !== ws) {
-      // Pair them in a room
-      const roomId = `binary_${Date.now()}`;
-      const room = createRoom(roomId);
-      room.players.add(opponent);
-      room.players.add(ws);
-      playerToRoom.set(opponent, roomId);
-      playerToRoom.set(ws, roomId);
-      room.state = 'playing';
-
-      console.log(`[GameServer] Binary match started in room ${roomId}`);
-
-      // Set up bidirectional forwarding
-      ws._gameMessageHandler = (data) => {
-        if (opponent.readyState === WebSocket.OPEN) opponent.send(data);
-      };
-      opponent._gameMessageHandler = (data) => {
-        if (ws.readyState === WebSocket.OPEN) ws.send(data);
-      };
-      ws.on('message', ws._gameMessageHandler);
-      opponent.on('message', opponent._gameMessageHandler);
-
-      return true;
-    }
-  }
-
-  binaryQueue.push(ws);
-  console.log(`[GameServer] Binary player waiting (${binaryQueue.length} in queue)`);
-  return false;
-}
-
-wssGame.on('connection', (ws) => {
-  console.log('[GameServer] Client connected');
-
-  ws.on('error', console.error);
-  ws._isJson = false;
-  ws._firstMessage = true;
-
-  ws.on('message', (data) => {
-    // First message determines protocol
-    if (ws._firstMessage) {
-      ws._firstMessage = false;
-
-      // Try to parse as JSON
-      try {
-        const str = data.toString();
-        if (str.startsWith('{')) {
-          const msg = JSON.parse(str);
-          ws._isJson = true;
-          handleJsonMessage(ws, msg);
-          return;
-        }
-      } catch (e) {
-        // Not JSON
-      }
-
-      // Binary mode - auto-match
-      ws._isJson = false;
-      console.log('[GameServer] Binary client detected, auto-matching...');
-      binaryMatch(ws);
-
-      // Forward this first message if already matched
-      if (playerToRoom.has(ws) && ws._gameMessageHandler) {
-        // Already handled by binaryMatch
-      }
-      return;
-    }
-
-    // Subsequent messages
-    if (ws._isJson) {
-      try {
-        const msg = JSON.parse(data.toString());
-        handleJsonMessage(ws, msg);
-      } catch (e) {
-        // Forward as game data
-      }
-    }
-    // Binary messages are forwarded by _gameMessageHandler
-  });
-
-  ws.on('close', () => {
-    leaveRoom(ws);
-    console.log('[GameServer] Client disconnected');
-  });
-});
-
-function handleJsonMessage(ws, msg) {
-  switch (msg.type) {
-    case 'create': {
-      const roomId = msg.roomId || `room_${Date.now()}`;
-      const room = createRoom(roomId);
-      if (!room) {
-        ws.send(JSON.stringify({ type: 'error', message: 'Room already exists' }));
-        return;
-      }
-      const result = joinRoom(ws, roomId);
-      ws.send(JSON.stringify({ type: 'room_created', roomId, ...result }));
-      break;
-    }
-
-    case 'join': {
-      const result = joinRoom(ws, msg.roomId);
-      if (result.error) {
-        ws.send(JSON.stringify({ type: 'error', message: result.error }));
-      } else {
-        ws.send(JSON.stringify({ type: 'room_joined', roomId: msg.roomId }));
-      }
-      break;
-    }
-
-    case 'quick_match': {
-      const result = quickMatch(ws);
-      ws.send(JSON.stringify({
-        type: result.matched ? 'matched' : 'waiting',
-        ...result
-      }));
-      break;
-    }
-
-    case 'list_rooms': {
-      const rooms = [];
-      gameRooms.forEach((room, id) => {
-        if (room.state === 'waiting' && room.players.size < 2) {
-          rooms.push({ id, players: room.players.size });
-        }
-      });
-      ws.send(JSON.stringify({ type: 'room_list', rooms }));
-      break;
-    }
-
-    case 'leave': {
-      leaveRoom(ws);
-      ws.send(JSON.stringify({ type: 'left_room' }));
-      break;
-    }
-  }
-}
-
-
-
-
@@ -0,0 +1,190 @@
+// Spectator fan-out for game rooms
+//
+// Any number of sockets can watch a room. They don't get the players'
+// stream: each room keeps only the latest frame per kind (latest-wins), and
+// a shared tick at SPECTATOR_HZ writes whatever changed. Each frame is
+// framed once, as a complete WebSocket message, and that one Buffer is
+// written to every spectator's socket, so a match with hundreds of viewers
+// costs one serialization per update rather than one per viewer, and none
+// of it runs on the players' path.
+//
+// What is kept, per room:
+//   authoritative rooms    the latest snapshot (authority.js)
+//   relay rooms            the latest [0x03 TAG_STATE][u8 channel] frame per
+//                          player and channel, forwarded as the player sent it
+// Other relayed messages (ordered data, pong inputs) are not useful without
+// the whole stream and are not shown to spectators; binary rooms (rollback
+// pong, inputs only) refuse them outright.
+//
+// A spectator that joins mid-match gets the kept frames right away. One whose
+// bufferedAmount is over SPECTATOR_MAX_BUFFERED skips updates until it
+// drains (and then gets every kept frame); if it stays behind for
+// SPECTATOR_MAX_LAG_MS it is closed.
+//
+// Frames are written to the socket directly, bypassing ws's Sender; that is
+// only safe while wssGame has no permessage-deflate (ws's default for a
+// server), so nothing is ever queued inside the Sender.
+
+const WebSocket = require('ws');
+
+const SPECTATOR_HZ = parseInt(process.env.SPECTATOR_HZ) || 20;
+const MAX_BUFFERED = parseInt(process.env.SPECTATOR_MAX_BUFFERED) || 32 * 1024;  // bytes in ws
+const MAX_LAG_MS = parseInt(process.env.SPECTATOR_MAX_LAG_MS) || 5000;
+const MAX_PER_ROOM = parseInt(process.env.SPECTATOR_MAX_PER_ROOM) || 1000;
+
+const TAG_STATE = 0x03;
+const KEY_SNAPSHOT = 0;
+
+// Complete unmasked binary WebSocket frame for `data`, ready to write
+function frame(data) {
+  return Buffer.concat(WebSocket.Sender.frame(data, {
+    fin: true, rsv1: false, opcode: 0x02, mask: false, readOnly: false
+  }));
+}
+
+class Spectators {
+  constructor() {
+    this.dirty = new Set();     // rooms with frames newer than the last tick
+    this.watching = 0;
+    this.timer = null;
+    this.stats = { framed: 0, writes: 0, skipped: 0, closed: 0 };
+  }
+
+  _feed(room) {
+    if (!room._feed) room._feed = { latest: new Map(), changed: new Set() };  // key -> payload
+    return room._feed;
+  }
+
+  // ----------------------------------------------------------------------------
+  // Watching
+  // ----------------------------------------------------------------------------
+
+  watch(room, ws) {
+    if (!room.spectators) room.spectators = new Set();
+    if (room.spectators.size >= MAX_PER_ROOM) return false;
+    if (room.spectators.has(ws)) return true;
+
+    room.spectators.add(ws);
+    ws._spectating = room;
+    ws._spectatorLagSince = 0;
+    ws._spectatorBehind = false;
+    this.watching++;
+
+    if (!this.timer) this._start();
+    return true;
+  }
+
+  // Joining mid-match: whatever is current, straight away
+  catchUp(ws) {
+    const feed = ws._spectating?._feed;
+    if (feed) feed.latest.forEach(data => ws.send(data));
+  }
+
+  unwatch(ws) {
+    const room = ws._spectating;
+    if (!room) return;
+    delete ws._spectating;
+    if (room.spectators.delete(ws)) this.watching--;
+    if (this.watching === 0) this._stop();
+  }
+
+  // Detaches everyone watching `room` (it is going away); returns them
+  release(room) {
+    const released = room.spectators ? Array.from(room.spectators) : [];
+    released.forEach(ws => this.unwatch(ws));
+    this.dirty.delete(room);
+    delete room._feed;
+    return released;
+  }
+
+  // ----------------------------------------------------------------------------
+  // Publishing
+  // ----------------------------------------------------------------------------
+
+  // Latest authoritative snapshot of a room
+  publishSnapshot(room, data) {
+    this._publish(room, KEY_SNAPSHOT, data);
+  }
+
+  // A relayed message from player `index`; only state frames are kept
+  publishRelay(room, index, data, isBinary) {
+    if (!isBinary || data.length < 2 || data[0] !== TAG_STATE) return;
+    this._publish(room, ((index + 1) << 8) | data[1], data);
+  }
+
+  _publish(room, key, data) {
+    const feed = this._feed(room);
+    feed.latest.set(key, data);
+    if (!room.spectators || room.spectators.size === 0) return;
+    feed.changed.add(key);
+    this.dirty.add(room);
+  }
+
+  // ----------------------------------------------------------------------------
+  // Tick
+  // ----------------------------------------------------------------------------
+
+  _start() {
+    this.timer = setInterval(() => this._tick(), 1000 / SPECTATOR_HZ);
+  }
+
+  _stop() {
+    clearInterval(this.timer);
+    this.timer = null;
+    this.dirty.clear();
+  }
+
+  _tick() {
+    const now = Date.now();
+    for (const room of this.dirty) {
+      const feed = room._feed;
+      const changed = [];
+      for (const key of feed.changed) changed.push(frame(feed.latest.get(key)));
+      feed.changed.clear();
+      this.stats.framed += changed.length;
+
+      // A spectator that skipped updates gets every kept frame, not just the
+      // changed ones (also framed once, when the first one needs it)
+      let all = null;
+      for (const ws of room.spectators) {
+        if (ws._spectatorBehind && !all) {
+          all = Array.from(feed.latest.values(), frame);
+          this.stats.framed += all.length;
+        }
+        this._write(ws, ws._spectatorBehind ? all : changed, now);
+      }
+    }
+    this.dirty.clear();
+  }
+
+  _write(ws, frames, now) {
+    const socket = ws._socket;
+    if (ws.readyState !== WebSocket.OPEN || !socket) return;
+
+    if (ws.bufferedAmount > MAX_BUFFERED) {
+      this.stats.skipped++;
+      ws._spectatorBehind = true;
+      if (!ws._spectatorLagSince) ws._spectatorLagSince = now;
+      else if (now - ws._spectatorLagSince > MAX_LAG_MS) {
+        console.warn(`[Spectators] Closing lagging spectator (${ws.bufferedAmount} bytes buffered)`);
+        this.stats.closed++;
+        this.unwatch(ws);
+        ws.close(1013, 'Spectator too slow');
+      }
+      return;
+    }
+    ws._spectatorBehind = false;
+    ws._spectatorLagSince = 0;
+
+    socket.cork();
+    for (const data of frames) socket.write(data);
+    socket.uncork();
+    this.stats.writes++;
+  }
+
+  getStats() {
+    return { hz: SPECTATOR_HZ, watching: this.watching, ...this.stats };
+  }
+}
+
+module.exports = new Spectators();
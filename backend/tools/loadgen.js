@@ -0,0 +1,528 @@
+#!/usr/bin/env node
+// Headless bot load generator for the game relay
+//
+// Opens pairs of bot clients against a local backend's game endpoint, lets
+// them find each other the way real clients do and play scripted matches at
+// game packet rates, then reports match setup time, relay latency, dropped
+// connections and the server's CPU (from /health). Localhost only: it is
+// meant for pre-release checks on the machine running the backend.
+//
+//   node tools/loadgen.js --matches 200 --duration 30 --mode mix
+//
+// Modes (one per match; "mix" cycles through them):
+//   binary   SDL_Net pong clients: framed NetHeader packets (game/game.c),
+//            hello in the lobby, then input packets every NET_SEND_INTERVAL
+//   quick    JSON quick_match, then binary [0x03 TAG_STATE] frames
+//   room     JSON create + join (?room=<id>), then TAG_STATE frames
+//   auth     JSON quick_match with authoritative: true, 'I' input messages
+//
+// Relay latency: every relayed packet carries its sender's bot id and
+// sequence number (in the pong matchId field for binary bots), and the
+// receiving bot looks up when that packet was sent, so it is measured on one
+// clock. Coalescing in the relay means not every packet arrives; the ones
+// that do are measured. Authoritative matches have no relayed traffic and
+// report the snapshot rate instead.
+//
+// Exit status is 1 if a connection dropped or a match never started.
+
+const http = require('http');
+const WebSocket = require('ws');
+
+// ----------------------------------------------------------------------------
+// Options
+// ----------------------------------------------------------------------------
+
+const DEFAULTS = {
+  url: 'ws://127.0.0.1:3001/',
+  health: null,               // default: http on the url's host and port
+  matches: 50,
+  duration: 20,               // seconds of play per match
+  mode: 'mix',
+  rate: 30,                   // packets per second per bot (60 fps / NET_SEND_INTERVAL)
+  ramp: 5,                    // ms between starting matches
+  setupTimeout: 10,           // seconds for a match to start
+  json: false                 // machine-readable report
+};
+
+const MODES = ['binary', 'quick', 'room', 'auth'];
+const LOOPBACK = new Set(['127.0.0.1', 'localhost', '[::1]', '::1']);
+
+function parseArgs(argv) {
+  const options = { ...DEFAULTS };
+  for (let i = 0; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg === '--help' || arg === '-h') {
+      console.log('Usage: node tools/loadgen.js [--url ws://127.0.0.1:3001/] [--health url] [--matches N]\n' +
+        '         [--duration s] [--mode binary|quick|room|auth|mix] [--rate hz] [--ramp ms]\n' +
+        '         [--setup-timeout s] [--json]');
+      process.exit(0);
+    }
+    if (!arg.startsWith('--')) throw new Error(`Unexpected argument ${arg}`);
+    const key = arg.slice(2).replace(/-(\w)/g, (_, c) => c.toUpperCase());
+    if (!(key in DEFAULTS)) throw new Error(`Unknown option ${arg}`);
+    if (typeof DEFAULTS[key] === 'boolean') {
+      options[key] = true;
+      continue;
+    }
+    const value = argv[++i];
+    if (value === undefined) throw new Error(`Missing value for ${arg}`);
+    options[key] = typeof DEFAULTS[key] === 'number' ? Number(value) : value;
+  }
+
+  const url = new URL(options.url);
+  if (!LOOPBACK.has(url.hostname)) throw new Error(`Refusing to load ${url.hostname}: localhost only`);
+  if (!options.health) options.health = `http://${url.host}/health`;
+  if (!LOOPBACK.has(new URL(options.health).hostname)) throw new Error('Refusing non-local health url');
+  if (options.mode !== 'mix' && !MODES.includes(options.mode)) throw new Error(`Unknown mode ${options.mode}`);
+  return options;
+}
+
+// ----------------------------------------------------------------------------
+// Metrics
+// ----------------------------------------------------------------------------
+
+// Latency histogram, 0.1 ms buckets up to 10 s (the last one holds the rest)
+class Histogram {
+  constructor() {
+    this.buckets = new Uint32Array(100000);
+    this.count = 0;
+    this.max = 0;
+  }
+
+  add(ms) {
+    const bucket = Math.min(this.buckets.length - 1, Math.max(0, Math.round(ms * 10)));
+    this.buckets[bucket]++;
+    this.count++;
+    if (ms > this.max) this.max = ms;
+  }
+
+  percentile(p) {
+    if (this.count === 0) return null;
+    const target = Math.ceil(this.count * p / 100);
+    let seen = 0;
+    for (let i = 0; i < this.buckets.length; i++) {
+      seen += this.buckets[i];
+      if (seen >= target) return i / 10;
+    }
+    return this.max;
+  }
+
+  summary() {
+    const round = v => v === null ? null : Math.round(v * 10) / 10;
+    return {
+      samples: this.count,
+      p50: round(this.percentile(50)),
+      p90: round(this.percentile(90)),
+      p99: round(this.percentile(99)),
+      p999: round(this.percentile(99.9)),
+      max: round(this.count ? this.max : null)
+    };
+  }
+}
+
+const metrics = {
+  setup: new Histogram(),     // connect -> match started, ms
+  latency: new Histogram(),   // relayed packet, sender -> receiver, ms
+  connected: 0,
+  connectFailed: 0,
+  dropped: 0,                 // closed by the server or the network before the end
+  matchesStarted: 0,
+  matchesFailed: 0,
+  failedByMode: {},
+  packetsSent: 0,
+  packetsReceived: 0,
+  bytesSent: 0,
+  snapshots: 0,
+  errors: new Map()           // message -> count
+};
+
+function countError(message) {
+  metrics.errors.set(message, (metrics.errors.get(message) || 0) + 1);
+}
+
+// ----------------------------------------------------------------------------
+// Bots
+// ----------------------------------------------------------------------------
+
+// Mirrors game/game.h and game/game.c
+const NET_MAGIC = 0x4750;
+const NET_HEADER_SIZE = 8;
+const PACKET_HELLO = 1;
+const PACKET_INPUT = 2;
+const NET_HELLO_INTERVAL = 15;        // frames
+const FRAMES_PER_PACKET = 2;          // NET_SEND_INTERVAL
+
+const TAG_STATE = 0x03;
+const STATE_SIZE = 16;                // [tag][channel][u32 bot][u32 seq][pad]
+const MSG_INPUT = 0x49;
+const MSG_SNAPSHOT = 0x53;
+
+const SEQ_RING = 1024;                // send times kept per bot, by seq
+
+const bots = [];                      // bot id -> Bot (ids travel in packets)
+let stopping = false;
+
+class Bot {
+  constructor(options, mode, match) {
+    this.id = bots.length;
+    bots.push(this);
+    this.options = options;
+    this.mode = mode;
+    this.match = match;
+    this.ws = null;
+    this.openedAt = 0;
+    this.started = false;
+    this.seq = 0;
+    this.sentAt = new Float64Array(SEQ_RING);
+    this.frame = 0;
+    this.remoteSeq = 0;
+    this.peerSeen = false;            // binary: a hello from the opponent arrived
+    this.tick = 0;
+  }
+
+  connect(query = '') {
+    const url = new URL(this.options.url);
+    url.search = query;
+    return new Promise((resolve) => {
+      const ws = this.ws = new WebSocket(url);
+      ws.binaryType = 'nodebuffer';
+      ws.on('open', () => {
+        metrics.connected++;
+        this.openedAt = performance.now();
+        resolve(true);
+      });
+      ws.on('message', (data, isBinary) => this.onMessage(data, isBinary));
+      ws.on('error', (err) => countError(err.message));
+      ws.on('close', () => {
+        if (this.openedAt === 0) {
+          metrics.connectFailed++;
+          resolve(false);
+        } else if (!stopping) {
+          metrics.dropped++;
+        }
+      });
+    });
+  }
+
+  sendJson(msg) {
+    this.ws.send(JSON.stringify(msg));
+  }
+
+  startedNow() {
+    if (this.started) return;
+    this.started = true;
+    metrics.setup.add(performance.now() - this.openedAt);
+    this.match.onBotStarted();
+  }
+
+  nextSeq() {
+    this.seq = (this.seq + 1) & 0xffff;
+    this.sentAt[this.seq % SEQ_RING] = performance.now();
+    return this.seq;
+  }
+
+  received(botId, seq) {
+    metrics.packetsReceived++;
+    const sender = bots[botId];
+    if (!sender) return;
+    // Only trust the ring slot while the sender hasn't wrapped past it
+    if (((sender.seq - seq) & 0xffff) >= SEQ_RING) return;
+    metrics.latency.add(performance.now() - sender.sentAt[seq % SEQ_RING]);
+  }
+
+  send(data) {
+    if (!this.ws || this.ws.readyState !== WebSocket.OPEN) return;
+    this.ws.send(data);
+    metrics.packetsSent++;
+    metrics.bytesSent += data.length;
+  }
+
+  // Scripted play: sweep the paddle up and down, touch now and then
+  buttons() {
+    const phase = (this.frame + this.id * 37) % 120;
+    return phase < 50 ? 0x01 : phase < 100 ? 0x02 : 0;
+  }
+
+  // Called at --rate; one packet's worth of frames
+  step() {
+    if (!this.ws || this.ws.readyState !== WebSocket.OPEN) return;
+    this.frame += FRAMES_PER_PACKET;
+    this.tick++;
+
+    if (this.mode === 'binary') {
+      // Lobby hello until the opponent answers, then input packets
+      if (!this.peerSeen) {
+        if (this.tick % Math.max(1, Math.round(NET_HELLO_INTERVAL / FRAMES_PER_PACKET)) === 1) this.sendPong(PACKET_HELLO);
+      } else {
+        this.sendPong(PACKET_INPUT);
+      }
+      return;
+    }
+    if (!this.started) return;
+
+    if (this.mode === 'auth') {
+      const buf = Buffer.allocUnsafe(4);
+      buf[0] = MSG_INPUT;
+      buf[1] = this.buttons();
+      buf.writeInt16LE(this.frame % 240 === 0 ? (this.frame * 7) % 400 : -1, 2);
+      this.send(buf);
+      return;
+    }
+
+    const buf = Buffer.alloc(STATE_SIZE);
+    buf[0] = TAG_STATE;
+    buf[1] = this.match.bots.indexOf(this);   // channel: our side
+    buf.writeUInt32LE(this.id, 2);
+    buf.writeUInt32LE(this.nextSeq(), 6);
+    buf.writeInt16LE(this.frame % 480, 10);
+    this.send(buf);
+  }
+
+  // A pong packet as game.c writes it; matchId carries our bot id
+  sendPong(type) {
+    const payload = [];
+    const put8 = v => payload.push(v & 0xff);
+    const put16 = v => { put8(v); put8(v >> 8); };
+    const put32 = v => { put16(v & 0xffff); put16(v >>> 16); };
+
+    put32(this.id);
+    put16(0);                           // round
+    if (type === PACKET_HELLO) {
+      put8(1);                          // ready
+    } else {
+      put8(0);                          // advantage
+      put32(this.frame - 3);            // acked remote frame
+      put32(this.frame - FRAMES_PER_PACKET);
+      put8(FRAMES_PER_PACKET);
+      for (let i = 0; i < FRAMES_PER_PACKET; i++) put8(this.buttons());
+    }
+
+    const buf = Buffer.allocUnsafe(NET_HEADER_SIZE + payload.length);
+    buf.writeUInt16LE(NET_MAGIC, 0);
+    buf[2] = type;
+    buf[3] = payload.length;
+    buf.writeUInt16LE(this.nextSeq(), 4);
+    buf.writeUInt16LE(this.remoteSeq, 6);
+    Buffer.from(payload).copy(buf, NET_HEADER_SIZE);
+    this.send(buf);
+  }
+
+  onMessage(data, isBinary) {
+    if (!isBinary) {
+      let msg;
+      try {
+        msg = JSON.parse(data.toString());
+      } catch (e) {
+        return;
+      }
+      if (msg.type === 'game_start') this.startedNow();
+      else if (msg.type === 'room_created') this.match.onRoomCreated(msg.roomId);
+      else if (msg.type === 'error') {
+        countError(msg.message);
+        this.match.fail();
+      }
+      return;
+    }
+
+    if (data.length >= NET_HEADER_SIZE + 4 && data.readUInt16LE(0) === NET_MAGIC) {
+      this.remoteSeq = data.readUInt16LE(4);
+      this.peerSeen = true;
+      this.startedNow();
+      this.received(data.readUInt32LE(NET_HEADER_SIZE), this.remoteSeq);
+    } else if (data[0] === TAG_STATE && data.length >= STATE_SIZE) {
+      this.received(data.readUInt32LE(2), data.readUInt32LE(6));
+    } else if (data[0] === MSG_SNAPSHOT) {
+      metrics.snapshots++;
+    }
+  }
+
+  close() {
+    if (this.ws && this.ws.readyState === WebSocket.OPEN) this.ws.close(1000);
+  }
+}
+
+// Two bots that should end up playing each other (the server decides for
+// queued modes; any two that meet are fine)
+class Match {
+  constructor(options, index, mode) {
+    this.options = options;
+    this.index = index;
+    this.mode = mode;
+    this.bots = [new Bot(options, mode, this), new Bot(options, mode, this)];
+    this.roomId = null;
+    this.done = false;
+  }
+
+  async start() {
+    const [a, b] = this.bots;
+    this.timeout = setTimeout(() => this.fail(), this.options.setupTimeout * 1000);
+
+    switch (this.mode) {
+      case 'binary':
+        // The first frame only triggers auto-match on the server
+        if (await a.connect('match=binary')) a.sendPong(PACKET_HELLO);
+        if (await b.connect('match=binary')) b.sendPong(PACKET_HELLO);
+        break;
+      case 'quick':
+      case 'auth': {
+        const query = this.mode === 'auth' ? 'match=quick-auth' : 'match=quick';
+        const msg = { type: 'quick_match', authoritative: this.mode === 'auth' };
+        if (await a.connect(query)) a.sendJson(msg);
+        if (await b.connect(query)) b.sendJson(msg);
+        break;
+      }
+      case 'room':
+        if (await a.connect()) a.sendJson({ type: 'create', roomId: `loadgen_${process.pid}_${this.index}` });
+        break;
+    }
+  }
+
+  async onRoomCreated(roomId) {
+    this.roomId = roomId;
+    const b = this.bots[1];
+    if (await b.connect('room=' + encodeURIComponent(roomId))) b.sendJson({ type: 'join', roomId });
+  }
+
+  onBotStarted() {
+    if (this.done || !this.bots.every(bot => bot.started)) return;
+    this.done = true;
+    clearTimeout(this.timeout);
+    metrics.matchesStarted++;
+  }
+
+  fail() {
+    if (this.done) return;
+    this.done = true;
+    clearTimeout(this.timeout);
+    metrics.matchesFailed++;
+    metrics.failedByMode[this.mode] = (metrics.failedByMode[this.mode] || 0) + 1;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Server CPU
+// ----------------------------------------------------------------------------
+
+function fetchHealth(url) {
+  return new Promise((resolve) => {
+    http.get(url, (res) => {
+      let body = '';
+      res.on('data', chunk => body += chunk);
+      res.on('end', () => {
+        try {
+          resolve(JSON.parse(body));
+        } catch (e) {
+          resolve(null);
+        }
+      });
+    }).on('error', () => resolve(null));
+  });
+}
+
+// Total CPU microseconds of the backend: the server process plus its game
+// workers, as /health reports them
+function serverCpu(health) {
+  if (!health || !health.cpu) return null;
+  let total = health.cpu.user + health.cpu.system;
+  for (const worker of health.game?.perWorker || []) {
+    if (worker.cpu) total += worker.cpu.user + worker.cpu.system;
+  }
+  return total;
+}
+
+// ----------------------------------------------------------------------------
+// Run
+// ----------------------------------------------------------------------------
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+async function run(options) {
+  const before = await fetchHealth(options.health);
+  const startedAt = performance.now();
+  const ownCpu = process.cpuUsage();
+
+  // One timer drives every bot
+  const ticker = setInterval(() => bots.forEach(bot => bot.step()), 1000 / options.rate);
+
+  const matches = [];
+  for (let i = 0; i < options.matches; i++) {
+    const mode = options.mode === 'mix' ? MODES[i % MODES.length] : options.mode;
+    const match = new Match(options, i, mode);
+    matches.push(match);
+    match.start();
+    if (options.ramp > 0) await sleep(options.ramp);
+  }
+
+  await sleep(options.duration * 1000);
+
+  // Per-worker stats in /health are refreshed every couple of seconds
+  const after = await fetchHealth(options.health);
+  const elapsed = (performance.now() - startedAt) / 1000;
+  const own = process.cpuUsage(ownCpu);
+
+  stopping = true;
+  clearInterval(ticker);
+  matches.forEach(match => match.fail());   // never started
+  matches.forEach(match => match.bots.forEach(bot => bot.close()));
+
+  const cpuBefore = serverCpu(before);
+  const cpuAfter = serverCpu(after);
+  const report = {
+    options,
+    elapsedSec: Math.round(elapsed * 10) / 10,
+    bots: bots.length,
+    connected: metrics.connected,
+    connectFailed: metrics.connectFailed,
+    dropped: metrics.dropped,
+    matchesStarted: metrics.matchesStarted,
+    matchesFailed: metrics.matchesFailed,
+    failedByMode: metrics.failedByMode,
+    setupMs: metrics.setup.summary(),
+    relayLatencyMs: metrics.latency.summary(),
+    packetsSent: metrics.packetsSent,
+    packetsReceived: metrics.packetsReceived,
+    sendRatePerSec: Math.round(metrics.packetsSent / elapsed),
+    bytesSent: metrics.bytesSent,
+    snapshotsReceived: metrics.snapshots,
+    serverCpuPercent: cpuBefore !== null && cpuAfter !== null
+      ? Math.round((cpuAfter - cpuBefore) / (elapsed * 1e6) * 1000) / 10
+      : null,
+    loadgenCpuPercent: Math.round((own.user + own.system) / (elapsed * 1e6) * 1000) / 10,
+    errors: Object.fromEntries(metrics.errors)
+  };
+
+  await sleep(200);
+  return report;
+}
+
+function printReport(r) {
+  const ms = h => h.samples === 0 ? 'n/a'
+    : `p50 ${h.p50}  p90 ${h.p90}  p99 ${h.p99}  p99.9 ${h.p999}  max ${h.max}  (${h.samples} samples)`;
+  console.log(`[LoadGen] ${r.options.matches} matches (${r.options.mode}), ${r.bots} bots, ${r.elapsedSec}s at ${r.options.rate} Hz`);
+  console.log(`  connections   ${r.connected} ok, ${r.connectFailed} failed, ${r.dropped} dropped`);
+  const byMode = Object.entries(r.failedByMode).map(([mode, n]) => `${n} ${mode}`).join(', ');
+  console.log(`  matches       ${r.matchesStarted} started, ${r.matchesFailed} failed${byMode ? ` (${byMode})` : ''}`);
+  console.log(`  setup ms      ${ms(r.setupMs)}`);
+  console.log(`  relay ms      ${ms(r.relayLatencyMs)}`);
+  console.log(`  packets       ${r.packetsSent} sent (${r.sendRatePerSec}/s), ${r.packetsReceived} relayed, ${r.snapshotsReceived} snapshots`);
+  console.log(`  server cpu    ${r.serverCpuPercent === null ? 'n/a (no cpu in /health)' : r.serverCpuPercent + '%'}  (loadgen ${r.loadgenCpuPercent}%)`);
+  for (const [message, count] of Object.entries(r.errors)) console.log(`  error         ${count}x ${message}`);
+}
+
+if (require.main === module) {
+  let options;
+  try {
+    options = parseArgs(process.argv.slice(2));
+  } catch (err) {
+    console.error(`[LoadGen] ${err.message}`);
+    process.exit(2);
+  }
+
+  run(options).then((report) => {
+    if (options.json) console.log(JSON.stringify(report, null, 2));
+    else printReport(report);
+    process.exit(report.dropped > 0 || report.connectFailed > 0 || report.matchesFailed > 0 ? 1 : 0);
+  });
+}
+
+module.exports = { run, parseArgs, Histogram };
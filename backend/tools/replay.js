@@ -0,0 +1,230 @@
+#!/usr/bin/env node
+// Replays a relay log (RELAY_RECORD_DIR, see relay_recorder.js)
+//
+//   node tools/replay.js <file.rlog>                     summary: frames, rates, stalls
+//   node tools/replay.js <file.rlog> --verbose           ... and every record
+//   node tools/replay.js <file.rlog> --to relay [--speed 4] [--url ws://127.0.0.1:3001/]
+//
+// --to relay plays the match back through a local game server with two
+// headless clients standing in for the players: each recorded frame is sent
+// by its original sender at its original time (divided by --speed; 0 sends
+// as fast as possible), and the other client times its arrival. The report
+// gives relay latency percentiles, frames the relay coalesced or lost, and how
+// late the replay itself sent (if that is high, the replay is the bottleneck,
+// not the server). Binary matches re-pair through the binary auto-match
+// queue, so run it against a server nobody else is using.
+
+const fs = require('fs');
+const WebSocket = require('ws');
+const recorder = require('../relay_recorder');
+const { Histogram } = require('./loadgen');
+
+const FROM_EVENT = 0xff;
+const LOOPBACK = new Set(['127.0.0.1', 'localhost', '[::1]', '::1']);
+const STALL_COUNT = 5;          // biggest gaps listed per direction
+const SETTLE_MS = 500;          // after the last frame, for deliveries in flight
+
+function parseArgs(argv) {
+  const options = { file: null, to: 'dump', speed: 1, url: 'ws://127.0.0.1:3001/', verbose: false };
+  for (let i = 0; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg === '--verbose') options.verbose = true;
+    else if (arg === '--to') options.to = argv[++i];
+    else if (arg === '--speed') options.speed = Number(argv[++i]);
+    else if (arg === '--url') options.url = argv[++i];
+    else if (!arg.startsWith('--') && !options.file) options.file = arg;
+    else throw new Error(`Unexpected argument ${arg}`);
+  }
+  if (!options.file) throw new Error('Usage: node tools/replay.js <file.rlog> [--to dump|relay] [--speed N] [--url ws://127.0.0.1:3001/] [--verbose]');
+  if (options.to !== 'dump' && options.to !== 'relay') throw new Error(`Unknown target ${options.to}`);
+  if (!(options.speed >= 0)) throw new Error('--speed must be >= 0');
+  if (!LOOPBACK.has(new URL(options.url).hostname)) throw new Error('Refusing non-local url: localhost only');
+  return options;
+}
+
+const fmt = ms => Math.round(ms * 10) / 10;
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+function printHistogram(label, histogram) {
+  const h = histogram.summary();
+  if (h.samples === 0) console.log(`  ${label}n/a`);
+  else console.log(`  ${label}p50 ${h.p50}  p90 ${h.p90}  p99 ${h.p99}  p99.9 ${h.p999}  max ${h.max}  (${h.samples})`);
+}
+
+// ----------------------------------------------------------------------------
+// Dump
+// ----------------------------------------------------------------------------
+
+function dump(log, options) {
+  const { records } = log;
+  const start = records.find(r => r.event && r.event.event === 'start')?.event || {};
+  const duration = records.length ? records[records.length - 1].t : 0;
+  console.log(`[Replay] ${options.file}`);
+  console.log(`  room ${start.roomId} (${start.kind}), started ${new Date(log.startedAt).toISOString()}, ${fmt(duration / 1000)}s, ${records.length} records`);
+
+  for (const from of [0, 1]) {
+    const frames = records.filter(r => r.from === from);
+    const gaps = new Histogram();
+    const stalls = [];
+    let bytes = 0;
+    for (let i = 0; i < frames.length; i++) {
+      bytes += frames[i].data.length;
+      if (i === 0) continue;
+      const gap = frames[i].t - frames[i - 1].t;
+      gaps.add(gap);
+      stalls.push({ t: frames[i - 1].t, gap });
+    }
+    stalls.sort((a, b) => b.gap - a.gap);
+
+    const rate = duration > 0 ? Math.round(frames.length / (duration / 1000)) : 0;
+    console.log(`  player ${from} -> ${1 - from}: ${frames.length} frames, ${bytes} bytes, ${rate}/s`);
+    printHistogram('  gap ms  ', gaps);
+    if (stalls.length) console.log(`    stalls  ${stalls.slice(0, STALL_COUNT).map(s => `${fmt(s.gap)} ms at ${fmt(s.t / 1000)}s`).join(', ')}`);
+  }
+
+  for (const r of records) {
+    if (r.event) console.log(`  ${fmt(r.t).toString().padStart(10)} ms  event ${JSON.stringify(r.event)}`);
+    else if (options.verbose) {
+      const kind = r.binary ? 'bin ' : 'text';
+      console.log(`  ${fmt(r.t).toString().padStart(10)} ms  ${r.from} -> ${1 - r.from}  ${kind} ${String(r.data.length).padStart(5)}  ${r.data.subarray(0, 16).toString('hex')}`);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Relay
+// ----------------------------------------------------------------------------
+
+function connect(url, query) {
+  const target = new URL(url);
+  target.search = query;
+  return new Promise((resolve, reject) => {
+    const ws = new WebSocket(target);
+    ws.once('open', () => resolve(ws));
+    ws.once('error', reject);
+  });
+}
+
+function waitFor(ws, type) {
+  return new Promise((resolve, reject) => {
+    const onMessage = (data, isBinary) => {
+      if (isBinary) return;
+      let msg;
+      try {
+        msg = JSON.parse(data.toString());
+      } catch (e) {
+        return;
+      }
+      if (msg.type === 'error') reject(new Error(msg.message));
+      if (msg.type !== type) return;
+      ws.off('message', onMessage);
+      resolve(msg);
+    };
+    ws.on('message', onMessage);
+  });
+}
+
+// Two clients in one match, the way the recorded players got there
+async function pair(options, kind) {
+  if (kind === 'binary') {
+    // The first frame of a binary client only enters it into auto-match
+    const a = await connect(options.url, 'match=binary');
+    a.send(Buffer.from([0]));
+    await sleep(100);
+    const b = await connect(options.url, 'match=binary');
+    b.send(Buffer.from([0]));
+    await sleep(100);
+    return [a, b];
+  }
+
+  const a = await connect(options.url, '');
+  const started = [waitFor(a, 'game_start')];
+  a.send(JSON.stringify({ type: 'create', roomId: `replay_${process.pid}_${Date.now()}` }));
+  const { roomId } = await waitFor(a, 'room_created');
+  const b = await connect(options.url, 'room=' + encodeURIComponent(roomId));
+  started.push(waitFor(b, 'game_start'));
+  b.send(JSON.stringify({ type: 'join', roomId }));
+  await Promise.all(started);
+  return [a, b];
+}
+
+async function replay(log, options) {
+  const frames = log.records.filter(r => r.from !== FROM_EVENT);
+  const start = log.records.find(r => r.event && r.event.event === 'start')?.event || {};
+  const kind = start.kind || 'json';
+  const clients = await pair(options, kind);
+
+  const latency = new Histogram();
+  const lateness = new Histogram();   // replay's own scheduling delay
+  const inFlight = [[], []];          // per receiver: [{ data, at }] in send order
+  let delivered = 0;
+  let coalesced = 0;
+  let unmatched = 0;
+
+  clients.forEach((ws, receiver) => {
+    ws.on('message', (data) => {
+      const now = performance.now();
+      const queue = inFlight[receiver];
+      const index = queue.findIndex(entry => entry.data.equals(data));
+      if (index < 0) {
+        unmatched++;
+        return;
+      }
+      // Anything queued before it was superseded in the relay (latest-wins)
+      coalesced += index;
+      latency.add(now - queue[index].at);
+      queue.splice(0, index + 1);
+      delivered++;
+    });
+  });
+
+  console.log(`[Replay] ${frames.length} frames (${kind}) through ${options.url} at ${options.speed === 0 ? 'max' : options.speed + 'x'} speed`);
+  const began = performance.now();
+  for (let i = 0; i < frames.length; i++) {
+    const r = frames[i];
+    if (options.speed > 0) {
+      const due = began + r.t / options.speed;
+      const wait = due - performance.now();
+      if (wait > 1) await sleep(wait);
+      lateness.add(Math.max(0, performance.now() - due));
+    } else if (i % 256 === 0) {
+      await new Promise(resolve => setImmediate(resolve));   // let deliveries in
+    }
+
+    const sender = clients[r.from];
+    if (sender.readyState !== WebSocket.OPEN) break;
+    inFlight[1 - r.from].push({ data: r.data, at: performance.now() });
+    sender.send(r.data, { binary: r.binary });
+  }
+  const elapsed = performance.now() - began;
+  await sleep(SETTLE_MS);
+
+  const recorded = frames.length ? frames[frames.length - 1].t - frames[0].t : 0;
+  console.log(`  replayed      ${fmt(elapsed / 1000)}s (recorded ${fmt(recorded / 1000)}s)`);
+  console.log(`  frames        ${delivered} delivered, ${coalesced} coalesced, ${inFlight[0].length + inFlight[1].length} lost, ${unmatched} unexpected`);
+  printHistogram('relay ms      ', latency);
+  if (options.speed > 0) printHistogram('send late ms  ', lateness);
+
+  clients.forEach(ws => ws.close(1000));
+}
+
+if (require.main === module) {
+  let options;
+  let log;
+  try {
+    options = parseArgs(process.argv.slice(2));
+    log = recorder.readLog(fs.readFileSync(options.file));
+  } catch (err) {
+    console.error(`[Replay] ${err.message}`);
+    process.exit(2);
+  }
+
+  if (options.to === 'dump') {
+    dump(log, options);
+  } else {
+    replay(log, options).then(() => process.exit(0), (err) => {
+      console.error(`[Replay] ${err.message}`);
+      process.exit(1);
+    });
+  }
+}
@@ -5,6 +5,7 @@ const fs = require('fs');
 const path = require('path');
 const os = require('os');
 const queue = require('./queue');
+const { resolveBuild } = require('./build_flags');
 
 // Use tmpfs (RAM disk) for all builds - fast and ephemeral
 const BUILDS_DIR = path.join(os.tmpdir(), 'builds');
@@ -14,34 +15,6 @@ if (!fs.existsSync(BUILDS_DIR)) {
     fs.mkdirSync(BUILDS_DIR, { recursive: true });
 }
 
-// Default emcc flags for simple builds
-const DEFAULT_FLAGS = [
-    '-sUSE_SDL=2',
-    '-sALLOW_MEMORY_GROWTH=1',
-    '-sEXPORTED_RUNTIME_METHODS=[cwrap,addFunction,wasmMemory,wasmTable]',
-    '-sWASM_BIGINT',
-    '-O0',
-];
-
-// Default flags for live-coding MAIN module
-const MAIN_MODULE_FLAGS = [
-    '-sUSE_SDL=2',
-    '-sMAIN_MODULE=1',
-    '-sEXPORT_ALL=1',
-    '-sFORCE_FILESYSTEM=1',
-    '-sALLOW_MEMORY_GROWTH=1',
-    '-sEXPORTED_RUNTIME_METHODS=[cwrap,addFunction,wasmMemory,wasmTable]',
-    '-sWASM_BIGINT',
-    '-O0',
-];
-
-// Default flags for live-coding GAME module (side module)
-const GAME_MODULE_FLAGS = [
-    '-sUSE_SDL=2',
-    '-sSIDE_MODULE=2',
-    '-O0',
-];
-
 /**
  * Individual worker that processes a single job at a time
  */
@@ -93,38 +66,7 @@ class Worker {
             const writeTime = Date.now() - writeStart;
 
             // Determine build flags
-            let flags;
-            let outputFile;
-
-            if (job.buildProfile && job.buildProfile.args) {
-                flags = job.buildProfile.args.filter(arg =>
-                    arg !== job.entry && !arg.match(/^[a-zA-Z_][a-zA-Z0-9_]*\.(c|cpp|h|hpp)$/)
-                );
-
-                const oIndex = flags.indexOf('-o');
-                if (oIndex !== -1 && flags[oIndex + 1]) {
-                    outputFile = flags[oIndex + 1];
-                    flags.splice(oIndex, 2);
-                } else {
-                    outputFile = 'index.js';
-                }
-            } else {
-                const isGameModule = job.entry && (
-                    job.entry.includes('game/game.c') ||
-                    job.entry.includes('game.wasm')
-                );
-
-                if (isGameModule) {
-                    flags = [...GAME_MODULE_FLAGS];
-                    outputFile = 'game.wasm';
-                } else if (job.files.some(f => f.path.includes('game/'))) {
-                    flags = [...MAIN_MODULE_FLAGS];
-                    outputFile = 'index.js';
-                } else {
-                    flags = [...DEFAULT_FLAGS];
-                    outputFile = 'index.js';
-                }
-            }
+            const { flags, outputFile } = resolveBuild(job);
 
             // Build the emcc command
             const entry = job.entry || 'main.c';
@@ -336,6 +278,7 @@ class WorkerPool extends EventEmitter {
         this.poolSize = parseInt(process.env.MAX_WORKERS) || options.poolSize || defaultWorkers;
         this.running = false;
         this.onBuildComplete = null;
+        this.laneTimer = null;      // re-dispatch when the quick lane opens
     }
 
     start() {
@@ -346,6 +289,7 @@ class WorkerPool extends EventEmitter {
         for (let i = 0; i < this.poolSize; i++) {
             this.workers.push(new Worker(i, this));
         }
+        queue.workerCount = this.poolSize;
 
         // Listen for new jobs
         queue.on('job:added', () => this.dispatch());
@@ -358,24 +302,41 @@ class WorkerPool extends EventEmitter {
 
     stop() {
         this.running = false;
+        clearTimeout(this.laneTimer);
+        this.laneTimer = null;
         console.log('[WorkerPool] Stopped');
     }
 
     /**
-     * Dispatch pending jobs to available workers
+     * Dispatch pending jobs to available workers. The last free worker only
+     * takes quick jobs, so a side module never waits behind MAIN_MODULE links
+     * (see the quick lane in queue.js). If that leaves long jobs waiting, a
+     * timer dispatches again when the lane opens to them.
      */
     dispatch() {
         if (!this.running) return;
 
+        let idle = this.workers.filter(w => !w.busy).length;
         for (const worker of this.workers) {
             if (!worker.busy && queue.hasPending()) {
-                const job = queue.dequeue();
+                const job = queue.dequeue({ shortOnly: idle === 1 && queue.quickLaneReserved });
                 if (job) {
                     // Process job
+                    idle--;
                     worker.processJob(job);
                 }
             }
         }
+
+        clearTimeout(this.laneTimer);
+        this.laneTimer = null;
+        const opensAt = idle > 0 && queue.hasPending() ? queue.quickLaneOpensAt() : null;
+        if (opensAt !== null && opensAt > Date.now()) {
+            this.laneTimer = setTimeout(() => {
+                this.laneTimer = null;
+                this.dispatch();
+            }, Math.max(0, opensAt - Date.now()));
+        }
     }
 
     /**
@@ -2,6 +2,14 @@ import React, { useEffect, useRef, useState, useCallback } from "react";
 import { usePlaygroundStore } from "@/store/playgroundStore";
 import { Play, Square, Loader2, Plus } from "lucide-react";
 import { Button } from "@/components/ui/button";
+import { getGameState, saveGameState, deleteGameState } from "@/lib/storage/indexedDB";
+
+// Session persistence: the game serializes its context, timeline and loop
+// recorder (js_save_state) before the preview is torn down, the editor keeps
+// it in IndexedDB per project and the next preview restores it. Autosave
+// covers editor page reloads, where the teardown can't wait for a reply.
+const SAVE_STATE_TIMEOUT_MS = 1000;
+const AUTOSAVE_INTERVAL_MS = 15000;
 
 interface GamePreviewProps {
   onAddPreview?: () => void; // Custom add preview handler (for mobile)
@@ -21,7 +29,9 @@ const GamePreview: React.FC<GamePreviewProps> = ({ onAddPreview }) => {
     buildPhase,
     submitBuild,
     addConsoleMessage,
+    currentProject,
   } = usePlaygroundStore();
+  const projectId = currentProject?.id;
 
   const [isRunning, setIsRunning] = useState(false);
   const [previewUrl, setPreviewUrl] = useState<string | null>(null);
@@ -31,6 +41,42 @@ const GamePreview: React.FC<GamePreviewProps> = ({ onAddPreview }) => {
   const iframeRef = useRef<HTMLIFrameElement>(null);
   const containerRef = useRef<HTMLDivElement>(null);
   const hotReloadTimeoutRef = useRef<NodeJS.Timeout | null>(null);
+  const saveRequestsRef = useRef(new Map<number, (bytes: ArrayBuffer | null) => void>());
+  const nextSaveIdRef = useRef(1);
+
+  // Ask the running game for its session; null if it doesn't answer in time
+  // (non live-coding template, game not started yet) or, for autosaves, if
+  // nothing moved since the last one
+  const requestGameState = useCallback((autosave: boolean): Promise<ArrayBuffer | null> => {
+    const target = iframeRef.current?.contentWindow;
+    if (!target) return Promise.resolve(null);
+
+    const requestId = nextSaveIdRef.current++;
+    return new Promise((resolve) => {
+      const timer = setTimeout(() => {
+        saveRequestsRef.current.delete(requestId);
+        resolve(null);
+      }, SAVE_STATE_TIMEOUT_MS);
+
+      saveRequestsRef.current.set(requestId, (bytes) => {
+        clearTimeout(timer);
+        saveRequestsRef.current.delete(requestId);
+        resolve(bytes);
+      });
+      target.postMessage({ type: "timeline-command", command: "save-state", data: { requestId, autosave } }, "*");
+    });
+  }, []);
+
+  const persistGameState = useCallback(async (autosave = false) => {
+    if (!projectId || !isLiveCodingProject) return;
+    const bytes = await requestGameState(autosave);
+    if (!bytes) return;
+    try {
+      await saveGameState(projectId, bytes);
+    } catch (e) {
+      console.warn("[GamePreview] Failed to store session:", e);
+    }
+  }, [projectId, isLiveCodingProject, requestGameState]);
 
   // Load preview when we have a URL (initial load or full build)
   useEffect(() => {
@@ -48,12 +94,31 @@ const GamePreview: React.FC<GamePreviewProps> = ({ onAddPreview }) => {
 
     if (newPath !== currentPath) {
       if (isRunning) {
-        // Refresh if already running and path changed (new build ID)
+        // Refresh if already running and path changed (new build ID);
+        // the old instance saves its session first
         const urlWithTimestamp = `${lastPreviewUrl}${lastPreviewUrl.includes('?') ? '&' : '?'}_t=${Date.now()}`;
-        setPreviewUrl(urlWithTimestamp);
+        persistGameState().finally(() => setPreviewUrl(urlWithTimestamp));
       }
     }
-  }, [lastPreviewUrl, pendingHotReload, clearPendingHotReload, isRunning, previewUrl]);
+  }, [lastPreviewUrl, pendingHotReload, clearPendingHotReload, isRunning, previewUrl, persistGameState]);
+
+  // Autosave while running and visible
+  useEffect(() => {
+    if (!isRunning || !isLiveCodingProject) return;
+
+    const timer = setInterval(() => {
+      if (document.visibilityState === "visible") persistGameState(true);
+    }, AUTOSAVE_INTERVAL_MS);
+    const handleVisibility = () => {
+      if (document.visibilityState === "hidden") persistGameState(true);
+    };
+
+    document.addEventListener("visibilitychange", handleVisibility);
+    return () => {
+      clearInterval(timer);
+      document.removeEventListener("visibilitychange", handleVisibility);
+    };
+  }, [isRunning, isLiveCodingProject, persistGameState]);
 
   // Forward hot-reload trigger to iframe via postMessage
   useEffect(() => {
@@ -97,6 +162,31 @@ const GamePreview: React.FC<GamePreviewProps> = ({ onAddPreview }) => {
         case "preview-ready":
           setError(null);
           setIsHotReloading(false);
+          // Hand the previous session to the new instance
+          if (projectId && event.source === iframeRef.current?.contentWindow) {
+            const source = event.source as Window;
+            getGameState(projectId)
+              .then((saved) => {
+                if (saved) source.postMessage({ type: "timeline-command", command: "restore-state", data: { bytes: saved.bytes } }, "*");
+              })
+              .catch((e) => console.warn("[GamePreview] Failed to read session:", e));
+          }
+          break;
+
+        case "game-state": {
+          const resolve = saveRequestsRef.current.get(event.data.requestId);
+          resolve?.(event.data.bytes instanceof ArrayBuffer ? event.data.bytes : null);
+          break;
+        }
+
+        case "game-state-restored":
+          if (event.data.ok) {
+            addConsoleMessage("info", "Restored the previous game session");
+          } else if (projectId) {
+            // Incompatible build: don't offer it again
+            deleteGameState(projectId).catch(() => { });
+            addConsoleMessage("warning", "Previous game session doesn't match this build, starting fresh");
+          }
           break;
 
         case "hot-reload-success":
@@ -121,7 +211,7 @@ const GamePreview: React.FC<GamePreviewProps> = ({ onAddPreview }) => {
 
     window.addEventListener("message", handleMessage);
     return () => window.removeEventListener("message", handleMessage);
-  }, [addConsoleMessage]);
+  }, [addConsoleMessage, projectId]);
 
   // Keyboard shortcuts
   useEffect(() => {
@@ -180,10 +270,12 @@ const GamePreview: React.FC<GamePreviewProps> = ({ onAddPreview }) => {
   }, [lastPreviewUrl, isBuilding, submitBuild]);
 
   const handleStop = useCallback(() => {
-    setIsRunning(false);
-    setPreviewUrl(null);
-    setError(null);
-  }, []);
+    persistGameState().finally(() => {
+      setIsRunning(false);
+      setPreviewUrl(null);
+      setError(null);
+    });
+  }, [persistGameState]);
 
   return (
     <div className="flex flex-col h-full bg-background" ref={containerRef}>
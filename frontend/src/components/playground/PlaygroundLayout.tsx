@@ -7,6 +7,7 @@ import Console from './Console';
 import GamePreview from './GamePreview';
 import ExcalidrawPanel from './ExcalidrawPanel';
 import TimelineEditor from './TimelineEditor';
+import ProfilerPanel from './ProfilerPanel';
 import Toolbar from './Toolbar';
 import MobilePlayground from './MobilePlayground';
 import { usePlaygroundStore } from '@/store/playgroundStore';
@@ -91,6 +92,12 @@ const defaultLayout: any = {
                 component: 'timeline',
                 enableClose: false,
               },
+              {
+                type: 'tab',
+                name: 'Profiler',
+                component: 'profiler',
+                enableClose: false,
+              },
               {
                 type: 'tab',
                 name: 'Drawing',
@@ -165,6 +172,8 @@ const PlaygroundLayout: React.FC = () => {
         return <ExcalidrawPanel />;
       case 'timeline':
         return <TimelineEditor />;
+      case 'profiler':
+        return <ProfilerPanel />;
       default:
         return <div className="p-4 text-muted-foreground">Unknown panel: {component}</div>;
     }
@@ -0,0 +1,252 @@
+import React, { useState, useEffect, useCallback, useRef } from 'react';
+import { Circle, Square, Radio } from 'lucide-react';
+import { cn } from '@/lib/utils';
+
+// One frame of zones from the game's profiler.h ring
+interface ProfZone {
+  name: number;
+  depth: number;
+  startUs: number;
+  durationUs: number;
+}
+
+interface ProfFrame {
+  frame: number;
+  totalUs: number;
+  dropped: number;
+  zones: ProfZone[];
+}
+
+// Frames kept in the panel (the game-side ring is 128)
+const MAX_FRAMES = 240;
+const FRAME_BUDGET_US = 16667;
+const ROW_HEIGHT = 18;
+const STRIP_HEIGHT = 48;
+
+// Layout written by prof_collect(): [frame, total_us, zone_count, dropped]
+// then zone_count x [name_id, depth, start_us, duration_us]
+function parseFrames(data: Float32Array): ProfFrame[] {
+  const frames: ProfFrame[] = [];
+  let i = 0;
+  while (i + 4 <= data.length) {
+    const zoneCount = data[i + 2];
+    const frame: ProfFrame = { frame: data[i], totalUs: data[i + 1], dropped: data[i + 3], zones: [] };
+    i += 4;
+    for (let z = 0; z < zoneCount && i + 4 <= data.length; z++, i += 4) {
+      frame.zones.push({ name: data[i], depth: data[i + 1], startUs: data[i + 2], durationUs: data[i + 3] });
+    }
+    frames.push(frame);
+  }
+  return frames;
+}
+
+// Stable colour per zone name
+function zoneColor(name: string): string {
+  let h = 0;
+  for (let i = 0; i < name.length; i++) h = (h * 31 + name.charCodeAt(i)) | 0;
+  return `hsl(${Math.abs(h) % 360}, 55%, 45%)`;
+}
+
+const formatMs = (us: number) => `${(us / 1000).toFixed(2)} ms`;
+
+const ProfilerPanel: React.FC<{ className?: string }> = ({ className }) => {
+  const [isRecording, setIsRecording] = useState(true);
+  const [frames, setFrames] = useState<ProfFrame[]>([]);
+  const [names, setNames] = useState<string[]>([]);
+  const [selectedFrame, setSelectedFrame] = useState<number | null>(null); // null: follow latest
+  const [hovered, setHovered] = useState<ProfZone | null>(null);
+
+  const stripRef = useRef<HTMLCanvasElement>(null);
+  const chartRef = useRef<HTMLCanvasElement>(null);
+  const containerRef = useRef<HTMLDivElement>(null);
+  const [width, setWidth] = useState(600);
+  const isRecordingRef = useRef(isRecording);
+
+  useEffect(() => {
+    isRecordingRef.current = isRecording;
+  }, [isRecording]);
+
+  const sendCommand = useCallback((command: string, data?: any) => {
+    const iframe = document.querySelector('iframe[title="Game Preview"]') as HTMLIFrameElement | null;
+    iframe?.contentWindow?.postMessage({ type: 'timeline-command', command, data }, '*');
+  }, []);
+
+  // The game only times zones while a panel asks for them
+  useEffect(() => {
+    sendCommand('profiler-enable', { enabled: isRecording });
+  }, [isRecording, sendCommand]);
+
+  useEffect(() => {
+    return () => sendCommand('profiler-enable', { enabled: false });
+  }, [sendCommand]);
+
+  useEffect(() => {
+    const handleMessage = (event: MessageEvent) => {
+      if (!event.data || typeof event.data !== 'object') return;
+
+      if (event.data.type === 'timeline-bridge-ready') {
+        // Preview reloaded: the new page starts with the profiler off
+        setFrames([]);
+        sendCommand('profiler-enable', { enabled: isRecordingRef.current });
+      } else if (event.data.type === 'profiler-frames' && event.data.data instanceof ArrayBuffer) {
+        const incoming = parseFrames(new Float32Array(event.data.data));
+        setNames(event.data.names ?? []);
+        setFrames(prev => {
+          // A restarted game counts from 0 again
+          const base = incoming.length && prev.length && incoming[0].frame <= prev[prev.length - 1].frame ? [] : prev;
+          return [...base, ...incoming].slice(-MAX_FRAMES);
+        });
+      }
+    };
+
+    window.addEventListener('message', handleMessage);
+    return () => window.removeEventListener('message', handleMessage);
+  }, [sendCommand]);
+
+  useEffect(() => {
+    if (!containerRef.current) return;
+    const observer = new ResizeObserver(entries => {
+      setWidth(Math.max(200, Math.floor(entries[0].contentRect.width)));
+    });
+    observer.observe(containerRef.current);
+    return () => observer.disconnect();
+  }, []);
+
+  const current = selectedFrame === null
+    ? frames[frames.length - 1]
+    : frames.find(f => f.frame === selectedFrame);
+  const maxDepth = current ? current.zones.reduce((d, z) => Math.max(d, z.depth), 0) + 1 : 1;
+  const chartScaleUs = current ? Math.max(FRAME_BUDGET_US, current.totalUs) : FRAME_BUDGET_US;
+
+  // Frame strip: one bar per frame, 16.7 ms at mid height
+  useEffect(() => {
+    const canvas = stripRef.current;
+    const ctx = canvas?.getContext('2d');
+    if (!canvas || !ctx) return;
+
+    ctx.clearRect(0, 0, canvas.width, canvas.height);
+    const barW = canvas.width / MAX_FRAMES;
+    const scale = (STRIP_HEIGHT / 2) / FRAME_BUDGET_US;
+
+    frames.forEach((f, i) => {
+      const h = Math.min(STRIP_HEIGHT, Math.max(1, f.totalUs * scale));
+      const over = f.totalUs > FRAME_BUDGET_US;
+      ctx.fillStyle = f === current ? '#f8fafc' : over ? '#ef4444' : '#22c55e';
+      ctx.fillRect(i * barW, STRIP_HEIGHT - h, Math.max(1, barW - 1), h);
+    });
+
+    ctx.fillStyle = 'rgba(148, 163, 184, 0.6)';
+    ctx.fillRect(0, STRIP_HEIGHT / 2, canvas.width, 1);
+  }, [frames, current, width]);
+
+  // Flame chart of the selected frame: x = time, y = nesting depth
+  useEffect(() => {
+    const canvas = chartRef.current;
+    const ctx = canvas?.getContext('2d');
+    if (!canvas || !ctx) return;
+
+    ctx.clearRect(0, 0, canvas.width, canvas.height);
+    if (!current) return;
+
+    const pxPerUs = canvas.width / chartScaleUs;
+    ctx.font = '11px monospace';
+    ctx.textBaseline = 'middle';
+
+    for (const z of current.zones) {
+      const name = names[z.name] ?? `zone ${z.name}`;
+      const x = z.startUs * pxPerUs;
+      const w = Math.max(1, z.durationUs * pxPerUs);
+      const y = z.depth * ROW_HEIGHT;
+
+      ctx.fillStyle = zoneColor(name);
+      ctx.fillRect(x, y, w - 1, ROW_HEIGHT - 1);
+
+      const label = `${name} ${formatMs(z.durationUs)}`;
+      if (w > 40) {
+        ctx.save();
+        ctx.beginPath();
+        ctx.rect(x, y, w - 1, ROW_HEIGHT - 1);
+        ctx.clip();
+        ctx.fillStyle = '#f8fafc';
+        ctx.fillText(label, x + 4, y + ROW_HEIGHT / 2);
+        ctx.restore();
+      }
+    }
+
+    // frame budget marker
+    const budgetX = FRAME_BUDGET_US * pxPerUs;
+    ctx.fillStyle = 'rgba(239, 68, 68, 0.8)';
+    ctx.fillRect(budgetX, 0, 1, canvas.height);
+  }, [current, names, chartScaleUs, width, maxDepth]);
+
+  const frameAtStrip = useCallback((clientX: number) => {
+    const rect = stripRef.current?.getBoundingClientRect();
+    if (!rect) return;
+    const index = Math.floor(((clientX - rect.left) / rect.width) * MAX_FRAMES);
+    const f = frames[index];
+    if (f) setSelectedFrame(f.frame);
+  }, [frames]);
+
+  const zoneAtChart = useCallback((clientX: number, clientY: number) => {
+    const rect = chartRef.current?.getBoundingClientRect();
+    if (!rect || !current) return null;
+    const us = ((clientX - rect.left) / rect.width) * chartScaleUs;
+    const depth = Math.floor((clientY - rect.top) / ROW_HEIGHT);
+    return current.zones.find(z => z.depth === depth && us >= z.startUs && us <= z.startUs + z.durationUs) ?? null;
+  }, [current, chartScaleUs]);
+
+  const hoveredName = hovered ? names[hovered.name] ?? `zone ${hovered.name}` : null;
+
+  return (
+    <div className={cn('h-full flex flex-col bg-background text-foreground text-xs', className)}>
+      <div className="flex items-center gap-2 px-2 py-1 border-b border-border">
+        <button
+          className={cn('flex items-center gap-1 px-2 py-0.5 rounded hover:bg-muted', isRecording && 'text-destructive')}
+          onClick={() => setIsRecording(r => !r)}
+          title={isRecording ? 'Stop profiling' : 'Start profiling'}
+        >
+          {isRecording ? <Square size={12} /> : <Circle size={12} />}
+          {isRecording ? 'Stop' : 'Record'}
+        </button>
+        <button
+          className={cn('flex items-center gap-1 px-2 py-0.5 rounded hover:bg-muted', selectedFrame === null && 'text-primary')}
+          onClick={() => setSelectedFrame(null)}
+          title="Follow the latest frame"
+        >
+          <Radio size={12} />
+          Latest
+        </button>
+        <span className="text-muted-foreground">
+          {current
+            ? `frame ${current.frame} · ${formatMs(current.totalUs)}${current.dropped ? ` · ${current.dropped} zones dropped` : ''}`
+            : 'No profiler data (live-coding template, debug_game or simd_game build)'}
+        </span>
+        {hoveredName && hovered && (
+          <span className="ml-auto font-mono">
+            {hoveredName}: {formatMs(hovered.durationUs)} @ {formatMs(hovered.startUs)}
+          </span>
+        )}
+      </div>
+
+      <div ref={containerRef} className="flex-1 overflow-auto p-2 space-y-2">
+        <canvas
+          ref={stripRef}
+          width={width}
+          height={STRIP_HEIGHT}
+          className="block cursor-pointer"
+          onClick={(e) => frameAtStrip(e.clientX)}
+        />
+        <canvas
+          ref={chartRef}
+          width={width}
+          height={Math.max(ROW_HEIGHT, maxDepth * ROW_HEIGHT)}
+          className="block"
+          onMouseMove={(e) => setHovered(zoneAtChart(e.clientX, e.clientY))}
+          onMouseLeave={() => setHovered(null)}
+        />
+      </div>
+    </div>
+  );
+};
+
+export default ProfilerPanel;
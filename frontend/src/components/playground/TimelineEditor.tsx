@@ -1,5 +1,7 @@
 import React, { useState, useEffect, useCallback, useRef } from 'react';
-import { Play, Pause, SkipBack, SkipForward, ChevronsLeft, ChevronsRight, Circle, Square, Scissors } from 'lucide-react';
+import { Play, Pause, SkipBack, SkipForward, ChevronsLeft, ChevronsRight, Circle, Square, Scissors, Upload, Download, FastForward } from 'lucide-react';
+import { usePlaygroundStore } from '@/store/playgroundStore';
+import { uploadRecording, downloadRecording } from '@/lib/api';
 import './TimelineEditor.css';
 
 interface TimelineState {
@@ -10,8 +12,13 @@ interface TimelineState {
     isReplaying: boolean;
     isPaused: boolean;
     simSpeed: number;
+    turboSteps: number;
+    memoryUsed: number;
 }
 
+// Live sim steps per displayed frame while fast-forwarding (~1 minute of play per second)
+const TURBO_STEPS = 64;
+
 const TimelineEditor: React.FC<{ className?: string }> = ({ className }) => {
     // State from C/WASM
     const [state, setState] = useState<TimelineState>({
@@ -22,6 +29,8 @@ const TimelineEditor: React.FC<{ className?: string }> = ({ className }) => {
         isReplaying: false,
         isPaused: false,
         simSpeed: 1,
+        turboSteps: 0,
+        memoryUsed: 0,
     });
 
     // UI state
@@ -31,6 +40,9 @@ const TimelineEditor: React.FC<{ className?: string }> = ({ className }) => {
     const [isTrimming, setIsTrimming] = useState(false);
     const [trimEndFrame, setTrimEndFrame] = useState(0);
     const [hoverFrame, setHoverFrame] = useState<number | null>(null);
+    const [isTransferring, setIsTransferring] = useState(false);
+
+    const addConsoleMessage = usePlaygroundStore((s) => s.addConsoleMessage);
 
     const trackRef = useRef<HTMLDivElement>(null);
     const lastStateTime = useRef<number>(0);
@@ -79,6 +91,8 @@ const TimelineEditor: React.FC<{ className?: string }> = ({ className }) => {
                         isReplaying: event.data.isReplaying ?? false,
                         isPaused: event.data.isPaused ?? false,
                         simSpeed: event.data.simSpeed ?? 1,
+                        turboSteps: event.data.turboSteps ?? 0,
+                        memoryUsed: event.data.memoryUsed ?? 0,
                     });
                 } else {
                     // While dragging, only update non-frame state
@@ -90,17 +104,40 @@ const TimelineEditor: React.FC<{ className?: string }> = ({ className }) => {
                         isReplaying: event.data.isReplaying ?? prev.isReplaying,
                         isPaused: event.data.isPaused ?? prev.isPaused,
                         simSpeed: event.data.simSpeed ?? prev.simSpeed,
+                        turboSteps: event.data.turboSteps ?? prev.turboSteps,
+                        memoryUsed: event.data.memoryUsed ?? prev.memoryUsed,
                     }));
                 }
             } else if (event.data.type === 'timeline-bridge-ready') {
                 setIsConnected(true);
                 sendCommand('get-state');
+            } else if (event.data.type === 'timeline-recording') {
+                if (!(event.data.bytes instanceof ArrayBuffer)) {
+                    setIsTransferring(false);
+                    addConsoleMessage('error', `Export failed: ${event.data.error || 'no data'}`);
+                    return;
+                }
+                uploadRecording(event.data.bytes)
+                    .then((result) => {
+                        navigator.clipboard?.writeText(result.recordingId).catch(() => { });
+                        addConsoleMessage('success',
+                            `Recording saved (frames ${result.startFrame}-${result.endFrame}, ${Math.round(result.size / 1024)} KB): ${result.recordingId}`);
+                    })
+                    .catch((err: Error) => addConsoleMessage('error', `Recording upload failed: ${err.message}`))
+                    .finally(() => setIsTransferring(false));
+            } else if (event.data.type === 'timeline-import-result') {
+                setIsTransferring(false);
+                if (event.data.ok) {
+                    addConsoleMessage('success', 'Recording loaded');
+                } else {
+                    addConsoleMessage('error', 'Recording is not compatible with this build');
+                }
             }
         };
 
         window.addEventListener('message', handleMessage);
         return () => window.removeEventListener('message', handleMessage);
-    }, [sendCommand]);
+    }, [sendCommand, addConsoleMessage]);
 
     // Connection timeout check
     useEffect(() => {
@@ -182,6 +219,35 @@ const TimelineEditor: React.FC<{ className?: string }> = ({ className }) => {
         }
     }, [sendCommand, state.isRecording]);
 
+    // Recording share / load (stored by the backend, addressed by id)
+    const toggleTurbo = useCallback(() => {
+        sendCommand('set-turbo', { steps: state.turboSteps > 1 ? 0 : TURBO_STEPS });
+    }, [sendCommand, state.turboSteps]);
+
+    const shareRecording = useCallback(() => {
+        if (isTransferring) return;
+        setIsTransferring(true);
+        sendCommand('export-recording');
+    }, [isTransferring, sendCommand]);
+
+    const loadRecording = useCallback(async () => {
+        if (isTransferring) return;
+        const recordingId = window.prompt('Recording id')?.trim();
+        if (!recordingId) return;
+
+        setIsTransferring(true);
+        try {
+            const bytes = await downloadRecording(recordingId);
+            const iframe = getGameIframe();
+            if (!iframe?.contentWindow) throw new Error('Game is not running');
+            iframe.contentWindow.postMessage(
+                { type: 'timeline-command', command: 'import-recording', data: { bytes } }, '*', [bytes]);
+        } catch (err) {
+            setIsTransferring(false);
+            addConsoleMessage('error', `Recording load failed: ${err instanceof Error ? err.message : String(err)}`);
+        }
+    }, [isTransferring, getGameIframe, addConsoleMessage]);
+
     // Trim end handle handlers
     const handleTrimStart = useCallback((e: React.MouseEvent) => {
         if (!isConnected || state.isRecording) return;
@@ -450,8 +516,35 @@ const TimelineEditor: React.FC<{ className?: string }> = ({ className }) => {
                     </div>
                 </div>
 
-                {/* Right: Speed and frame counter */}
+                {/* Right: Sharing, speed and frame counter */}
                 <div className="timeline-right-controls">
+                    <button
+                        onClick={toggleTurbo}
+                        className={`timeline-btn timeline-btn-nav timeline-btn-turbo ${state.turboSteps > 1 ? 'active' : ''}`}
+                        title={state.turboSteps > 1 ? "Stop fast-forward" : `Fast-forward live sim (${TURBO_STEPS}x, renders last step only)`}
+                        disabled={!state.isRecording}
+                    >
+                        <FastForward className="timeline-icon" />
+                    </button>
+
+                    <button
+                        onClick={shareRecording}
+                        className="timeline-btn timeline-btn-nav"
+                        title="Save recording to server (id copied to clipboard)"
+                        disabled={isTransferring || state.endFrame <= state.startFrame}
+                    >
+                        <Upload className="timeline-icon" />
+                    </button>
+
+                    <button
+                        onClick={loadRecording}
+                        className="timeline-btn timeline-btn-nav"
+                        title="Load recording by id"
+                        disabled={isTransferring}
+                    >
+                        <Download className="timeline-icon" />
+                    </button>
+
                     <div className="timeline-speed">
                         <input
                             type="range"
@@ -467,7 +560,10 @@ const TimelineEditor: React.FC<{ className?: string }> = ({ className }) => {
                         </span>
                     </div>
 
-                    <div className="timeline-frame-counter">
+                    <div
+                        className="timeline-frame-counter"
+                        title={state.memoryUsed > 0 ? `Game memory: ${(state.memoryUsed / (1024 * 1024)).toFixed(1)} MB` : undefined}
+                    >
                         <span className="timeline-frame-current">{displayFrame}</span>
                         <span className="timeline-frame-separator"> / </span>
                         <span className="timeline-frame-total">{state.endFrame || '—'}</span>
@@ -131,7 +131,8 @@ export function useLocalPersistence() {
         const knownTemplateIds = new Set([
           'simple-sdl-demo',
           'live-coding-demo',
-          'multiplayer-pong'
+          'multiplayer-pong',
+          'stress-test'
         ]);
 
         const userProjects = projects.filter(p => !knownTemplateIds.has(p.id));
@@ -37,6 +37,13 @@ export interface BuildRequest {
 export interface BuildResponse {
   buildId: string;
   status: "queued";
+  // Server's prediction (epoch ms)
+  estimate?: {
+    buildMs: number;
+    ahead: number;
+    startAt: number;
+    finishAt: number;
+  } | null;
 }
 
 export interface BuildEvent {
@@ -61,12 +68,25 @@ export interface BuildResult {
   message?: string;
 }
 
+// Session id for the build queue, which splits this IP's share between
+// sessions. sessionStorage makes it one per tab.
+function getClientId(): string {
+  let id = sessionStorage.getItem("buildClientId");
+  if (!id) {
+    // randomUUID is only there in secure contexts
+    id = crypto.randomUUID?.() ?? `${Date.now().toString(36)}-${Math.random().toString(36).slice(2)}`;
+    sessionStorage.setItem("buildClientId", id);
+  }
+  return id;
+}
+
 // Submit a new build
 export async function submitBuild(request: BuildRequest): Promise<BuildResponse> {
   const response = await fetch(`${API_BASE_URL}/api/build`, {
     method: "POST",
     headers: {
       "Content-Type": "application/json",
+      "X-Client-Id": getClientId(),
     },
     credentials: "include",
     body: JSON.stringify(request),
@@ -322,6 +342,52 @@ export function subscribeToBuild(
   };
 }
 
+// ============================================================================
+// TIMELINE RECORDINGS
+// ============================================================================
+
+export interface RecordingUploadResult {
+  recordingId: string;
+  size: number;
+  startFrame: number;
+  endFrame: number;
+}
+
+// Upload an exported recording (raw bytes, streamed to storage by the backend)
+export async function uploadRecording(bytes: ArrayBuffer): Promise<RecordingUploadResult> {
+  const response = await fetch(`${API_BASE_URL}/api/recordings`, {
+    method: "POST",
+    headers: {
+      "Content-Type": "application/octet-stream",
+    },
+    credentials: "include",
+    body: bytes,
+  });
+
+  if (!response.ok) {
+    const error = await response.json().catch(() => ({ error: "Network error" }));
+    throw new Error(error.error || `Recording upload failed: ${response.status}`);
+  }
+
+  return response.json();
+}
+
+// Download a stored recording
+export async function downloadRecording(recordingId: string): Promise<ArrayBuffer> {
+  const response = await fetch(`${API_BASE_URL}/api/recordings/${encodeURIComponent(recordingId)}`, {
+    credentials: "include",
+  });
+
+  if (!response.ok) {
+    if (response.status === 404) {
+      throw new Error("Recording not found");
+    }
+    throw new Error(`Recording download failed: ${response.status}`);
+  }
+
+  return response.arrayBuffer();
+}
+
 // Get preview URL for a build
 export function getPreviewUrl(buildId: string): string {
   return `${API_BASE_URL}/preview/${buildId}`;
@@ -1,7 +1,7 @@
 import { Project, ProjectFile } from '@/types/playground';
 
 const DB_NAME = 'codeforge-db';
-const DB_VERSION = 1;
+const DB_VERSION = 2;
 
 interface ExcalidrawDrawing {
   projectId: string;
@@ -9,6 +9,13 @@ interface ExcalidrawDrawing {
   updatedAt: Date;
 }
 
+// Serialized preview session (game.h SavedStateHeader), one per project
+export interface SavedGameState {
+  projectId: string;
+  bytes: ArrayBuffer;
+  updatedAt: Date;
+}
+
 let dbPromise: Promise<IDBDatabase> | null = null;
 
 function openDB(): Promise<IDBDatabase> {
@@ -32,6 +39,11 @@ function openDB(): Promise<IDBDatabase> {
       if (!db.objectStoreNames.contains('excalidraw')) {
         db.createObjectStore('excalidraw', { keyPath: 'projectId' });
       }
+
+      // Preview session store (added in v2)
+      if (!db.objectStoreNames.contains('gameState')) {
+        db.createObjectStore('gameState', { keyPath: 'projectId' });
+      }
     };
   });
 
@@ -176,3 +188,46 @@ export async function getAllExcalidrawDrawings(): Promise<ExcalidrawDrawing[]> {
     request.onsuccess = () => resolve(request.result);
   });
 }
+
+// ============ Preview Session State ============
+
+export async function getGameState(projectId: string): Promise<SavedGameState | undefined> {
+  const db = await openDB();
+  return new Promise((resolve, reject) => {
+    const transaction = db.transaction('gameState', 'readonly');
+    const store = transaction.objectStore('gameState');
+    const request = store.get(projectId);
+
+    request.onerror = () => reject(request.error);
+    request.onsuccess = () => resolve(request.result);
+  });
+}
+
+export async function saveGameState(projectId: string, bytes: ArrayBuffer): Promise<void> {
+  const db = await openDB();
+  return new Promise((resolve, reject) => {
+    const transaction = db.transaction('gameState', 'readwrite');
+    const store = transaction.objectStore('gameState');
+    const state: SavedGameState = {
+      projectId,
+      bytes,
+      updatedAt: new Date(),
+    };
+    const request = store.put(state);
+
+    request.onerror = () => reject(request.error);
+    request.onsuccess = () => resolve();
+  });
+}
+
+export async function deleteGameState(projectId: string): Promise<void> {
+  const db = await openDB();
+  return new Promise((resolve, reject) => {
+    const transaction = db.transaction('gameState', 'readwrite');
+    const store = transaction.objectStore('gameState');
+    const request = store.delete(projectId);
+
+    request.onerror = () => reject(request.error);
+    request.onsuccess = () => resolve();
+  });
+}
@@ -0,0 +1,80 @@
+#ifndef BASE_ARENA_H
+#define BASE_ARENA_H
+
+// ----------------------------------------------------------------------------
+// Arena allocator
+//
+// A linear allocator over one caller-provided block. Header-only and free of
+// globals, so it is hot-reload safe: the Arena struct lives in GameContext
+// and the block outlives every reloaded game.wasm.
+//
+//   arena_push      bump-allocate zeroed memory (NULL when exhausted)
+//   arena_temp_*    scoped reset: everything pushed inside the scope is freed
+//   arena_sub       carve a fixed-size child arena (e.g. per-frame scratch)
+// ----------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <string.h>
+
+#define ARENA_ALIGN 16
+
+typedef struct {
+    unsigned char *base;
+    size_t size;
+    size_t used;
+    size_t high_water;
+} Arena;
+
+typedef struct {
+    Arena *arena;
+    size_t mark;
+} ArenaTemp;
+
+// Bytes a push of `size` consumes, for sizing the block up front
+static inline size_t arena_size_for(size_t size) {
+    return (size + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static inline void arena_init(Arena *a, void *memory, size_t size) {
+    a->base = (unsigned char*)memory;
+    a->size = size;
+    a->used = 0;
+    a->high_water = 0;
+}
+
+static inline void *arena_push(Arena *a, size_t size) {
+    size_t start = arena_size_for(a->used);
+    if (!a->base || start > a->size || size > a->size - start) return NULL;
+
+    a->used = start + size;
+    if (a->used > a->high_water) a->high_water = a->used;
+
+    void *p = a->base + start;
+    memset(p, 0, size);
+    return p;
+}
+
+#define arena_push_array(a, T, count) ((T*)arena_push((a), sizeof(T) * (size_t)(count)))
+#define arena_push_struct(a, T)       arena_push_array(a, T, 1)
+
+static inline void arena_reset(Arena *a) {
+    a->used = 0;
+}
+
+static inline ArenaTemp arena_temp_begin(Arena *a) {
+    ArenaTemp t = { a, a->used };
+    return t;
+}
+
+static inline void arena_temp_end(ArenaTemp t) {
+    t.arena->used = t.mark;
+}
+
+static inline Arena arena_sub(Arena *parent, size_t size) {
+    Arena child;
+    arena_init(&child, arena_push(parent, size), size);
+    if (!child.base) child.size = 0;
+    return child;
+}
+
+#endif
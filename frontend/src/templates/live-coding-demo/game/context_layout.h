@@ -0,0 +1,140 @@
+#ifndef CONTEXT_LAYOUT_H
+#define CONTEXT_LAYOUT_H
+
+// ----------------------------------------------------------------------------
+// Struct layout descriptors + migration across hot-reloads
+//
+// The host keeps one context allocation for the whole session, but each
+// game.wasm build may lay the struct out differently. Every build exports a
+// descriptor of its context (field name, type name, offset, element size,
+// element count), generated from the same X-macro list as the struct, so it
+// can't drift. On reload the host copies the old build's descriptor out
+// before swapping and hands it to the new build, which moves each field by
+// name into a fresh allocation:
+//
+//   same name, type and element size   copied (arrays: min(old, new) elements)
+//   renamed, retyped or resized        left zeroed, reported as dropped
+//   new field                          zeroed
+//
+// Nested struct fields move as one blob (matched by type name + size), so
+// reordering *inside* e.g. ReplaySystem is not detected; change its size or
+// name to force a reset.
+//
+// Memory the context points at (arena blocks) isn't described field by field;
+// the game stamps a memory_signature instead and resets those buffers itself
+// when it changes.
+//
+// The descriptor is plain data with names inline (no pointers), so a host can
+// copy it byte for byte even after the old module is gone.
+//
+// Header-only, no globals (hot-reload safe).
+// ----------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#define CONTEXT_LAYOUT_MAGIC       0x54554F4Cu   // "LOUT"
+#define CONTEXT_LAYOUT_MAX_FIELDS  64
+#define CONTEXT_LAYOUT_NAME_LEN    32
+
+typedef struct {
+    char name[CONTEXT_LAYOUT_NAME_LEN];
+    char type[CONTEXT_LAYOUT_NAME_LEN];
+    unsigned int offset;
+    unsigned int elem_size;
+    unsigned int count;          // 1 for scalars
+} FieldLayout;
+
+typedef struct {
+    unsigned int magic;
+    unsigned int struct_size;
+    unsigned int field_count;
+    unsigned int memory_signature;   // game-defined, see above
+    FieldLayout fields[CONTEXT_LAYOUT_MAX_FIELDS];
+} ContextLayout;
+
+typedef struct {
+    int copied;
+    int resized;                 // arrays copied with a different length
+    int added;
+    int dropped;
+} LayoutMigration;
+
+// X-macro adapters: FIELDS(LAYOUT_FIELD, LAYOUT_ARRAY) with `LAYOUT_OF` set
+// to the struct type, inside a ContextLayout initializer
+#define LAYOUT_FIELD(type, name) \
+    { #name, #type, (unsigned int)offsetof(LAYOUT_OF, name), (unsigned int)sizeof(type), 1 },
+#define LAYOUT_ARRAY(type, name, count) \
+    { #name, #type, (unsigned int)offsetof(LAYOUT_OF, name), (unsigned int)sizeof(type), (unsigned int)(count) },
+#define LAYOUT_COUNT_FIELD(type, name) + 1
+#define LAYOUT_COUNT_ARRAY(type, name, count) + 1
+
+static inline const FieldLayout *layout_find(const ContextLayout *layout, const char *name) {
+    for (unsigned int i = 0; i < layout->field_count; i++) {
+        if (strncmp(layout->fields[i].name, name, CONTEXT_LAYOUT_NAME_LEN) == 0) return &layout->fields[i];
+    }
+    return NULL;
+}
+
+static inline bool layout_equal(const ContextLayout *a, const ContextLayout *b) {
+    if (a->struct_size != b->struct_size || a->field_count != b->field_count) return false;
+    for (unsigned int i = 0; i < a->field_count; i++) {
+        const FieldLayout *fa = &a->fields[i], *fb = &b->fields[i];
+        if (fa->offset != fb->offset || fa->elem_size != fb->elem_size || fa->count != fb->count ||
+            strncmp(fa->name, fb->name, CONTEXT_LAYOUT_NAME_LEN) != 0 ||
+            strncmp(fa->type, fb->type, CONTEXT_LAYOUT_NAME_LEN) != 0) return false;
+    }
+    return true;
+}
+
+// Also checks every field lies inside struct_size, since layouts can come
+// from outside the running build (saved sessions) and layout_migrate copies
+// by them
+static inline bool layout_valid(const ContextLayout *layout) {
+    if (!layout || layout->magic != CONTEXT_LAYOUT_MAGIC || layout->field_count > CONTEXT_LAYOUT_MAX_FIELDS) return false;
+    for (unsigned int i = 0; i < layout->field_count; i++) {
+        const FieldLayout *f = &layout->fields[i];
+        if ((unsigned long long)f->offset + (unsigned long long)f->elem_size * f->count > layout->struct_size) return false;
+    }
+    return true;
+}
+
+// True if `name` exists in both layouts and is carried over in full
+static inline bool layout_field_kept(const ContextLayout *from, const ContextLayout *to, const char *name) {
+    const FieldLayout *of = layout_find(from, name);
+    const FieldLayout *nf = layout_find(to, name);
+    return of && nf && of->elem_size == nf->elem_size && of->count == nf->count &&
+           strncmp(of->type, nf->type, CONTEXT_LAYOUT_NAME_LEN) == 0;
+}
+
+// Copies every compatible field of `from` (old layout) into `to` (new layout,
+// zero-initialised by the caller)
+static inline LayoutMigration layout_migrate(void *to, const ContextLayout *to_layout,
+                                             const void *from, const ContextLayout *from_layout) {
+    LayoutMigration m = { 0, 0, 0, 0 };
+    for (unsigned int i = 0; i < to_layout->field_count; i++) {
+        const FieldLayout *nf = &to_layout->fields[i];
+        const FieldLayout *of = layout_find(from_layout, nf->name);
+        if (!of) { m.added++; continue; }
+
+        if (of->elem_size != nf->elem_size || strncmp(of->type, nf->type, CONTEXT_LAYOUT_NAME_LEN) != 0) {
+            m.dropped++;
+            continue;
+        }
+
+        unsigned int count = of->count < nf->count ? of->count : nf->count;
+        memcpy((unsigned char*)to + nf->offset, (const unsigned char*)from + of->offset,
+               (size_t)count * nf->elem_size);
+        if (of->count != nf->count) m.resized++;
+        else m.copied++;
+    }
+
+    // old fields with no counterpart at all
+    for (unsigned int i = 0; i < from_layout->field_count; i++) {
+        if (!layout_find(to_layout, from_layout->fields[i].name)) m.dropped++;
+    }
+    return m;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef ENTITY_POOL_H
+#define ENTITY_POOL_H
+
+// ----------------------------------------------------------------------------
+// Dense struct-of-arrays entity pool
+//
+// A pool is a struct with one array per field plus `int count` (see the
+// BULLET_FIELDS / ENEMY_FIELDS X-macros in game.h). Live entities occupy
+// index [0 .. count) in every array; the free slots are always the tail
+// [count, capacity), so the free list is implicit and both operations are
+// O(1):
+//
+//   <prefix>_push    take the first free slot (all fields zeroed), -1 when full
+//   <prefix>_remove  move the last live entity into the hole (swap-remove)
+//   <prefix>_sweep   swap-remove every entity whose alive flag was cleared
+//
+// Generated per pool type by DEFINE_SOA_POOL from the same field list as the
+// struct, so adding a field can't leave one array out of a swap-remove.
+//
+// Iteration order is fully defined by the sequence of pushes and removals, so
+// it is the same on every run and after restoring a snapshot (the pools are
+// plain data).
+//
+// Header-only, no globals (hot-reload safe).
+// ----------------------------------------------------------------------------
+
+#include <stdbool.h>
+
+#define SOA_ZERO_FIELD(type, name)  p->name[i] = (type)0;
+#define SOA_MOVE_FIELD(type, name)  p->name[dst] = p->name[src];
+
+// Pool: struct type, FIELDS: X-macro field list, CAP: array length.
+// The field list must contain X(bool, alive) for the sweep.
+#define DEFINE_SOA_POOL(Pool, FIELDS, CAP, prefix)                             \
+    static inline int prefix##_push(Pool *p) {                                 \
+        if (p->count >= (CAP)) return -1;                                      \
+        int i = p->count++;                                                    \
+        FIELDS(SOA_ZERO_FIELD)                                                 \
+        return i;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline void prefix##_remove(Pool *p, int index) {                   \
+        int src = --p->count;                                                  \
+        int dst = index;                                                       \
+        if (dst != src) { FIELDS(SOA_MOVE_FIELD) }                             \
+    }                                                                          \
+                                                                               \
+    /* Deferred removal: gameplay clears `alive` mid-step (so indices stay     \
+       valid for the rest of the step), then one sweep compacts the pool. */   \
+    static inline void prefix##_sweep(Pool *p) {                               \
+        for (int i = 0; i < p->count; ) {                                      \
+            if (p->alive[i]) i++;                                              \
+            else prefix##_remove(p, i);  /* re-check the entity swapped in */  \
+        }                                                                      \
+    }
+
+#endif
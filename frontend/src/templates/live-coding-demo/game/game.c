@@ -7,6 +7,11 @@
 #include <stdio.h>
 
 #include "game.h"
+#include "render_queue.h"
+#include "broadphase.h"
+#include "entity_pool.h"
+#include "simd_kernels.h"
+#include "profiler.h"
 
 // -----------------------------------------------------------------------------
 // LIVE CODING RULES
@@ -24,6 +29,39 @@ static const SDL_Color BG_LIVE     = { 0, 14, 24, 255 };
 static const SDL_Color BG_PLAYBACK = { 0, 22, 14, 255 };
 static const SDL_Color BG_PAUSED   = { 0, 14, 34, 255 };
 
+// Render layers (render_queue.h only keeps order between layers)
+enum {
+    LAYER_BACKGROUND,
+    LAYER_WORLD,
+    LAYER_WORLD_OVERLAY,
+    LAYER_HUD,
+    LAYER_HUD_OVERLAY,
+    LAYER_BANNER,
+    LAYER_BANNER_OVERLAY
+};
+
+// Broadphase cell: about one enemy diameter, so an enemy touches at most 2x2..3x3 cells
+static const float BROADPHASE_CELL_SIZE = 32.0f;
+
+// Everything one frame can queue: bullets, enemies + pips, HUD
+#define RENDER_QUEUE_CAPACITY (MAX_BULLETS + MAX_ENEMIES * 2 + 32)
+
+static const SDL_Color COLOR_BORDER     = { 50, 50, 70, 255 };
+static const SDL_Color COLOR_PLAYER     = { 99, 102, 241, 255 };
+static const SDL_Color COLOR_BULLET     = { 0, 255, 0, 255 };
+static const SDL_Color COLOR_ENEMY      = { 255, 0, 0, 255 };
+static const SDL_Color COLOR_ENEMY_PIP  = { 253, 230, 138, 255 };
+static const SDL_Color COLOR_LIFE       = { 239, 68, 68, 255 };
+static const SDL_Color COLOR_METER_BG   = { 70, 70, 90, 255 };
+static const SDL_Color COLOR_METER_FG   = { 234, 179, 8, 255 };
+static const SDL_Color COLOR_BANNER_DIM = { 0, 0, 0, 160 };
+static const SDL_Color COLOR_BANNER_BAR = { 239, 68, 68, 255 };
+
+// Fixed timestep: the sim always advances in SIM_DT steps regardless of the
+// display refresh rate, so a 120Hz monitor doesn't run the game twice as fast.
+static const double SIM_DT = 1.0 / 60.0;
+static const int    MAX_CATCHUP_STEPS = 5;   // after a stalled tab, drop time instead of spiralling
+
 // Gameplay tuning (reads every frame)
 static const float PLAYER_SPEED = 4.0f;
 static const int   FIRE_COOLDOWN_FRAMES = 8;
@@ -65,17 +103,9 @@ static int irand(unsigned int *state, int a, int b_inclusive) {
     return a + (int)(r % (unsigned int)span);
 }
 
-static bool aabb_hit(float ax, float ay, float aw, float ah,
-                     float bx, float by, float bw, float bh) {
-    return ax < bx + bw && ax + aw > bx && ay < by + bh && ay + ah > by;
-}
-
-static void draw_circle(SDL_Renderer *ren, int cx, int cy, int r) {
-    for (int dy = -r; dy <= r; dy++) {
-        int span = (int)sqrtf((float)(r*r - dy*dy));
-        SDL_RenderDrawLine(ren, cx - span, cy + dy, cx + span, cy + dy);
-    }
-}
+// bullets_push/remove/sweep, enemies_push/remove/sweep (entity_pool.h)
+DEFINE_SOA_POOL(Bullets, BULLET_FIELDS, MAX_BULLETS, bullets)
+DEFINE_SOA_POOL(Enemies, ENEMY_FIELDS, MAX_ENEMIES, enemies)
 
 // ----------------------------------------------------------------------------
 // Replay helpers
@@ -85,22 +115,12 @@ static void draw_circle(SDL_Renderer *ren, int cx, int cy, int r) {
 // This is OK: it resets on reload and gets set again next frame.
 static GameContext *g_ctx = NULL;
 
-static void replay_init_if_needed(GameContext *ctx) {
-    // Check if already initialized by verifying capacity is set to expected value
-    // (Can't just check pointers because uninitialized malloc may have garbage non-null values)
-    if (ctx->replay.snapshot_capacity == MAX_REPLAY_FRAMES && ctx->replay.snapshots != NULL) {
-        return;
-    }
-
-    // Free old allocations if they exist (in case of partial initialization)
-    if (ctx->replay.events) { free(ctx->replay.events); ctx->replay.events = NULL; }
-    if (ctx->replay.snapshots) { free(ctx->replay.snapshots); ctx->replay.snapshots = NULL; }
-
+static void replay_init(GameContext *ctx) {
     ctx->replay.event_capacity = MAX_REPLAY_EVENTS;
-    ctx->replay.events = (InputEvent*)malloc(sizeof(InputEvent) * ctx->replay.event_capacity);
+    ctx->replay.events = arena_push_array(&ctx->arena, InputEvent, ctx->replay.event_capacity);
 
     ctx->replay.snapshot_capacity = MAX_REPLAY_FRAMES;
-    ctx->replay.snapshots = (GameSnapshot*)malloc(sizeof(GameSnapshot) * ctx->replay.snapshot_capacity);
+    ctx->replay.snapshots = arena_push_array(&ctx->arena, GameSnapshot, ctx->replay.snapshot_capacity);
 
     ctx->replay.event_count = 0;
     ctx->replay.recorded_start_frame = 0;
@@ -113,51 +133,71 @@ static void replay_init_if_needed(GameContext *ctx) {
     ctx->replay.playback_accumulator = 0.0f;
     ctx->replay.loop_enabled = true;
 
-    printf("Replay system initialized (frames=%d, ~%d KB)\n", 
-           ctx->replay.snapshot_capacity,
-           (int)(ctx->replay.snapshot_capacity * sizeof(GameSnapshot) / 1024));
+    ctx->replay.export_data = NULL;
+    ctx->replay.export_size = 0;
 }
 
 // ----------------------------------------------------------------------------
 // Simple loop recorder (L key feature)
-// Uses ctx->loop_ptr to persist across hot-reloads
+// Lives in the arena; ctx->loop_ptr finds it again after a hot-reload
 // ----------------------------------------------------------------------------
 
 static LoopRecorder *g_loop = NULL;
 
-static void loop_init_if_needed(GameContext *ctx) {
-    // Restore from persistent storage if available (survives hot-reload)
-    if (ctx->loop_ptr) {
+static void loop_init(GameContext *ctx) {
+    LoopRecorder *loop = arena_push_struct(&ctx->arena, LoopRecorder);
+    loop->inputs = arena_push_array(&ctx->arena, LoopInputFrame, LOOP_MAX_INPUTS);
+    loop->start_snapshot = arena_push_struct(&ctx->arena, GameSnapshot);
+    loop->keyboard_backup = arena_push_array(&ctx->arena, int, MAX_KEYBOARD_KEYS);
+
+    loop->state = LOOP_IDLE;
+    loop->input_count = 0;
+    loop->playback_index = 0;
+
+    ctx->loop_ptr = loop;
+}
+
+// ----------------------------------------------------------------------------
+// Game memory: one block, reserved on first run, kept across hot-reloads.
+// Layout: [replay events][replay snapshots][loop recorder][profiler][frame scratch]
+// ----------------------------------------------------------------------------
+
+static size_t game_memory_size(void) {
+    return arena_size_for(sizeof(InputEvent) * MAX_REPLAY_EVENTS)
+         + arena_size_for(sizeof(GameSnapshot) * MAX_REPLAY_FRAMES)
+         + arena_size_for(sizeof(LoopRecorder))
+         + arena_size_for(sizeof(LoopInputFrame) * LOOP_MAX_INPUTS)
+         + arena_size_for(sizeof(GameSnapshot))
+         + arena_size_for(sizeof(int) * MAX_KEYBOARD_KEYS)
+         + arena_size_for(sizeof(Profiler))
+         + arena_size_for(FRAME_SCRATCH_SIZE);
+}
+
+// Returns false if the block couldn't be reserved (the frame is skipped)
+static bool memory_init_if_needed(GameContext *ctx) {
+    if (ctx->arena.base) {
         g_loop = (LoopRecorder*)ctx->loop_ptr;
-        return;
-    }
-    
-    // First time initialization
-    g_loop = (LoopRecorder*)malloc(sizeof(LoopRecorder));
-    if (!g_loop) {
-        printf("[Loop] ERROR: Failed to allocate LoopRecorder\n");
-        return;
+        return true;
     }
-    
-    g_loop->inputs = (LoopInputFrame*)malloc(sizeof(LoopInputFrame) * LOOP_MAX_INPUTS);
-    g_loop->start_snapshot = (GameSnapshot*)malloc(sizeof(GameSnapshot));
-    g_loop->keyboard_backup = (int*)malloc(sizeof(int) * MAX_KEYBOARD_KEYS);
-    
-    if (!g_loop->inputs || !g_loop->start_snapshot || !g_loop->keyboard_backup) {
-        printf("[Loop] ERROR: Failed to allocate loop recorder buffers\n");
-        return;
+
+    size_t size = game_memory_size();
+    void *block = malloc(size);
+    if (!block) {
+        printf("[Memory] ERROR: failed to reserve %d KB\n", (int)(size / 1024));
+        return false;
     }
-    
-    g_loop->state = LOOP_IDLE;
-    g_loop->input_count = 0;
-    g_loop->playback_index = 0;
-    memset(g_loop->keyboard_backup, 0, sizeof(int) * MAX_KEYBOARD_KEYS);
-    
-    // Store in persistent location for hot-reload survival
-    ctx->loop_ptr = g_loop;
-    
-    int size_kb = (int)((sizeof(LoopInputFrame) * LOOP_MAX_INPUTS + sizeof(GameSnapshot)) / 1024);
-    printf("Loop recorder initialized (max=%d frames, ~%d KB)\n", LOOP_MAX_INPUTS, size_kb);
+    arena_init(&ctx->arena, block, size);
+
+    replay_init(ctx);
+    loop_init(ctx);
+    ctx->profiler = prof_create(&ctx->arena);
+    ctx->frame_arena = arena_sub(&ctx->arena, FRAME_SCRATCH_SIZE);
+    g_loop = (LoopRecorder*)ctx->loop_ptr;
+
+    printf("Game memory: %d KB (timeline %d frames, loop %d frames, scratch %d KB, %s kernels)\n",
+           (int)(ctx->arena.used / 1024), MAX_REPLAY_FRAMES, LOOP_MAX_INPUTS,
+           (int)(FRAME_SCRATCH_SIZE / 1024), SIMD_KERNELS_BACKEND);
+    return true;
 }
 
 static void loop_capture_snapshot(GameContext *ctx) {
@@ -174,8 +214,8 @@ static void loop_capture_snapshot(GameContext *ctx) {
     s->shoot_cooldown = ctx->shoot_cooldown;
     s->enemy_spawn_timer = ctx->enemy_spawn_timer;
     s->difficulty = ctx->difficulty;
-    memcpy(s->bullets, ctx->bullets, sizeof(ctx->bullets));
-    memcpy(s->enemies, ctx->enemies, sizeof(ctx->enemies));
+    s->bullets = ctx->bullets;
+    s->enemies = ctx->enemies;
     
     memcpy(g_loop->keyboard_backup, ctx->keyboard, sizeof(ctx->keyboard));
 }
@@ -194,8 +234,8 @@ static void loop_restore_snapshot(GameContext *ctx) {
     ctx->shoot_cooldown = s->shoot_cooldown;
     ctx->enemy_spawn_timer = s->enemy_spawn_timer;
     ctx->difficulty = s->difficulty;
-    memcpy(ctx->bullets, s->bullets, sizeof(ctx->bullets));
-    memcpy(ctx->enemies, s->enemies, sizeof(ctx->enemies));
+    ctx->bullets = s->bullets;
+    ctx->enemies = s->enemies;
     
     memcpy(ctx->keyboard, g_loop->keyboard_backup, sizeof(ctx->keyboard));
 }
@@ -293,8 +333,8 @@ static void replay_record_snapshot(GameContext *ctx) {
     s->enemy_spawn_timer = ctx->enemy_spawn_timer;
     s->difficulty = ctx->difficulty;
 
-    memcpy(s->bullets, ctx->bullets, sizeof(ctx->bullets));
-    memcpy(s->enemies, ctx->enemies, sizeof(ctx->enemies));
+    s->bullets = ctx->bullets;
+    s->enemies = ctx->enemies;
 
     ctx->replay.recorded_end_frame = ctx->replay.current_frame;
     
@@ -328,8 +368,8 @@ static void replay_load_frame(GameContext *ctx, int frame) {
     ctx->enemy_spawn_timer = s->enemy_spawn_timer;
     ctx->difficulty = s->difficulty;
 
-    memcpy(ctx->bullets, s->bullets, sizeof(ctx->bullets));
-    memcpy(ctx->enemies, s->enemies, sizeof(ctx->enemies));
+    ctx->bullets = s->bullets;
+    ctx->enemies = s->enemies;
 
     ctx->replay.display_frame = frame;
 }
@@ -339,8 +379,8 @@ static void replay_load_frame(GameContext *ctx, int frame) {
 // ----------------------------------------------------------------------------
 
 static void clear_world(GameContext *ctx) {
-    memset(ctx->bullets, 0, sizeof(ctx->bullets));
-    memset(ctx->enemies, 0, sizeof(ctx->enemies));
+    memset(&ctx->bullets, 0, sizeof(ctx->bullets));
+    memset(&ctx->enemies, 0, sizeof(ctx->enemies));
 }
 
 static float bullet_speed_now(GameContext *ctx) {
@@ -352,36 +392,32 @@ static float enemy_speed_now(GameContext *ctx) {
 }
 
 static void spawn_enemy(GameContext *ctx) {
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        Enemy *e = &ctx->enemies[i];
-        if (e->alive) continue;
+    Enemies *e = &ctx->enemies;
+    int i = enemies_push(e);
+    if (i < 0) return;
 
-        e->alive = true;
-        e->r = irand(&ctx->rng_state, 10, 18);
-        e->x = WINDOW_WIDTH + e->r + frand(&ctx->rng_state, 0, 60);
-        e->y = frand(&ctx->rng_state, 40, WINDOW_HEIGHT - 40);
+    e->alive[i] = true;
+    e->r[i] = irand(&ctx->rng_state, 10, 18);
+    e->x[i] = WINDOW_WIDTH + e->r[i] + frand(&ctx->rng_state, 0, 60);
+    e->y[i] = frand(&ctx->rng_state, 40, WINDOW_HEIGHT - 40);
 
-        float base = enemy_speed_now(ctx);
-        e->vx = -frand(&ctx->rng_state, base, base + 1.5f);
+    float base = enemy_speed_now(ctx);
+    e->vx[i] = -frand(&ctx->rng_state, base, base + 1.5f);
 
-        e->hp = (ctx->difficulty > 6.0f) ? 2 : 1;
-        return;
-    }
+    e->hp[i] = (ctx->difficulty > 6.0f) ? 2 : 1;
 }
 
 static void fire_bullet(GameContext *ctx) {
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        Bullet *b = &ctx->bullets[i];
-        if (b->alive) continue;
-
-        b->alive = true;
-        b->w = BULLET_W;
-        b->h = BULLET_H;
-        b->x = ctx->player_x + ctx->player_w;
-        b->y = ctx->player_y + ctx->player_h * 0.5f - b->h * 0.5f;
-        b->vx = bullet_speed_now(ctx);
-        return;
-    }
+    Bullets *b = &ctx->bullets;
+    int i = bullets_push(b);
+    if (i < 0) return;
+
+    b->alive[i] = true;
+    b->w[i] = BULLET_W;
+    b->h[i] = BULLET_H;
+    b->x[i] = ctx->player_x + ctx->player_w;
+    b->y[i] = ctx->player_y + ctx->player_h * 0.5f - b->h[i] * 0.5f;
+    b->vx[i] = bullet_speed_now(ctx);
 }
 
 static void reset_game_live(GameContext *ctx) {
@@ -402,6 +438,7 @@ static void reset_game_live(GameContext *ctx) {
 
     ctx->shake = 0.0f;
     ctx->flash = 0.0f;
+    ctx->fx_rng_state = 0x9E3779B9u;
     ctx->console_tick = 0;
 
     clear_world(ctx);
@@ -469,25 +506,32 @@ static void retune_existing_entities(GameContext *ctx) {
     if (!RETUNE_EXISTING_ENTITY_SPEEDS) return;
 
     // bullets
-    float bv = bullet_speed_now(ctx);
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        Bullet *b = &ctx->bullets[i];
-        if (!b->alive) continue;
-        b->vx = bv;
-        b->w = BULLET_W;
-        b->h = BULLET_H;
+    Bullets *b = &ctx->bullets;
+    k_fill(b->vx, bullet_speed_now(ctx), b->count);
+    for (int i = 0; i < b->count; i++) {
+        b->w[i] = BULLET_W;
+        b->h[i] = BULLET_H;
     }
 
-    // enemies
+    // enemies (keep direction (-), simple retune)
     float ev = enemy_speed_now(ctx);
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        Enemy *e = &ctx->enemies[i];
-        if (!e->alive) continue;
+    k_fill(ctx->enemies.vx, -fmaxf(1.0f, ev), ctx->enemies.count);
+}
 
-        // keep direction (-)
-        float mag = fabsf(e->vx);
-        (void)mag;
-        e->vx = -fmaxf(1.0f, ev); // simple retune
+// Grid over the play area plus the spawn margin on the right; anything
+// outside is clamped into the edge cells.
+static void build_enemy_grid(GameContext *ctx, Broadphase *grid) {
+    BpBox *boxes = arena_push_array(&ctx->frame_arena, BpBox, MAX_ENEMIES);
+    int count = 0;
+    const Enemies *e = &ctx->enemies;
+    for (int i = 0; boxes && i < e->count; i++) {
+        if (!e->alive[i]) continue;
+        boxes[count++] = (BpBox){ e->x[i] - e->r[i], e->y[i] - e->r[i], (float)(e->r[i] * 2), (float)(e->r[i] * 2), i };
+    }
+
+    if (!boxes || !bp_build(grid, &ctx->frame_arena, boxes, count,
+                            0.0f, 0.0f, (float)WINDOW_WIDTH + 80.0f, (float)WINDOW_HEIGHT, BROADPHASE_CELL_SIZE)) {
+        printf("[Broadphase] ERROR: frame scratch too small for %d enemies\n", count);
     }
 }
 
@@ -531,69 +575,90 @@ static void update_live(GameContext *ctx) {
         }
     }
 
-    // bullets update
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        Bullet *b = &ctx->bullets[i];
-        if (!b->alive) continue;
-        b->x += b->vx;
-        if (b->x > WINDOW_WIDTH + 20) b->alive = false;
+    PROF_BEGIN(ctx->profiler, "entities");
+
+    // bullets update (integration + offscreen scan are simd_kernels.h batches)
+    Bullets *bullets = &ctx->bullets;
+    k_add(bullets->x, bullets->vx, bullets->count);
+    for (int i = k_find_gt(bullets->x, WINDOW_WIDTH + 20, 0, bullets->count); i < bullets->count;
+         i = k_find_gt(bullets->x, WINDOW_WIDTH + 20, i + 1, bullets->count)) {
+        bullets->alive[i] = false;
     }
 
-    // enemies update
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        Enemy *e = &ctx->enemies[i];
-        if (!e->alive) continue;
+    // enemies update: the jitter draws stay sequential (one rng stream, pool
+    // order), everything after that is batched
+    Enemies *enemies = &ctx->enemies;
+    if (!ctx->game_over) {
+        for (int i = 0; i < enemies->count; i++) enemies->y[i] += frand(&ctx->rng_state, -0.7f, 0.7f);
+        k_clamp(enemies->y, 30.0f, (float)WINDOW_HEIGHT - 30.0f, enemies->count);
+        k_add(enemies->x, enemies->vx, enemies->count);
+    }
 
+    // passed left => lose life
+    for (int i = k_find_lt(enemies->x, -40, 0, enemies->count); i < enemies->count;
+         i = k_find_lt(enemies->x, -40, i + 1, enemies->count)) {
+        enemies->alive[i] = false;
         if (!ctx->game_over) {
-            e->y += frand(&ctx->rng_state, -0.7f, 0.7f);
-            e->y = clampf(e->y, 30.0f, (float)WINDOW_HEIGHT - 30.0f);
-            e->x += e->vx;
+            ctx->lives--;
+            ctx->shake = 5.0f;
+            ctx->flash = 1.0f;
+            if (ctx->lives <= 0) {
+                ctx->game_over = true;
+                printf("GAME OVER! Final score: %d (press R)\n", ctx->score);
+            }
         }
+    }
 
-        // passed left => lose life
-        if (e->x < -40) {
-            e->alive = false;
-            if (!ctx->game_over) {
-                ctx->lives--;
-                ctx->shake = 5.0f;
-                ctx->flash = 1.0f;
-                if (ctx->lives <= 0) {
-                    ctx->game_over = true;
-                    printf("GAME OVER! Final score: %d (press R)\n", ctx->score);
+    // collisions: enemies go into a uniform grid (broadphase.h), bullets and
+    // the player only test the boxes in the cells they overlap, 4 at a time
+    // (k_aabb_first_overlap). Scratch is scoped so turbo (many steps per
+    // frame) doesn't grow the frame arena.
+    PROF_END(ctx->profiler);
+
+    PROF_BEGIN(ctx->profiler, "collisions");
+    ArenaTemp scratch = arena_temp_begin(&ctx->frame_arena);
+    Broadphase grid;
+    build_enemy_grid(ctx, &grid);
+
+    // bullet vs enemy collisions (lowest enemy index wins, like a linear scan)
+    for (int bi = 0; bi < bullets->count; bi++) {
+        if (!bullets->alive[bi]) continue;
+
+        float bx = bullets->x[bi];
+        float by = bullets->y[bi];
+        float bw = (float)bullets->w[bi];
+        float bh = (float)bullets->h[bi];
+
+        int hit = -1;
+        BpCellRange cr = bp_cells(&grid, bx, by, bw, bh);
+        for (int cy = cr.y0; cy <= cr.y1; cy++) {
+            for (int cx = cr.x0; cx <= cr.x1; cx++) {
+                int begin, end;
+                bp_cell_span(&grid, cx, cy, &begin, &end);
+                for (int k = begin; ; k++) {
+                    k = k_aabb_first_overlap(bx, by, bw, bh, grid.box_x, grid.box_y, grid.box_w, grid.box_h, k, end);
+                    if (k == end) break;
+                    int ei = grid.items[k];
+                    if (hit >= 0 && ei >= hit) break;   // ids ascending per cell
+                    if (!enemies->alive[ei]) continue;
+                    hit = ei;
+                    break;
                 }
             }
         }
-    }
+        if (hit < 0) continue;
 
-    // bullet vs enemy collisions
-    for (int bi = 0; bi < MAX_BULLETS; bi++) {
-        Bullet *b = &ctx->bullets[bi];
-        if (!b->alive) continue;
+        bullets->alive[bi] = false;
+        enemies->hp[hit]--;
 
-        for (int ei = 0; ei < MAX_ENEMIES; ei++) {
-            Enemy *e = &ctx->enemies[ei];
-            if (!e->alive) continue;
+        ctx->shake = fmaxf(ctx->shake, 2.5f);
+        ctx->flash = fmaxf(ctx->flash, 0.4f);
 
-            float ex = e->x - e->r;
-            float ey = e->y - e->r;
-            float ew = (float)(e->r * 2);
-            float eh = (float)(e->r * 2);
-
-            if (aabb_hit(b->x, b->y, (float)b->w, (float)b->h, ex, ey, ew, eh)) {
-                b->alive = false;
-                e->hp--;
-
-                ctx->shake = fmaxf(ctx->shake, 2.5f);
-                ctx->flash = fmaxf(ctx->flash, 0.4f);
-
-                if (e->hp <= 0) {
-                    e->alive = false;
-                    ctx->score += 10;
-                } else {
-                    ctx->score += 3;
-                }
-                break;
-            }
+        if (enemies->hp[hit] <= 0) {
+            enemies->alive[hit] = false;
+            ctx->score += 10;
+        } else {
+            ctx->score += 3;
         }
     }
 
@@ -604,30 +669,38 @@ static void update_live(GameContext *ctx) {
         float pw = (float)ctx->player_w;
         float ph = (float)ctx->player_h;
 
-        for (int ei = 0; ei < MAX_ENEMIES; ei++) {
-            Enemy *e = &ctx->enemies[ei];
-            if (!e->alive) continue;
-
-            float ex = e->x - e->r;
-            float ey = e->y - e->r;
-            float ew = (float)(e->r * 2);
-            float eh = (float)(e->r * 2);
-
-            if (aabb_hit(px, py, pw, ph, ex, ey, ew, eh)) {
-                e->alive = false;
-                ctx->lives--;
-                ctx->shake = 6.0f;
-                ctx->flash = 1.0f;
-
-                if (ctx->lives <= 0) {
-                    ctx->game_over = true;
-                    printf("GAME OVER! Final score: %d (press R)\n", ctx->score);
-                } else {
-                    printf("Hit! Lives: %d\n", ctx->lives);
+        BpCellRange cr = bp_cells(&grid, px, py, pw, ph);
+        for (int cy = cr.y0; cy <= cr.y1; cy++) {
+            for (int cx = cr.x0; cx <= cr.x1; cx++) {
+                int begin, end;
+                bp_cell_span(&grid, cx, cy, &begin, &end);
+                for (int k = begin; ; k++) {
+                    k = k_aabb_first_overlap(px, py, pw, ph, grid.box_x, grid.box_y, grid.box_w, grid.box_h, k, end);
+                    if (k == end) break;
+                    int ei = grid.items[k];
+                    if (!enemies->alive[ei]) continue;   // also skips repeats from neighbouring cells
+
+                    enemies->alive[ei] = false;
+                    ctx->lives--;
+                    ctx->shake = 6.0f;
+                    ctx->flash = 1.0f;
+
+                    if (ctx->lives <= 0) {
+                        ctx->game_over = true;
+                        printf("GAME OVER! Final score: %d (press R)\n", ctx->score);
+                    } else {
+                        printf("Hit! Lives: %d\n", ctx->lives);
+                    }
                 }
             }
         }
     }
+    arena_temp_end(scratch);
+    PROF_END(ctx->profiler);
+
+    // despawn everything that died this step (swap-remove, see entity_pool.h)
+    bullets_sweep(bullets);
+    enemies_sweep(enemies);
 
     // juice decay
     ctx->shake *= 0.90f;
@@ -636,10 +709,11 @@ static void update_live(GameContext *ctx) {
     if (ctx->flash < 0.01f) ctx->flash = 0.0f;
 
     // console ticker
+    // (silent in turbo, printing hundreds of lines per displayed frame is the bottleneck)
     ctx->console_tick++;
     if (ctx->console_tick >= 120) {
         ctx->console_tick = 0;
-        printf("Score: %d | Lives: %d | Diff: %.2f\n", ctx->score, ctx->lives, ctx->difficulty);
+        if (ctx->turbo_steps <= 1) printf("Score: %d | Lives: %d | Diff: %.2f\n", ctx->score, ctx->lives, ctx->difficulty);
     }
 
     // Loop recorder: record this frame's inputs if recording
@@ -648,7 +722,9 @@ static void update_live(GameContext *ctx) {
     }
 
     // snapshot after sim
-    replay_record_snapshot(ctx);
+    PROF_ZONE(ctx->profiler, "snapshot") {
+        replay_record_snapshot(ctx);
+    }
 
     // advance frame
     ctx->replay.current_frame++;
@@ -676,7 +752,11 @@ static void update_playback(GameContext *ctx) {
 
 static void update(GameContext *ctx) {
     switch (ctx->replay.mode) {
-        case MODE_LIVE:     update_live(ctx);     break;
+        case MODE_LIVE:
+            PROF_BEGIN(ctx->profiler, "update_live");
+            update_live(ctx);
+            PROF_END(ctx->profiler);
+            break;
         case MODE_PLAYBACK: update_playback(ctx); break;
         case MODE_PAUSED:   break;
     }
@@ -685,11 +765,12 @@ static void update(GameContext *ctx) {
 static void render(GameContext *ctx) {
     SDL_Renderer *ren = ctx->renderer;
 
-    // shake only in LIVE
+    // shake only in LIVE (own rng: render runs at display rate, sim rng must not see it)
     int sx = 0, sy = 0;
     if (ctx->replay.mode == MODE_LIVE && ctx->shake > 0.0f) {
-        sx = (int)frand(&ctx->rng_state, -ctx->shake, ctx->shake);
-        sy = (int)frand(&ctx->rng_state, -ctx->shake, ctx->shake);
+        if (ctx->fx_rng_state == 0) ctx->fx_rng_state = 0x9E3779B9u;
+        sx = (int)frand(&ctx->fx_rng_state, -ctx->shake, ctx->shake);
+        sy = (int)frand(&ctx->fx_rng_state, -ctx->shake, ctx->shake);
     }
     SDL_RenderSetViewport(ren, &(SDL_Rect){ sx, sy, WINDOW_WIDTH, WINDOW_HEIGHT });
 
@@ -703,72 +784,61 @@ static void render(GameContext *ctx) {
         SDL_SetRenderDrawColor(ren, bg.r, bg.g, bg.b, 255);
     }
     SDL_RenderClear(ren);
+    SDL_RenderSetViewport(ren, &(SDL_Rect){ 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT });
+
+    // everything else is queued and submitted in batches (render_queue.h)
+    RenderQueue rq;
+    rq_begin(&rq, &ctx->frame_arena, RENDER_QUEUE_CAPACITY);
 
     // border
-    SDL_RenderSetViewport(ren, &(SDL_Rect){ 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT });
-    SDL_SetRenderDrawColor(ren, 50, 50, 70, 255);
-    SDL_Rect border = { 12, 12, WINDOW_WIDTH - 24, WINDOW_HEIGHT - 24 };
-    SDL_RenderDrawRect(ren, &border);
+    rq_draw_rect(&rq, LAYER_BACKGROUND, COLOR_BORDER, (SDL_Rect){ 12, 12, WINDOW_WIDTH - 24, WINDOW_HEIGHT - 24 });
 
     // player
-    SDL_SetRenderDrawColor(ren, 99, 102, 241, 255);
-    SDL_Rect pr = { (int)ctx->player_x, (int)ctx->player_y, ctx->player_w, ctx->player_h };
-    SDL_RenderFillRect(ren, &pr);
+    rq_fill_rect(&rq, LAYER_WORLD, COLOR_PLAYER,
+                 (SDL_Rect){ (int)ctx->player_x, (int)ctx->player_y, ctx->player_w, ctx->player_h });
 
     // bullets
-    SDL_SetRenderDrawColor(ren, 0, 255, 0, 255);
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        Bullet *b = &ctx->bullets[i];
-        if (!b->alive) continue;
-        SDL_Rect br = { (int)b->x, (int)b->y, b->w, b->h };
-        SDL_RenderFillRect(ren, &br);
-    }
-
-    // enemies
-    SDL_SetRenderDrawColor(ren, 255, 0, 0, 255);
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        Enemy *e = &ctx->enemies[i];
-        if (!e->alive) continue;
-        draw_circle(ren, (int)e->x, (int)e->y, e->r);
-
-        if (e->hp > 1) {
-            SDL_SetRenderDrawColor(ren, 253, 230, 138, 255);
-            SDL_Rect pip = { (int)e->x - 3, (int)e->y - e->r - 8, 6, 6 };
-            SDL_RenderFillRect(ren, &pip);
-            SDL_SetRenderDrawColor(ren, 255, 0, 0, 255);
+    const Bullets *b = &ctx->bullets;
+    for (int i = 0; i < b->count; i++) {
+        rq_fill_rect(&rq, LAYER_WORLD, COLOR_BULLET, (SDL_Rect){ (int)b->x[i], (int)b->y[i], b->w[i], b->h[i] });
+    }
+
+    // enemies (+ hp pip above the circle)
+    const Enemies *e = &ctx->enemies;
+    for (int i = 0; i < e->count; i++) {
+        rq_circle(&rq, LAYER_WORLD, COLOR_ENEMY, (int)e->x[i], (int)e->y[i], e->r[i]);
+
+        if (e->hp[i] > 1) {
+            rq_fill_rect(&rq, LAYER_WORLD_OVERLAY, COLOR_ENEMY_PIP,
+                         (SDL_Rect){ (int)e->x[i] - 3, (int)e->y[i] - e->r[i] - 8, 6, 6 });
         }
     }
 
     // lives
     for (int i = 0; i < ctx->lives; i++) {
-        SDL_SetRenderDrawColor(ren, 239, 68, 68, 255);
-        SDL_Rect lr = { 18 + i * 14, 18, 10, 10 };
-        SDL_RenderFillRect(ren, &lr);
+        rq_fill_rect(&rq, LAYER_HUD, COLOR_LIFE, (SDL_Rect){ 18 + i * 14, 18, 10, 10 });
     }
 
     // score meter (shape-only)
     int meterW = 120, meterH = 8;
     int mx = WINDOW_WIDTH - 18 - meterW, my = 18;
     float t = clampf((float)(ctx->score % 100) / 100.0f, 0.0f, 1.0f);
-    SDL_SetRenderDrawColor(ren, 70, 70, 90, 255);
-    SDL_Rect bg = { mx, my, meterW, meterH };
-    SDL_RenderFillRect(ren, &bg);
-    SDL_SetRenderDrawColor(ren, 234, 179, 8, 255);
-    SDL_Rect fg = { mx, my, (int)(meterW * t), meterH };
-    SDL_RenderFillRect(ren, &fg);
+    rq_fill_rect(&rq, LAYER_HUD, COLOR_METER_BG, (SDL_Rect){ mx, my, meterW, meterH });
+    rq_fill_rect(&rq, LAYER_HUD_OVERLAY, COLOR_METER_FG, (SDL_Rect){ mx, my, (int)(meterW * t), meterH });
 
     // game over banner
     if (ctx->game_over) {
-        SDL_SetRenderDrawColor(ren, 0, 0, 0, 160);
-        SDL_Rect dim = { 0, WINDOW_HEIGHT/2 - 38, WINDOW_WIDTH, 76 };
-        SDL_RenderFillRect(ren, &dim);
-
-        SDL_SetRenderDrawColor(ren, 239, 68, 68, 255);
-        SDL_Rect bar = { WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 - 14, 300, 28 };
-        SDL_RenderFillRect(ren, &bar);
+        rq_fill_rect(&rq, LAYER_BANNER, COLOR_BANNER_DIM, (SDL_Rect){ 0, WINDOW_HEIGHT/2 - 38, WINDOW_WIDTH, 76 });
+        rq_fill_rect(&rq, LAYER_BANNER_OVERLAY, COLOR_BANNER_BAR,
+                     (SDL_Rect){ WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 - 14, 300, 28 });
     }
 
-    SDL_RenderPresent(ren);
+    PROF_ZONE(ctx->profiler, "rq_flush") {
+        rq_flush(&rq, ren);
+    }
+    PROF_ZONE(ctx->profiler, "present") {
+        SDL_RenderPresent(ren);
+    }
 }
 
 // ----------------------------------------------------------------------------
@@ -795,6 +865,35 @@ void js_set_sim_speed(float speed) {
     if (g_ctx->replay.playback_speed > 4.0f) g_ctx->replay.playback_speed = 4.0f;
 }
 
+EMSCRIPTEN_KEEPALIVE int js_get_turbo()        { return g_ctx ? g_ctx->turbo_steps : 0; }
+EMSCRIPTEN_KEEPALIVE int js_get_memory_used()   { return g_ctx ? (int)g_ctx->arena.used : 0; }
+
+// Profiler (profiler.h): the editor's Profiler panel switches it on, then
+// polls js_profiler_collect(last_frame_seen) and reads the floats at
+// js_profiler_get_data(); zone name ids index js_profiler_get_names().
+EMSCRIPTEN_KEEPALIVE
+void js_profiler_set_enabled(int enabled) {
+    if (!g_ctx) return;
+    prof_set_enabled(g_ctx->profiler, enabled != 0);
+}
+
+EMSCRIPTEN_KEEPALIVE int js_profiler_is_enabled()            { return (g_ctx && g_ctx->profiler && g_ctx->profiler->enabled) ? 1 : 0; }
+EMSCRIPTEN_KEEPALIVE int js_profiler_collect(int after_frame) { return g_ctx ? prof_collect(g_ctx->profiler, after_frame) : 0; }
+EMSCRIPTEN_KEEPALIVE float *js_profiler_get_data()           { return (g_ctx && g_ctx->profiler) ? g_ctx->profiler->export_buf : NULL; }
+EMSCRIPTEN_KEEPALIVE const char *js_profiler_get_names()     { return (g_ctx && g_ctx->profiler) ? g_ctx->profiler->name_list : ""; }
+
+// Turbo: run `steps` LIVE sim steps per displayed frame and render only the
+// last one. 0 or 1 returns to real-time fixed stepping.
+EMSCRIPTEN_KEEPALIVE
+void js_set_turbo(int steps) {
+    if (!g_ctx) return;
+    if (steps < 0) steps = 0;
+    if (steps > MAX_TURBO_STEPS) steps = MAX_TURBO_STEPS;
+    g_ctx->turbo_steps = steps;
+    g_ctx->sim_accumulator = 0.0;
+    printf("[Timeline] Turbo %s (%d steps/frame)\n", steps > 1 ? "on" : "off", steps > 1 ? steps : 1);
+}
+
 EMSCRIPTEN_KEEPALIVE
 void js_start_recording() {
     if (!g_ctx) return;
@@ -960,16 +1059,442 @@ void js_trim_end(int frame) {
     printf("Trimmed recording: %d -> %d (removed %d frames)\n", old_end, frame, old_end - frame);
 }
 
+// ----------------------------------------------------------------------------
+// Recording export / import (format: RecordingHeader in game.h)
+// JS copies the exported bytes out of the heap, then calls js_free_export().
+// ----------------------------------------------------------------------------
+
+EMSCRIPTEN_KEEPALIVE
+void js_free_export() {
+    if (!g_ctx) return;
+    free(g_ctx->replay.export_data);
+    g_ctx->replay.export_data = NULL;
+    g_ctx->replay.export_size = 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+unsigned char *js_get_export_data() { return g_ctx ? g_ctx->replay.export_data : NULL; }
+
+// Quiet for autosaves (js_save_state), which run every few seconds
+static int export_recording(bool quiet) {
+    if (!g_ctx || !g_ctx->replay.snapshots) return 0;
+    js_free_export();
+
+    ReplaySystem *rp = &g_ctx->replay;
+    int start = rp->recorded_start_frame;
+    int end = rp->recorded_end_frame;
+    if (end < start) return 0;
+
+    // Only events inside the exported window are meaningful
+    int first_event = 0, event_count = 0;
+    for (int i = 0; i < rp->event_count; i++) {
+        if (rp->events[i].frame < start) { first_event = i + 1; continue; }
+        if (rp->events[i].frame > end) break;
+        event_count++;
+    }
+
+    RecordingHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = RECORDING_MAGIC;
+    h.version = RECORDING_VERSION;
+    h.header_size = sizeof(RecordingHeader);
+    h.keyframe_stride = sizeof(GameSnapshot);
+    h.event_stride = sizeof(InputEvent);
+    h.start_frame = start;
+    h.end_frame = end;
+    h.keyframe_count = end - start + 1;
+    h.event_count = event_count;
+    h.keyframe_offset = h.header_size;
+    h.event_offset = h.keyframe_offset + (unsigned int)h.keyframe_count * h.keyframe_stride;
+    h.total_size = h.event_offset + (unsigned int)event_count * h.event_stride;
+    h.max_bullets = MAX_BULLETS;
+    h.max_enemies = MAX_ENEMIES;
+
+    unsigned char *out = (unsigned char*)malloc(h.total_size);
+    if (!out) {
+        printf("[Export] ERROR: Failed to allocate %u bytes\n", h.total_size);
+        return 0;
+    }
+
+    memcpy(out, &h, sizeof(h));
+
+    // Unroll the circular snapshot buffer into frame order
+    GameSnapshot *keyframes = (GameSnapshot*)(out + h.keyframe_offset);
+    for (int f = start; f <= end; f++) {
+        keyframes[f - start] = rp->snapshots[f % rp->snapshot_capacity];
+    }
+    memcpy(out + h.event_offset, &rp->events[first_event], sizeof(InputEvent) * event_count);
+
+    rp->export_data = out;
+    rp->export_size = (int)h.total_size;
+
+    if (!quiet) {
+        printf("Exported recording: frames %d-%d, %d events (%d KB)\n",
+               start, end, event_count, rp->export_size / 1024);
+    }
+    return rp->export_size;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int js_export_recording() { return export_recording(false); }
+
+EMSCRIPTEN_KEEPALIVE
+int js_import_recording(const unsigned char *data, int size) {
+    if (!g_ctx || !g_ctx->replay.snapshots || !data) return 0;
+
+    RecordingHeader h;
+    if (size < (int)sizeof(h)) {
+        printf("[Import] ERROR: File too small (%d bytes)\n", size);
+        return 0;
+    }
+    memcpy(&h, data, sizeof(h));
+
+    if (h.magic != RECORDING_MAGIC || h.version != RECORDING_VERSION) {
+        printf("[Import] ERROR: Not a recording (magic=%08x version=%u)\n", h.magic, h.version);
+        return 0;
+    }
+    if (h.keyframe_stride != sizeof(GameSnapshot) || h.event_stride != sizeof(InputEvent) ||
+        h.max_bullets != MAX_BULLETS || h.max_enemies != MAX_ENEMIES) {
+        printf("[Import] ERROR: Recording layout does not match this build\n");
+        return 0;
+    }
+    // Section ends in 64 bits so a crafted header can't wrap past total_size
+    unsigned long long keyframe_end = (unsigned long long)h.keyframe_offset +
+                                      (unsigned long long)(unsigned int)h.keyframe_count * h.keyframe_stride;
+    unsigned long long event_end = (unsigned long long)h.event_offset +
+                                   (unsigned long long)(unsigned int)h.event_count * h.event_stride;
+    if (h.start_frame < 0 || h.end_frame < h.start_frame || h.keyframe_count <= 0 ||
+        (long long)h.keyframe_count != (long long)h.end_frame - h.start_frame + 1 ||
+        h.event_count < 0 || h.total_size > (unsigned int)size ||
+        h.keyframe_offset < sizeof(h) || keyframe_end > h.total_size ||
+        h.event_offset < sizeof(h) || event_end > h.total_size) {
+        printf("[Import] ERROR: Corrupt recording header\n");
+        return 0;
+    }
+
+    ReplaySystem *rp = &g_ctx->replay;
+
+    // Longer than our ring buffer: keep the most recent frames
+    int start = h.start_frame;
+    if (h.keyframe_count > rp->snapshot_capacity) {
+        start = h.end_frame - rp->snapshot_capacity + 1;
+        printf("[Import] Recording has %d frames, keeping the last %d\n", h.keyframe_count, rp->snapshot_capacity);
+    }
+
+    // Events for the frames kept (the log is in frame order)
+    const InputEvent *events = (const InputEvent*)(data + h.event_offset);
+    int first_event = 0;
+    while (first_event < h.event_count && events[first_event].frame < start) first_event++;
+
+    // More events than the log holds: keep the newest, and start the
+    // timeline after the last dropped event's frame so every frame kept has
+    // all of its events
+    if (h.event_count - first_event > rp->event_capacity) {
+        first_event = h.event_count - rp->event_capacity;
+        while (first_event < h.event_count && events[first_event].frame == events[first_event - 1].frame) first_event++;
+        int event_start = events[first_event - 1].frame + 1;
+        if (event_start > h.end_frame) {
+            printf("[Import] ERROR: More events in the final frames than the log holds (%d)\n", rp->event_capacity);
+            return 0;
+        }
+        printf("[Import] Recording has %d events, log holds %d: starting at frame %d instead of %d\n",
+               h.event_count, rp->event_capacity, event_start, start);
+        start = event_start;
+    }
+    int event_count = h.event_count - first_event;
+    memcpy(rp->events, events + first_event, sizeof(InputEvent) * event_count);
+    rp->event_count = event_count;
+
+    const GameSnapshot *keyframes = (const GameSnapshot*)(data + h.keyframe_offset);
+    for (int f = start; f <= h.end_frame; f++) {
+        memcpy(&rp->snapshots[f % rp->snapshot_capacity], &keyframes[f - h.start_frame], sizeof(GameSnapshot));
+    }
+
+    rp->recorded_start_frame = start;
+    rp->recorded_end_frame = h.end_frame;
+    rp->current_frame = h.end_frame;
+    rp->mode = MODE_PAUSED;
+    rp->playback_accumulator = 0.0f;
+
+    replay_load_frame(g_ctx, start);
+    memset(g_ctx->keyboard, 0, sizeof(g_ctx->keyboard));
+
+    printf("Imported recording: frames %d-%d, %d events\n", start, h.end_frame, event_count);
+    return 1;
+}
+
+// ----------------------------------------------------------------------------
+// Context layout + migration (see context_layout.h)
+//
+// The host copies js_context_layout() of the running build before a reload
+// and passes it to the new build's js_migrate_context(), which returns the
+// context to use from then on (the old pointer if nothing changed).
+// ----------------------------------------------------------------------------
+
+// Bump when something inside the arena changes shape without changing size
+// (e.g. reordering GameSnapshot fields)
+#define GAME_MEMORY_VERSION 1u
+
+// What ctx->arena holds, see game_memory_size()
+#define GAME_MEMORY_SIGNATURE (unsigned int)( \
+      sizeof(InputEvent) * MAX_REPLAY_EVENTS \
+    + sizeof(GameSnapshot) * (MAX_REPLAY_FRAMES + 1) \
+    + sizeof(LoopRecorder) \
+    + sizeof(LoopInputFrame) * LOOP_MAX_INPUTS \
+    + sizeof(int) * MAX_KEYBOARD_KEYS \
+    + sizeof(Profiler) \
+    + FRAME_SCRATCH_SIZE \
+    + (GAME_MEMORY_VERSION << 24))
+
+#define LAYOUT_OF GameContext
+static const ContextLayout GAME_CONTEXT_LAYOUT = {
+    CONTEXT_LAYOUT_MAGIC,
+    sizeof(GameContext),
+    0 GAME_CONTEXT_FIELDS(LAYOUT_COUNT_FIELD, LAYOUT_COUNT_ARRAY),
+    GAME_MEMORY_SIGNATURE,
+    { GAME_CONTEXT_FIELDS(LAYOUT_FIELD, LAYOUT_ARRAY) }
+};
+#undef LAYOUT_OF
+
+typedef char context_layout_fits[(0 GAME_CONTEXT_FIELDS(LAYOUT_COUNT_FIELD, LAYOUT_COUNT_ARRAY))
+                                 <= CONTEXT_LAYOUT_MAX_FIELDS ? 1 : -1];
+
+EMSCRIPTEN_KEEPALIVE const ContextLayout *js_context_layout() { return &GAME_CONTEXT_LAYOUT; }
+EMSCRIPTEN_KEEPALIVE int js_context_layout_size()             { return (int)sizeof(ContextLayout); }
+
+EMSCRIPTEN_KEEPALIVE
+void *js_migrate_context(void *old_ctx, const ContextLayout *old_layout) {
+    if (!old_ctx || !layout_valid(old_layout)) return old_ctx;
+
+    const ContextLayout *layout = &GAME_CONTEXT_LAYOUT;
+    bool same_memory = old_layout->memory_signature == layout->memory_signature;
+    if (same_memory && layout_equal(old_layout, layout)) return old_ctx;
+
+    GameContext *ctx = calloc(1, sizeof(GameContext));
+    if (!ctx) {
+        printf("[Migrate] ERROR: failed to allocate %d bytes, keeping the old context\n", (int)sizeof(GameContext));
+        return old_ctx;
+    }
+
+    LayoutMigration m = layout_migrate(ctx, layout, old_ctx, old_layout);
+    printf("[Migrate] GameContext %u -> %u bytes: %d copied, %d resized, %d added, %d dropped\n",
+           old_layout->struct_size, layout->struct_size, m.copied, m.resized, m.added, m.dropped);
+
+    // The arena and everything pointing into it move together. If the old
+    // build laid the block out differently, or any of those fields didn't
+    // come across, start a fresh block on the next frame (timeline and loop
+    // start over, world state is kept).
+    bool memory_kept = same_memory;
+    static const char *const MEMORY_FIELDS[] = { "arena", "frame_arena", "replay", "loop_ptr", "profiler" };
+    for (int i = 0; i < (int)(sizeof(MEMORY_FIELDS) / sizeof(MEMORY_FIELDS[0])); i++) {
+        if (!layout_field_kept(old_layout, layout, MEMORY_FIELDS[i])) memory_kept = false;
+    }
+    if (!memory_kept) {
+        // (a retyped Arena/ReplaySystem can't be read back: its block leaks)
+        if (layout_field_kept(old_layout, layout, "arena")) free(ctx->arena.base);
+        if (layout_field_kept(old_layout, layout, "replay")) free(ctx->replay.export_data);
+        memset(&ctx->arena, 0, sizeof(ctx->arena));
+        memset(&ctx->frame_arena, 0, sizeof(ctx->frame_arena));
+        memset(&ctx->replay, 0, sizeof(ctx->replay));
+        ctx->loop_ptr = NULL;
+        ctx->profiler = NULL;
+        if (ctx->initialized) printf("[Migrate] game memory layout changed: timeline and loop reset\n");
+    }
+
+    free(old_ctx);
+    g_ctx = ctx;
+    return ctx;
+}
+
+// ----------------------------------------------------------------------------
+// Saved session (format: SavedStateHeader in game.h)
+// js_save_state() leaves the blob in replay.export_data like an export;
+// JS copies it out and calls js_free_export(). Autosaves pass quiet = 1.
+// ----------------------------------------------------------------------------
+
+EMSCRIPTEN_KEEPALIVE
+int js_save_state(int quiet) {
+    if (!g_ctx || !g_loop) return 0;
+
+    // Timeline section: reuse the export; an empty recording just has none
+    unsigned int recording_size = (unsigned int)export_recording(quiet != 0);
+    unsigned char *recording = g_ctx->replay.export_data;
+    g_ctx->replay.export_data = NULL;
+    g_ctx->replay.export_size = 0;
+
+    LoopStateHeader lh;
+    memset(&lh, 0, sizeof(lh));
+    lh.state = (int)g_loop->state;
+    lh.input_count = g_loop->input_count;
+    lh.playback_index = g_loop->playback_index;
+    lh.input_stride = sizeof(LoopInputFrame);
+    lh.snapshot_size = sizeof(GameSnapshot);
+    lh.keyboard_keys = MAX_KEYBOARD_KEYS;
+    lh.max_inputs = LOOP_MAX_INPUTS;
+    int loop_inputs = g_loop->input_count < LOOP_MAX_INPUTS ? g_loop->input_count : LOOP_MAX_INPUTS;
+
+    SavedStateHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = SAVED_STATE_MAGIC;
+    h.version = SAVED_STATE_VERSION;
+    h.header_size = sizeof(SavedStateHeader);
+    h.layout_offset = h.header_size;
+    h.layout_size = sizeof(ContextLayout);
+    h.context_offset = h.layout_offset + h.layout_size;
+    h.context_size = sizeof(GameContext);
+    h.recording_offset = h.context_offset + h.context_size;
+    h.recording_size = recording_size;
+    h.loop_offset = h.recording_offset + h.recording_size;
+    h.loop_size = sizeof(LoopStateHeader) + (unsigned int)loop_inputs * sizeof(LoopInputFrame)
+                + sizeof(GameSnapshot) + sizeof(int) * MAX_KEYBOARD_KEYS;
+    h.total_size = h.loop_offset + h.loop_size;
+
+    unsigned char *out = (unsigned char*)malloc(h.total_size);
+    if (!out) {
+        printf("[Save] ERROR: Failed to allocate %u bytes\n", h.total_size);
+        free(recording);
+        return 0;
+    }
+
+    memcpy(out, &h, sizeof(h));
+    memcpy(out + h.layout_offset, &GAME_CONTEXT_LAYOUT, sizeof(ContextLayout));
+    memcpy(out + h.context_offset, g_ctx, sizeof(GameContext));
+    if (recording_size) memcpy(out + h.recording_offset, recording, recording_size);
+    free(recording);
+
+    unsigned char *p = out + h.loop_offset;
+    memcpy(p, &lh, sizeof(lh));                                          p += sizeof(lh);
+    memcpy(p, g_loop->inputs, sizeof(LoopInputFrame) * loop_inputs);     p += sizeof(LoopInputFrame) * loop_inputs;
+    memcpy(p, g_loop->start_snapshot, sizeof(GameSnapshot));             p += sizeof(GameSnapshot);
+    memcpy(p, g_loop->keyboard_backup, sizeof(int) * MAX_KEYBOARD_KEYS);
+
+    g_ctx->replay.export_data = out;
+    g_ctx->replay.export_size = (int)h.total_size;
+
+    if (!quiet) printf("[Save] Session saved: frame %d, %d KB\n", g_ctx->replay.current_frame, (int)(h.total_size / 1024));
+    return g_ctx->replay.export_size;
+}
+
+// Loop section is all-or-nothing: a different build keeps its idle recorder
+static bool load_loop_state(const unsigned char *data, unsigned int size) {
+    LoopStateHeader lh;
+    if (size < sizeof(lh)) return false;
+    memcpy(&lh, data, sizeof(lh));
+
+    if (lh.input_stride != sizeof(LoopInputFrame) || lh.snapshot_size != sizeof(GameSnapshot) ||
+        lh.keyboard_keys != MAX_KEYBOARD_KEYS || lh.max_inputs != LOOP_MAX_INPUTS ||
+        lh.input_count < 0 || lh.state < LOOP_IDLE || lh.state > LOOP_PLAYBACK) return false;
+
+    int loop_inputs = lh.input_count < LOOP_MAX_INPUTS ? lh.input_count : LOOP_MAX_INPUTS;
+    unsigned int need = sizeof(lh) + (unsigned int)loop_inputs * sizeof(LoopInputFrame)
+                      + sizeof(GameSnapshot) + sizeof(int) * MAX_KEYBOARD_KEYS;
+    if (size < need || lh.playback_index < 0 || lh.playback_index > loop_inputs) return false;
+
+    const unsigned char *p = data + sizeof(lh);
+    memcpy(g_loop->inputs, p, sizeof(LoopInputFrame) * loop_inputs);     p += sizeof(LoopInputFrame) * loop_inputs;
+    memcpy(g_loop->start_snapshot, p, sizeof(GameSnapshot));             p += sizeof(GameSnapshot);
+    memcpy(g_loop->keyboard_backup, p, sizeof(int) * MAX_KEYBOARD_KEYS);
+
+    g_loop->state = (LoopRecorderState)lh.state;
+    g_loop->input_count = lh.input_count;
+    g_loop->playback_index = lh.playback_index;
+    return true;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int js_load_state(const unsigned char *data, int size) {
+    if (!g_ctx || !g_loop || !data) return 0;
+
+    SavedStateHeader h;
+    if (size < (int)sizeof(h)) return 0;
+    memcpy(&h, data, sizeof(h));
+
+    // Section ends in 64 bits: a crafted offset + size can't wrap past total_size
+    if (h.magic != SAVED_STATE_MAGIC || h.version != SAVED_STATE_VERSION ||
+        h.total_size > (unsigned int)size ||
+        h.layout_size != sizeof(ContextLayout) ||
+        (unsigned long long)h.layout_offset + h.layout_size > h.total_size ||
+        (unsigned long long)h.context_offset + h.context_size > h.total_size ||
+        (unsigned long long)h.recording_offset + h.recording_size > h.total_size ||
+        (unsigned long long)h.loop_offset + h.loop_size > h.total_size) {
+        printf("[Restore] ERROR: Not a saved session or corrupt header\n");
+        return 0;
+    }
+
+    ContextLayout saved_layout;
+    memcpy(&saved_layout, data + h.layout_offset, sizeof(saved_layout));
+    if (!layout_valid(&saved_layout) || saved_layout.struct_size != h.context_size) {
+        printf("[Restore] ERROR: Saved context layout is invalid\n");
+        return 0;
+    }
+
+    GameContext *saved = calloc(1, sizeof(GameContext));
+    if (!saved) return 0;
+    LayoutMigration m = layout_migrate(saved, &GAME_CONTEXT_LAYOUT, data + h.context_offset, &saved_layout);
+
+    // Timeline first: importing loads its start frame into the world, which
+    // the saved context then overwrites
+    bool timeline = h.recording_size > 0 &&
+                    js_import_recording(data + h.recording_offset, (int)h.recording_size) == 1;
+
+    // Host handles, memory and the clock stay with this instance
+    GameContext keep = *g_ctx;
+    *g_ctx = *saved;
+    free(saved);
+
+    g_ctx->renderer = keep.renderer;
+    g_ctx->arena = keep.arena;
+    g_ctx->frame_arena = keep.frame_arena;
+    g_ctx->loop_ptr = keep.loop_ptr;
+    g_ctx->profiler = keep.profiler;
+    g_ctx->last_counter = 0;
+    g_ctx->sim_accumulator = 0.0;
+    memset(g_ctx->keyboard, 0, sizeof(g_ctx->keyboard));
+
+    // Cursor and settings come from the saved replay, buffers from this one
+    ReplaySystem *rp = &g_ctx->replay;
+    ReplaySystem saved_replay = *rp;
+    bool replay_kept = layout_field_kept(&saved_layout, &GAME_CONTEXT_LAYOUT, "replay");
+    *rp = keep.replay;
+    if (timeline && replay_kept) {
+        // The recording ends at current_frame; the world is the display frame
+        if (saved_replay.current_frame >= rp->recorded_end_frame) rp->current_frame = saved_replay.current_frame;
+        rp->display_frame = saved_replay.display_frame;
+        rp->playback_speed = saved_replay.playback_speed;
+        rp->loop_enabled = saved_replay.loop_enabled;
+        rp->mode = saved_replay.mode == MODE_LIVE ? MODE_LIVE : MODE_PAUSED;
+        if (rp->display_frame < rp->recorded_start_frame) rp->display_frame = rp->recorded_start_frame;
+        if (rp->display_frame > rp->recorded_end_frame) rp->display_frame = rp->recorded_end_frame;
+    } else if (timeline) {
+        replay_load_frame(g_ctx, rp->recorded_end_frame);
+        rp->mode = MODE_LIVE;
+    } else {
+        // No usable timeline: keep counting from the saved frame
+        int frame = replay_kept ? saved_replay.current_frame : 0;
+        rp->event_count = 0;
+        rp->current_frame = rp->display_frame = frame;
+        rp->recorded_start_frame = rp->recorded_end_frame = frame;
+        rp->mode = MODE_LIVE;
+    }
+
+    bool loop = h.loop_size > 0 && load_loop_state(data + h.loop_offset, h.loop_size);
+
+    printf("[Restore] Session restored at frame %d: %d copied, %d resized, %d added, %d dropped, timeline %s, loop %s\n",
+           rp->current_frame, m.copied, m.resized, m.added, m.dropped,
+           timeline ? "restored" : "reset", loop ? "restored" : "reset");
+    return 1;
+}
+
 // ----------------------------------------------------------------------------
 // LIVE-CODING ENTRYPOINT
 // ----------------------------------------------------------------------------
 
 EMSCRIPTEN_KEEPALIVE
 void update_and_render(GameContext *ctx) {
-    g_ctx = ctx;
+    if (!memory_init_if_needed(ctx)) return;
+    arena_reset(&ctx->frame_arena);
 
-    replay_init_if_needed(ctx);
-    loop_init_if_needed(ctx);
+    g_ctx = ctx;
 
     // Simple hotreload detector stored in ctx (no globals).
     // Add these fields to GameContext if you want them persistent:
@@ -993,7 +1518,45 @@ void update_and_render(GameContext *ctx) {
         printf("===========================\n");
     }
 
-    handle_events(ctx);
-    update(ctx);
-    render(ctx);
+    PROF_FRAME_BEGIN(ctx->profiler);
+
+    PROF_ZONE(ctx->profiler, "handle_events") {
+        handle_events(ctx);
+    }
+
+    // Fixed-timestep accumulator. The clock lives in ctx so a hot-reload
+    // doesn't produce a giant first delta.
+    Uint64 now = SDL_GetPerformanceCounter();
+    double freq = (double)SDL_GetPerformanceFrequency();
+    if (ctx->last_counter == 0 || now < ctx->last_counter) {
+        ctx->last_counter = now;
+        ctx->sim_accumulator = SIM_DT;
+    }
+    ctx->sim_accumulator += (double)(now - ctx->last_counter) / freq;
+    ctx->last_counter = now;
+
+    int steps;
+    if (ctx->turbo_steps > 1 && ctx->replay.mode == MODE_LIVE) {
+        // Headless fast-forward: as many steps as asked, one render at the end
+        steps = ctx->turbo_steps;
+        ctx->sim_accumulator = 0.0;
+    } else {
+        if (ctx->sim_accumulator > MAX_CATCHUP_STEPS * SIM_DT)
+            ctx->sim_accumulator = MAX_CATCHUP_STEPS * SIM_DT;
+        steps = (int)(ctx->sim_accumulator / SIM_DT);
+        ctx->sim_accumulator -= steps * SIM_DT;
+    }
+
+    PROF_ZONE(ctx->profiler, "update") {
+        for (int i = 0; i < steps; i++) update(ctx);
+    }
+
+    // Nothing advanced (display faster than SIM_DT): keep the last presented frame
+    if (steps > 0) {
+        PROF_ZONE(ctx->profiler, "render") {
+            render(ctx);
+        }
+    }
+
+    PROF_FRAME_END(ctx->profiler);
 }
@@ -4,6 +4,10 @@
 #include <SDL2/SDL.h>
 #include <stdbool.h>
 
+#include "base_arena.h"
+#include "profiler.h"
+#include "context_layout.h"
+
 #define WINDOW_WIDTH   640
 #define WINDOW_HEIGHT  480
 
@@ -16,6 +20,13 @@
 // Simple loop recorder (L key) - 30 seconds at 60fps (~2.5MB)
 #define LOOP_MAX_INPUTS     1800
 
+// Per-frame scratch memory (reset at the top of update_and_render);
+// grows with MAX_ENEMIES for the collision grid (ids + SoA box copies)
+#define FRAME_SCRATCH_SIZE  (256 * 1024 + MAX_ENEMIES * 256)
+
+// Fixed-timestep simulation: live steps per displayed frame in turbo mode are capped
+#define MAX_TURBO_STEPS     1000
+
 // Shooter limits (kept small enough to snapshot each frame)
 #define MAX_BULLETS  64
 #define MAX_ENEMIES  24
@@ -34,20 +45,28 @@ typedef struct {
     int state;
 } InputEvent;
 
+// Entity pools are struct-of-arrays: one array per field, so the integration
+// and overlap kernels (simd_kernels.h) stream contiguous floats. The field
+// lists are X-macros; entity_pool.h generates push/remove/sweep from them.
+#define BULLET_FIELDS(X) \
+    X(float, x) X(float, y) X(float, vx) X(int, w) X(int, h) X(bool, alive)
+
+#define ENEMY_FIELDS(X) \
+    X(float, x) X(float, y) X(float, vx) X(int, r) X(int, hp) X(bool, alive)
+
+#define BULLET_ARRAY(type, name) type name[MAX_BULLETS];
+#define ENEMY_ARRAY(type, name)  type name[MAX_ENEMIES];
+
+// Dense pools: live entities are [0 .. count) in every array
 typedef struct {
-    float x, y;
-    float vx;
-    int w, h;
-    bool alive;
-} Bullet;
+    BULLET_FIELDS(BULLET_ARRAY)
+    int count;
+} Bullets;
 
 typedef struct {
-    float x, y;
-    float vx;
-    int r;
-    int hp;
-    bool alive;
-} Enemy;
+    ENEMY_FIELDS(ENEMY_ARRAY)
+    int count;
+} Enemies;
 
 // Full snapshot of game state for a frame
 typedef struct {
@@ -67,8 +86,9 @@ typedef struct {
     int enemy_spawn_timer;
     float difficulty;
 
-    Bullet bullets[MAX_BULLETS];
-    Enemy  enemies[MAX_ENEMIES];
+    // SoA pools, see entity_pool.h
+    Bullets bullets;
+    Enemies enemies;
 } GameSnapshot;
 
 // Simple loop recorder states (L key feature)
@@ -111,46 +131,160 @@ typedef struct {
     float playback_speed;
     float playback_accumulator;
     bool loop_enabled;
-} ReplaySystem;
 
-typedef struct {
-    SDL_Renderer *renderer;
-
-    // Live-coding friendly: all runtime state is stored here
-    bool initialized;
+    // Last js_export_recording() result, owned here until js_free_export()
+    unsigned char *export_data;
+    int export_size;
+} ReplaySystem;
 
-    // Input
-    int keyboard[MAX_KEYBOARD_KEYS];
+// ----------------------------------------------------------------------------
+// Recording file format (js_export_recording / js_import_recording)
+//
+//   [RecordingHeader][keyframes: GameSnapshot x keyframe_count][InputEvent x event_count]
+//
+// Little-endian, fixed-stride sections, no compression. Keyframe for frame N
+// lives at keyframe_offset + (N - start_frame) * keyframe_stride, so a reader
+// can mmap the file or issue a single ranged read to seek.
+// ----------------------------------------------------------------------------
 
-    // Shooter world
-    unsigned int rng_state;
+#define RECORDING_MAGIC    0x43455247u  // "GREC"
+#define RECORDING_VERSION  3   // 2: dense pool counts, 3: SoA entity pools
 
-    float player_x, player_y;
-    int player_w, player_h;
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int header_size;       // sizeof(RecordingHeader)
+    unsigned int keyframe_stride;   // sizeof(GameSnapshot)
+    unsigned int event_stride;      // sizeof(InputEvent)
+
+    int start_frame;
+    int end_frame;
+    int keyframe_count;             // end_frame - start_frame + 1
+    int event_count;
 
-    int score;
-    int lives;
-    bool game_over;
+    unsigned int keyframe_offset;
+    unsigned int event_offset;
+    unsigned int total_size;
 
-    int shoot_cooldown;
-    int enemy_spawn_timer;
-    float difficulty;
+    // Layout guard: a build with different entity limits can't reuse keyframes
+    int max_bullets;
+    int max_enemies;
 
-    Bullet bullets[MAX_BULLETS];
-    Enemy  enemies[MAX_ENEMIES];
+    unsigned int reserved[2];
+} RecordingHeader;
 
-    // simple juice
-    float shake;
-    float flash;
+// ----------------------------------------------------------------------------
+// Saved session (js_save_state / js_load_state)
+//
+//   [SavedStateHeader][ContextLayout][GameContext bytes]
+//   [recording (format above), optional][LoopStateHeader + loop data, optional]
+//
+// Everything a full rebuild or page reload would otherwise throw away. The
+// editor keeps the blob in IndexedDB and hands it to the next instance. The
+// context goes through layout_migrate() (context_layout.h), so a build with
+// added/removed fields still restores; pointers in it are never read back.
+// ----------------------------------------------------------------------------
 
-    // timeline
-    ReplaySystem replay;
+#define SAVED_STATE_MAGIC    0x56415347u  // "GSAV"
+#define SAVED_STATE_VERSION  1
 
-    // Loop recorder pointer (persists across hot-reloads)
-    void *loop_ptr;
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int header_size;       // sizeof(SavedStateHeader)
+    unsigned int total_size;
+
+    // Sections, offsets from the start of the blob (size 0: absent)
+    unsigned int layout_offset, layout_size;
+    unsigned int context_offset, context_size;
+    unsigned int recording_offset, recording_size;
+    unsigned int loop_offset, loop_size;
+} SavedStateHeader;
+
+// Loop recorder section: header, then min(input_count, max_inputs) input
+// frames, the start snapshot and the keyboard backup
+typedef struct {
+    int state;
+    int input_count;
+    int playback_index;
+
+    // Layout guard: restored only into a build with the same strides
+    unsigned int input_stride;      // sizeof(LoopInputFrame)
+    unsigned int snapshot_size;     // sizeof(GameSnapshot)
+    unsigned int keyboard_keys;     // MAX_KEYBOARD_KEYS
+    unsigned int max_inputs;        // LOOP_MAX_INPUTS
+} LoopStateHeader;
+
+// ----------------------------------------------------------------------------
+// GameContext
+//
+// Declared through a field list so the same list also generates the layout
+// descriptor (context_layout.h) that lets a hot-reload migrate the state when
+// fields are added, removed or reordered. Add fields here:
+//   FIELD(type, name)           scalar or struct
+//   ARRAY(type, name, count)    fixed array (resizing keeps the common prefix)
+// Pointer types go through a typedef (one token), see below.
+// ----------------------------------------------------------------------------
+
+typedef SDL_Renderer *RendererPtr;
+typedef Profiler     *ProfilerPtr;
+typedef void         *OpaquePtr;
+
+#define GAME_CONTEXT_FIELDS(FIELD, ARRAY) \
+    FIELD(RendererPtr, renderer) \
+    \
+    /* Live-coding friendly: all runtime state is stored here */ \
+    FIELD(bool, initialized) \
+    \
+    /* Input */ \
+    ARRAY(int, keyboard, MAX_KEYBOARD_KEYS) \
+    \
+    /* Shooter world */ \
+    FIELD(unsigned int, rng_state) \
+    FIELD(float, player_x) FIELD(float, player_y) \
+    FIELD(int, player_w) FIELD(int, player_h) \
+    FIELD(int, score) \
+    FIELD(int, lives) \
+    FIELD(bool, game_over) \
+    FIELD(int, shoot_cooldown) \
+    FIELD(int, enemy_spawn_timer) \
+    FIELD(float, difficulty) \
+    \
+    /* SoA pools, see entity_pool.h */ \
+    FIELD(Bullets, bullets) \
+    FIELD(Enemies, enemies) \
+    \
+    /* simple juice; fx_rng_state is render-only, keeps sim rng independent of frame rate */ \
+    FIELD(float, shake) \
+    FIELD(float, flash) \
+    FIELD(unsigned int, fx_rng_state) \
+    \
+    /* fixed-timestep clock (decoupled from requestAnimationFrame); turbo_steps >1: */ \
+    /* run this many live steps per displayed frame */ \
+    FIELD(Uint64, last_counter) \
+    FIELD(double, sim_accumulator) \
+    FIELD(int, turbo_steps) \
+    \
+    /* timeline */ \
+    FIELD(ReplaySystem, replay) \
+    \
+    /* Game memory: every buffer the game owns lives in this one block. */ \
+    /* arena.base == NULL until first run; frame_arena is scratch, reset each frame */ \
+    FIELD(Arena, arena) \
+    FIELD(Arena, frame_arena) \
+    \
+    /* Loop recorder and frame profiler (point into arena, persist across hot-reloads) */ \
+    FIELD(OpaquePtr, loop_ptr) \
+    FIELD(ProfilerPtr, profiler) \
+    \
+    /* debug/console ticker */ \
+    FIELD(int, console_tick)
+
+#define GAME_CONTEXT_DECLARE_FIELD(type, name)         type name;
+#define GAME_CONTEXT_DECLARE_ARRAY(type, name, count)  type name[count];
 
-    // debug/console ticker
-    int console_tick;
+typedef struct {
+    GAME_CONTEXT_FIELDS(GAME_CONTEXT_DECLARE_FIELD, GAME_CONTEXT_DECLARE_ARRAY)
 } GameContext;
 
 #endif
@@ -0,0 +1,226 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// ----------------------------------------------------------------------------
+// Scoped frame profiler
+//
+//   PROF_FRAME_BEGIN(p);
+//   PROF_BEGIN(p, "update");  ...  PROF_END(p);
+//   PROF_ZONE(p, "render") { ... }          // begin/end around a block
+//                                           // (no return/break out of it)
+//   PROF_FRAME_END(p);
+//
+// Each frame's zones (name, depth, start, duration) go into a ring of the
+// last PROF_FRAMES frames; prof_collect() flattens every frame newer than a
+// given frame number into floats for the editor's flame chart.
+//
+// Cost: with GAME_PROFILER=0 the macros compile to nothing. Compiled in but
+// switched off (the default until the Profiler panel asks), every marker is
+// one branch on `enabled`.
+//
+// Zone names are interned by value into the profiler (string literals live in
+// the side module and move on every hot-reload). Names past
+// PROF_MAX_NAMES - 1 share one "(other)" id. Zones past PROF_MAX_ZONES in
+// one frame (e.g. turbo) are counted, not stored.
+//
+// Header-only, no globals (hot-reload safe).
+// ----------------------------------------------------------------------------
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "base_arena.h"
+
+#ifndef GAME_PROFILER
+#define GAME_PROFILER 1
+#endif
+
+#define PROF_FRAMES      128
+#define PROF_MAX_ZONES   64     // per frame
+#define PROF_MAX_DEPTH   16
+#define PROF_MAX_NAMES   32
+#define PROF_NAME_LEN    24
+#define PROF_OTHER_NAME  "(other)"   // zones named after the table filled up
+
+// prof_collect() layout, all floats:
+//   per frame: [frame, total_us, zone_count, dropped] then zone_count x
+//              [name_id, depth, start_us, duration_us]
+#define PROF_FRAME_HEADER_FLOATS  4
+#define PROF_ZONE_FLOATS          4
+#define PROF_EXPORT_FLOATS \
+    (PROF_FRAMES * (PROF_FRAME_HEADER_FLOATS + PROF_MAX_ZONES * PROF_ZONE_FLOATS))
+
+typedef struct {
+    Uint16 name;
+    Uint16 depth;
+    float start_us;              // from frame begin
+    float duration_us;
+} ProfZone;
+
+typedef struct {
+    int frame;
+    float total_us;
+    int zone_count;
+    int dropped;
+    ProfZone zones[PROF_MAX_ZONES];
+} ProfFrame;
+
+typedef struct {
+    bool enabled;
+    bool in_frame;
+    int frame_counter;
+    int head;                    // ring slot of the frame being written
+    int filled;                  // completed frames in the ring
+
+    Uint64 frame_start;
+    double us_per_tick;
+
+    int stack[PROF_MAX_DEPTH];   // open zone indices (-1: dropped)
+    int depth;
+    int overflow;                // begins past PROF_MAX_DEPTH, matched by ends
+
+    char names[PROF_MAX_NAMES][PROF_NAME_LEN];
+    int name_count;
+    char name_list[PROF_MAX_NAMES * PROF_NAME_LEN];   // '\n'-joined, for JS
+
+    ProfFrame frames[PROF_FRAMES];
+    float export_buf[PROF_EXPORT_FLOATS];
+} Profiler;
+
+static inline Profiler *prof_create(Arena *arena) {
+    Profiler *p = arena_push_struct(arena, Profiler);
+    if (p) p->us_per_tick = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+    return p;
+}
+
+static inline float prof_now_us(const Profiler *p) {
+    return (float)((double)(SDL_GetPerformanceCounter() - p->frame_start) * p->us_per_tick);
+}
+
+// Once the table is down to its last slot, every new name goes there as
+// PROF_OTHER_NAME, so overflow time is lumped together, not misattributed
+static inline int prof_intern(Profiler *p, const char *name) {
+    for (int i = 0; i < p->name_count; i++) {
+        if (strncmp(p->names[i], name, PROF_NAME_LEN - 1) == 0) return i;
+    }
+    if (p->name_count == PROF_MAX_NAMES) return PROF_MAX_NAMES - 1;   // PROF_OTHER_NAME
+    if (p->name_count == PROF_MAX_NAMES - 1) name = PROF_OTHER_NAME;
+
+    int id = p->name_count++;
+    strncpy(p->names[id], name, PROF_NAME_LEN - 1);
+
+    // rebuild the joined list (rare: once per new zone name)
+    size_t len = 0;
+    for (int i = 0; i < p->name_count; i++) {
+        size_t n = strlen(p->names[i]);
+        memcpy(p->name_list + len, p->names[i], n);
+        len += n;
+        p->name_list[len++] = '\n';
+    }
+    p->name_list[len ? len - 1 : 0] = '\0';
+    return id;
+}
+
+static inline void prof_frame_begin(Profiler *p) {
+    if (!p || !p->enabled) return;
+    ProfFrame *f = &p->frames[p->head];
+    f->frame = p->frame_counter;
+    f->zone_count = 0;
+    f->dropped = 0;
+    f->total_us = 0.0f;
+    p->depth = 0;
+    p->overflow = 0;
+    p->in_frame = true;
+    p->frame_start = SDL_GetPerformanceCounter();
+}
+
+static inline void prof_frame_end(Profiler *p) {
+    if (!p || !p->enabled || !p->in_frame) return;
+    ProfFrame *f = &p->frames[p->head];
+    f->total_us = prof_now_us(p);
+    p->in_frame = false;
+    p->frame_counter++;
+    p->head = (p->head + 1) % PROF_FRAMES;
+    if (p->filled < PROF_FRAMES) p->filled++;
+}
+
+static inline void prof_begin(Profiler *p, const char *name) {
+    if (!p || !p->enabled || !p->in_frame) return;
+    if (p->depth == PROF_MAX_DEPTH) { p->overflow++; return; }
+
+    ProfFrame *f = &p->frames[p->head];
+    int slot = -1;
+    if (f->zone_count < PROF_MAX_ZONES) {
+        slot = f->zone_count++;
+        ProfZone *z = &f->zones[slot];
+        z->name = (Uint16)prof_intern(p, name);
+        z->depth = (Uint16)p->depth;
+        z->duration_us = 0.0f;
+        z->start_us = prof_now_us(p);
+    } else {
+        f->dropped++;
+    }
+    p->stack[p->depth++] = slot;
+}
+
+static inline void prof_end(Profiler *p) {
+    if (!p || !p->enabled || !p->in_frame || p->depth == 0) return;
+    if (p->overflow) { p->overflow--; return; }
+    int slot = p->stack[--p->depth];
+    if (slot < 0) return;
+    ProfZone *z = &p->frames[p->head].zones[slot];
+    z->duration_us = prof_now_us(p) - z->start_us;
+}
+
+// Turning the profiler on/off mid-frame abandons the frame in flight
+static inline void prof_set_enabled(Profiler *p, bool enabled) {
+    if (!p) return;
+    p->enabled = enabled;
+    p->in_frame = false;
+    p->depth = 0;
+    p->overflow = 0;
+}
+
+// Flattens every completed frame with frame > after_frame, oldest first.
+// Returns the number of floats written to p->export_buf.
+static inline int prof_collect(Profiler *p, int after_frame) {
+    if (!p) return 0;
+    int written = 0;
+    for (int i = p->filled; i > 0; i--) {
+        const ProfFrame *f = &p->frames[(p->head - i + PROF_FRAMES) % PROF_FRAMES];
+        if (f->frame <= after_frame) continue;
+
+        float *out = p->export_buf + written;
+        out[0] = (float)f->frame;
+        out[1] = f->total_us;
+        out[2] = (float)f->zone_count;
+        out[3] = (float)f->dropped;
+        out += PROF_FRAME_HEADER_FLOATS;
+        for (int z = 0; z < f->zone_count; z++, out += PROF_ZONE_FLOATS) {
+            out[0] = (float)f->zones[z].name;
+            out[1] = (float)f->zones[z].depth;
+            out[2] = f->zones[z].start_us;
+            out[3] = f->zones[z].duration_us;
+        }
+        written += PROF_FRAME_HEADER_FLOATS + f->zone_count * PROF_ZONE_FLOATS;
+    }
+    return written;
+}
+
+#if GAME_PROFILER
+#define PROF_FRAME_BEGIN(p)   prof_frame_begin(p)
+#define PROF_FRAME_END(p)     prof_frame_end(p)
+#define PROF_BEGIN(p, name)   prof_begin((p), (name))
+#define PROF_END(p)           prof_end(p)
+#define PROF_ZONE(p, name) \
+    for (int prof_once_ = (prof_begin((p), (name)), 1); prof_once_; prof_once_ = 0, prof_end(p))
+#else
+#define PROF_FRAME_BEGIN(p)   ((void)0)
+#define PROF_FRAME_END(p)     ((void)0)
+#define PROF_BEGIN(p, name)   ((void)0)
+#define PROF_END(p)           ((void)0)
+#define PROF_ZONE(p, name)
+#endif
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+// ----------------------------------------------------------------------------
+// Batch kernels over SoA float arrays
+//
+// Backend is picked at build time: with -msimd128 (the simd_game profile in
+// build_config.json) clang defines __wasm_simd128__ and the kernels use wasm
+// SIMD 4-wide; every other build (debug_game, the native headless host) gets
+// the scalar loops. Both backends do the same IEEE single-precision ops per
+// element (no FMA, no reassociation), so results are bit-identical and a
+// recording made with one replays on the other.
+//
+// Arrays need no particular alignment (wasm v128 loads are unaligned).
+//
+// Header-only, no globals (hot-reload safe).
+// ----------------------------------------------------------------------------
+
+#include <stdbool.h>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define SIMD_KERNELS_WASM 1
+#define SIMD_KERNELS_BACKEND "wasm-simd128"
+#else
+#define SIMD_KERNELS_WASM 0
+#define SIMD_KERNELS_BACKEND "scalar"
+#endif
+
+// dst[i] += src[i]
+static inline void k_add(float *dst, const float *src, int n) {
+    int i = 0;
+#if SIMD_KERNELS_WASM
+    for (; i + 4 <= n; i += 4) {
+        v128_t d = wasm_v128_load(dst + i);
+        v128_t s = wasm_v128_load(src + i);
+        wasm_v128_store(dst + i, wasm_f32x4_add(d, s));
+    }
+#endif
+    for (; i < n; i++) dst[i] += src[i];
+}
+
+// v[i] = clamp(v[i], lo, hi), same select order as clampf()
+static inline void k_clamp(float *v, float lo, float hi, int n) {
+    int i = 0;
+#if SIMD_KERNELS_WASM
+    v128_t vlo = wasm_f32x4_splat(lo);
+    v128_t vhi = wasm_f32x4_splat(hi);
+    for (; i + 4 <= n; i += 4) {
+        v128_t x = wasm_v128_load(v + i);
+        x = wasm_v128_bitselect(vhi, x, wasm_f32x4_gt(x, vhi));
+        x = wasm_v128_bitselect(vlo, x, wasm_f32x4_lt(x, vlo));
+        wasm_v128_store(v + i, x);
+    }
+#endif
+    for (; i < n; i++) v[i] = v[i] < lo ? lo : (v[i] > hi ? hi : v[i]);
+}
+
+static inline void k_fill(float *v, float value, int n) {
+    int i = 0;
+#if SIMD_KERNELS_WASM
+    v128_t x = wasm_f32x4_splat(value);
+    for (; i + 4 <= n; i += 4) wasm_v128_store(v + i, x);
+#endif
+    for (; i < n; i++) v[i] = value;
+}
+
+// First i in [start, n) with v[i] > limit, or n
+static inline int k_find_gt(const float *v, float limit, int start, int n) {
+    int i = start;
+#if SIMD_KERNELS_WASM
+    v128_t lim = wasm_f32x4_splat(limit);
+    for (; i + 4 <= n; i += 4) {
+        int bits = wasm_i32x4_bitmask(wasm_f32x4_gt(wasm_v128_load(v + i), lim));
+        if (bits) return i + __builtin_ctz(bits);
+    }
+#endif
+    for (; i < n; i++) if (v[i] > limit) return i;
+    return n;
+}
+
+// First i in [start, n) with v[i] < limit, or n
+static inline int k_find_lt(const float *v, float limit, int start, int n) {
+    int i = start;
+#if SIMD_KERNELS_WASM
+    v128_t lim = wasm_f32x4_splat(limit);
+    for (; i + 4 <= n; i += 4) {
+        int bits = wasm_i32x4_bitmask(wasm_f32x4_lt(wasm_v128_load(v + i), lim));
+        if (bits) return i + __builtin_ctz(bits);
+    }
+#endif
+    for (; i < n; i++) if (v[i] < limit) return i;
+    return n;
+}
+
+// First i in [start, n) whose box (bx, by, bw, bh)[i] overlaps the query box,
+// or n: ax < bx + bw && ax + aw > bx && ay < by + bh && ay + ah > by
+static inline int k_aabb_first_overlap(float qx, float qy, float qw, float qh,
+                                       const float *bx, const float *by,
+                                       const float *bw, const float *bh,
+                                       int start, int n) {
+    int i = start;
+#if SIMD_KERNELS_WASM
+    v128_t ax = wasm_f32x4_splat(qx);
+    v128_t ay = wasm_f32x4_splat(qy);
+    v128_t ax1 = wasm_f32x4_splat(qx + qw);
+    v128_t ay1 = wasm_f32x4_splat(qy + qh);
+    for (; i + 4 <= n; i += 4) {
+        v128_t x = wasm_v128_load(bx + i);
+        v128_t y = wasm_v128_load(by + i);
+        v128_t x1 = wasm_f32x4_add(x, wasm_v128_load(bw + i));
+        v128_t y1 = wasm_f32x4_add(y, wasm_v128_load(bh + i));
+        v128_t hit = wasm_v128_and(wasm_v128_and(wasm_f32x4_lt(ax, x1), wasm_f32x4_gt(ax1, x)),
+                                   wasm_v128_and(wasm_f32x4_lt(ay, y1), wasm_f32x4_gt(ay1, y)));
+        int bits = wasm_i32x4_bitmask(hit);
+        if (bits) return i + __builtin_ctz(bits);
+    }
+#endif
+    for (; i < n; i++) {
+        if (qx < bx[i] + bw[i] && qx + qw > bx[i] && qy < by[i] + bh[i] && qy + qh > by[i]) return i;
+    }
+    return n;
+}
+
+#endif
@@ -13,6 +13,10 @@ static update_and_render_fn update_and_render = NULL;
 EMSCRIPTEN_KEEPALIVE
 void set_update_and_render_func(update_and_render_fn f) { update_and_render = f; }
 
+// reload.js swaps the context when a new game.wasm migrates it to a new layout
+EMSCRIPTEN_KEEPALIVE GameContext *get_game_context(void)   { return ctx; }
+EMSCRIPTEN_KEEPALIVE void set_game_context(GameContext *c) { ctx = c; }
+
 static void main_loop(void)
 {
     if (update_and_render) update_and_render(ctx);
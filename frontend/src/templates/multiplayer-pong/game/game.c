@@ -1,7 +1,9 @@
 #include <emscripten.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_net.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "game.h"
 
@@ -12,6 +14,21 @@ static const int PADDLE_SPEED = 5;
 static const int GOAL_DELAY_FRAMES = 60;
 static const int DASH_SPEED = 1;
 
+// Game server (KTH Cloud backend)
+static const char *NET_HOST = "gcee-backend.app.cloud.cbh.kth.se";
+static const int NET_PORT = 443;
+
+// The session advances in fixed ticks whatever the display refresh rate, so
+// peers on 60 and 144 Hz screens step at the same pace (and the ball moves at
+// the same speed); after a stalled tab, drop time instead of spiralling
+static const double TICK_DT = 1.0 / 60.0;
+static const int MAX_CATCHUP_TICKS = 5;
+
+// Time sync: when we're this many frames further ahead than the peer, skip
+// a tick every SYNC_INTERVAL frames so the peer can catch up
+static const int SYNC_MIN_ADVANTAGE = 2;
+static const int SYNC_INTERVAL = 8;
+
 static const SDL_Color COLOR_BG = {20, 0, 0, 255};
 static const SDL_Color COLOR_PADDLE_LEFT = {255, 255, 255, 255};
 static const SDL_Color COLOR_PADDLE_RIGHT = {0, 255, 255, 255};
@@ -25,22 +42,271 @@ static inline void set_color(SDL_Renderer *r, SDL_Color c) {
     SDL_SetRenderDrawColor(r, c.r, c.g, c.b, c.a);
 }
 
+typedef enum {
+    PACKET_HELLO = 1,     // lobby: matchId, round, ready
+    PACKET_INPUT          // session: matchId, round, advantage, ack frame, encoded inputs
+} PacketType;
+
+// Every packet starts with this; the payload follows immediately. Packets
+// arrive as a byte stream (TCP), so one read may hold part of a packet or
+// several of them.
 typedef struct {
-    Uint32 matchId;
-    Sint16 paddleY;
-    Sint16 ballX, ballY;
-    Sint16 velX, velY;
-    Uint8 ready;
-    Uint8 state;
-    Uint8 score1, score2;
-} GamePacket;
+    Uint16 magic;         // NET_MAGIC, resync point after garbage
+    Uint8  type;          // PacketType
+    Uint8  length;        // payload bytes
+    Uint16 seq;           // sender's packet counter
+    Uint16 ack;           // newest seq the sender has received from us
+} NetHeader;
+
+// Server-authoritative mode, backend/authority.js (binary, little-endian):
+//   input     [AUTH_INPUT][u8 buttons][i16 touchY, -1: none]
+//   snapshot  [AUTH_SNAPSHOT][u8 state][u32 frame][i16 paddle0][i16 paddle1]
+//             [i16 ballX][i16 ballY][i8 velX][i8 velY][u8 score0][u8 score1][u16 reserved]
+// Control messages go out as AUTH_TAG_CONTROL + JSON; the server's JSON
+// replies arrive as text in the same byte stream, one object each.
+#define AUTH_TAG_CONTROL    0x01
+#define AUTH_INPUT          0x49    // 'I'
+#define AUTH_SNAPSHOT       0x53    // 'S'
+#define AUTH_SNAPSHOT_SIZE  20
+#define AUTH_MAX_JSON       512
+
+// Input encoding: one byte per frame, the buttons plus a flag when touchY
+// differs from the previous frame's, then the new touchY
+#define INPUT_TOUCH_CHANGED 0x80
+
+// Rollback corrections: drawn positions close this fraction of the gap per
+// frame instead of jumping (normal motion is followed exactly)
+static const float CORRECTION_BLEND = 0.35f;
+
+// ----------------------------------------------------------------------------
+// Deterministic simulation: only PongState + both inputs, no clocks, no rand()
+// ----------------------------------------------------------------------------
+
+static Uint32 xorshift32(Uint32 *state) {
+    Uint32 x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void reset_ball(PongState *s) {
+    s->ballX = (WINDOW_WIDTH - BALL_SIZE) / 2;
+    s->ballY = (WINDOW_HEIGHT - BALL_SIZE) / 2;
+    s->ballVelX = s->ballVelY = 0;
+}
+
+static void serve_ball(PongState *s) {
+    s->state = GAME_PLAYING;
+    s->ballVelX = (xorshift32(&s->rng) & 1) ? BALL_SPEED_X : -BALL_SPEED_X;
+    s->ballVelY = (xorshift32(&s->rng) & 1) ? BALL_SPEED_Y : -BALL_SPEED_Y;
+}
+
+static void sim_reset(PongState *s, Uint32 seed) {
+    memset(s, 0, sizeof *s);
+    s->paddleY[0] = s->paddleY[1] = (WINDOW_HEIGHT - PADDLE_HEIGHT) / 2;
+    s->rng = seed ? seed : 1;
+    reset_ball(s);
+    serve_ball(s);
+}
+
+static void register_goal(PongState *s, bool leftPlayerScored) {
+    s->score[leftPlayerScored ? 0 : 1]++;
+    reset_ball(s);
+
+    if (s->score[0] == MAX_SCORE || s->score[1] == MAX_SCORE) {
+        s->state = GAME_VICTORY;
+        s->victoryFrame = s->frame;
+    } else {
+        s->state = GAME_SCORE;
+        s->scoreDelayFrames = GOAL_DELAY_FRAMES;
+    }
+}
+
+static void apply_input(int *paddleY, const PongInput *in) {
+    if (in->touchY >= 0) *paddleY = in->touchY;
+    else *paddleY += (((in->buttons & INPUT_DOWN) != 0) - ((in->buttons & INPUT_UP) != 0)) * PADDLE_SPEED;
+
+    if (*paddleY < 0) *paddleY = 0;
+    if (*paddleY > WINDOW_HEIGHT - PADDLE_HEIGHT) *paddleY = WINDOW_HEIGHT - PADDLE_HEIGHT;
+}
+
+static void sim_step(PongState *s, const PongInput in[2]) {
+    if (s->state != GAME_VICTORY) {
+        apply_input(&s->paddleY[0], &in[0]);
+        apply_input(&s->paddleY[1], &in[1]);
+    }
+
+    if (s->state == GAME_PLAYING) {
+        s->ballX += s->ballVelX;
+        s->ballY += s->ballVelY;
+
+        if (s->ballY <= 0 || s->ballY + BALL_SIZE >= WINDOW_HEIGHT)
+            s->ballVelY = (s->ballVelY > 0) ? -BALL_SPEED_Y : BALL_SPEED_Y;
+
+        SDL_Rect p1 = {20, s->paddleY[0], PADDLE_WIDTH, PADDLE_HEIGHT};
+        SDL_Rect p2 = {WINDOW_WIDTH - 20 - PADDLE_WIDTH, s->paddleY[1], PADDLE_WIDTH, PADDLE_HEIGHT};
+        SDL_Rect b = {s->ballX, s->ballY, BALL_SIZE, BALL_SIZE};
+
+        if (SDL_HasIntersection(&b, &p1) && s->ballVelX < 0) s->ballVelX = BALL_SPEED_X;
+        if (SDL_HasIntersection(&b, &p2) && s->ballVelX > 0) s->ballVelX = -BALL_SPEED_X;
+
+        if (s->ballX < -BALL_SIZE) register_goal(s, false);
+        else if (s->ballX > WINDOW_WIDTH) register_goal(s, true);
+
+    } else if (s->state == GAME_SCORE) {
+        if (--s->scoreDelayFrames <= 0) serve_ball(s);
+    }
+
+    s->frame++;
+}
+
+// ----------------------------------------------------------------------------
+// Rollback session
+// ----------------------------------------------------------------------------
+
+static int local_paddle(const GameContext *ctx) { return ctx->playerType == 2 ? 1 : 0; }
+
+static bool inputs_equal(const PongInput *a, const PongInput *b) {
+    return a->buttons == b->buttons && a->touchY == b->touchY;
+}
+
+static PongInput read_local_input(const GameContext *ctx) {
+    PongInput in = {0, 0, -1};
+    if (ctx->keyUpHeld) in.buttons |= INPUT_UP;
+    if (ctx->keyDownHeld) in.buttons |= INPUT_DOWN;
+    if (ctx->touchActive) in.touchY = (Sint16)ctx->touchY;
+    return in;
+}
+
+static void session_start(GameContext *ctx) {
+    // Both peers derive the same seed: the serve direction needs no packet
+    Uint32 seed = (ctx->connected ? (ctx->matchId ^ ctx->remoteMatchId) : ctx->matchId) ^ ((ctx->round + 1) * 0x9E3779B9u);
+    sim_reset(&ctx->sim, seed);
+
+    memset(ctx->history, 0, sizeof ctx->history);
+    memset(ctx->localInputs, 0, sizeof ctx->localInputs);
+    memset(ctx->remoteInputs, 0, sizeof ctx->remoteInputs);
+    memset(ctx->remoteUsed, 0, sizeof ctx->remoteUsed);
+    ctx->remoteFrame = -1;
+    ctx->lastRemote = (PongInput){0, 0, -1};
+    ctx->rollbackFrom = -1;
+    ctx->remoteAdvantage = 0;
+    ctx->localAcked = -1;
+    ctx->rollbacks = ctx->resimFrames = ctx->maxRollback = ctx->stallFrames = 0;
+    ctx->bytesSent = ctx->packetsSent = 0;
+
+    ctx->round++;
+    ctx->state = GAME_PLAYING;
+    printf("[Net] round %d started (%s, seed %08x)\n", ctx->round,
+           ctx->connected ? (ctx->playerType == 1 ? "left paddle" : "right paddle") : "solo", seed);
+}
+
+static void net_send_inputs(GameContext *ctx);
+
+static void session_end(GameContext *ctx) {
+    // The peer may still need our input for the winning frame
+    if (ctx->connected) net_send_inputs(ctx);
+
+    printf("[Net] round %d over %d-%d at frame %d: %d rollbacks, %d frames re-simulated (max depth %d), %d stalls\n",
+           ctx->round, ctx->sim.score[0], ctx->sim.score[1], ctx->sim.frame,
+           ctx->rollbacks, ctx->resimFrames, ctx->maxRollback, ctx->stallFrames);
+    if (ctx->connected && ctx->sim.frame > 0)
+        printf("[Net] sent %d packets, %d bytes (%.1f bytes/frame), rtt %.1f frames\n",
+               ctx->packetsSent, ctx->bytesSent, (float)ctx->bytesSent / ctx->sim.frame, ctx->rtt);
+    ctx->state = GAME_WAITING;
+    ctx->localReady = ctx->remoteReady = false;
+}
+
+// Simulates frame sim.frame with the local input and the known or predicted
+// remote input, keeping the start state for a later rollback
+static void session_step(GameContext *ctx) {
+    int f = ctx->sim.frame;
+    PongInput remote = (f <= ctx->remoteFrame) ? ctx->remoteInputs[f % INPUT_RING] : ctx->lastRemote;
+    ctx->remoteUsed[f % INPUT_RING] = remote;
+
+    PongInput in[2];
+    in[local_paddle(ctx)] = ctx->localInputs[f % INPUT_RING];
+    in[1 - local_paddle(ctx)] = remote;
+
+    ctx->history[f % ROLLBACK_FRAMES] = ctx->sim;
+    sim_step(&ctx->sim, in);
+}
+
+static void session_rollback(GameContext *ctx) {
+    int from = ctx->rollbackFrom;
+    ctx->rollbackFrom = -1;
+    if (from < 0 || from >= ctx->sim.frame) return;
+
+    const PongState *start = &ctx->history[from % ROLLBACK_FRAMES];
+    if (start->frame != from) {
+        printf("[Net] ERROR: no state for frame %d (at %d), can't roll back\n", from, ctx->sim.frame);
+        return;
+    }
+
+    int to = ctx->sim.frame;
+    ctx->sim = *start;
+    while (ctx->sim.frame < to) session_step(ctx);
+
+    ctx->rollbacks++;
+    ctx->resimFrames += to - from;
+    if (to - from > ctx->maxRollback) ctx->maxRollback = to - from;
+}
+
+// ----------------------------------------------------------------------------
+// Networking
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    Uint8 *data;
+    int len, cap;
+} NetWriter;
+
+typedef struct {
+    const Uint8 *data;
+    int len, pos;
+    bool overflow;
+} NetReader;
+
+static void put8(NetWriter *w, Uint8 v) { if (w->len < w->cap) w->data[w->len] = v; w->len++; }
+static void put16(NetWriter *w, Uint16 v) { put8(w, (Uint8)v); put8(w, (Uint8)(v >> 8)); }
+static void put32(NetWriter *w, Uint32 v) { put16(w, (Uint16)v); put16(w, (Uint16)(v >> 16)); }
+
+static Uint8 get8(NetReader *r) {
+    if (r->pos >= r->len) { r->overflow = true; return 0; }
+    return r->data[r->pos++];
+}
+static Uint16 get16(NetReader *r) { Uint16 lo = get8(r); return (Uint16)(lo | (get8(r) << 8)); }
+static Uint32 get32(NetReader *r) { Uint32 lo = get16(r); return lo | ((Uint32)get16(r) << 16); }
+
+static void net_reset(GameContext *ctx) {
+    ctx->recvLen = 0;
+    ctx->sendSeq = ctx->remoteSeq = ctx->ackedSeq = 0;
+    ctx->netTick = 0;
+    ctx->localAcked = -1;
+    ctx->sentReady = false;
+    ctx->rtt = 0;
+}
+
+// Which game server queue the next connection is for. Only the browser
+// build has a socket URL (WEBSOCKET_URL); ?match= lets a multi-process server
+// hand the socket to the worker with a player waiting in that queue.
+static void net_select_queue(const GameContext *ctx) {
+    char script[256];
+    snprintf(script, sizeof script,
+             "if (Module.websocket) Module.websocket.url = '%s://%s:%d/?match=%s';",
+             NET_PORT == 443 ? "wss" : "ws", NET_HOST, NET_PORT,
+             ctx->authoritative ? "quick-auth" : "binary");
+    emscripten_run_script(script);
+}
 
 static void net_try_connect(GameContext *ctx) {
     if (ctx->connected) return;
 
     IPaddress ip;
-    // Connect to KTH Cloud backend
-    if (SDLNet_ResolveHost(&ip, "gcee-backend.app.cloud.cbh.kth.se", 443) != 0) return;
+    if (SDLNet_ResolveHost(&ip, NET_HOST, NET_PORT) != 0) return;
+    net_select_queue(ctx);
 
     ctx->socket = SDLNet_TCP_Open(&ip);
     if (!ctx->socket) return;
@@ -48,64 +314,368 @@ static void net_try_connect(GameContext *ctx) {
     ctx->socketSet = SDLNet_AllocSocketSet(1);
     SDLNet_AddSocket(ctx->socketSet, (SDLNet_GenericSocket)ctx->socket);
     ctx->connected = true;
+    ctx->remoteMatchId = 0;
+    ctx->playerType = 0;
+    net_reset(ctx);
 
     if (!ctx->matchId)
         ctx->matchId = ((unsigned)rand() << 16) ^ rand();
 }
 
-static void net_exchange(GameContext *ctx) {
-    if (!ctx->connected) return;
+static void net_disconnect(GameContext *ctx) {
+    SDLNet_TCP_Close(ctx->socket);
+    SDLNet_FreeSocketSet(ctx->socketSet);
+    ctx->connected = false;
+    ctx->state = GAME_DISCONNECT;
+}
+
+static void net_send_packet(GameContext *ctx, PacketType type, const Uint8 *payload, int length) {
+    Uint8 buf[sizeof(NetHeader) + NET_MAX_PAYLOAD];
+    NetWriter w = {buf, 0, sizeof buf};
+
+    ctx->sendSeq++;
+    ctx->sentTick[ctx->sendSeq % NET_SEQ_WINDOW] = ctx->netTick;
+
+    put16(&w, NET_MAGIC);
+    put8(&w, (Uint8)type);
+    put8(&w, (Uint8)length);
+    put16(&w, ctx->sendSeq);
+    put16(&w, ctx->remoteSeq);
+    memcpy(buf + w.len, payload, (size_t)length);
+
+    int size = w.len + length;
+    if (SDLNet_TCP_Send(ctx->socket, buf, size) < size) {
+        net_disconnect(ctx);
+        return;
+    }
+    ctx->bytesSent += size;
+    ctx->packetsSent++;
+}
+
+static void net_send_hello(GameContext *ctx) {
+    Uint8 payload[8];
+    NetWriter w = {payload, 0, sizeof payload};
+    put32(&w, ctx->matchId);
+    put16(&w, (Uint16)ctx->round);
+    put8(&w, ctx->localReady);
+
+    ctx->sentReady = ctx->localReady;
+    net_send_packet(ctx, PACKET_HELLO, payload, w.len);
+}
+
+// Our inputs from the peer's ack up to the newest simulated frame, each one
+// relative to the frame before (the acked input is the base the peer has)
+static void net_send_inputs(GameContext *ctx) {
+    Uint8 payload[NET_MAX_PAYLOAD];
+    NetWriter w = {payload, 0, sizeof payload};
+
+    int newest = ctx->sim.frame - 1;
+    int first = ctx->localAcked + 1;
+    if (first < newest - (INPUT_RING - 2)) first = newest - (INPUT_RING - 2);   // ring limit
+    int count = newest - first + 1;
+    if (count < 0) count = 0;
+
+    int advantage = ctx->sim.frame - (ctx->remoteFrame + 1);
+    put32(&w, ctx->matchId);
+    put16(&w, (Uint16)ctx->round);
+    put8(&w, (Uint8)(Sint8)(advantage > 127 ? 127 : advantage));
+    put32(&w, (Uint32)ctx->remoteFrame);
+    put32(&w, (Uint32)first);
+    put8(&w, (Uint8)count);
+
+    PongInput prev = first > 0 ? ctx->localInputs[(first - 1) % INPUT_RING] : (PongInput){0, 0, -1};
+    for (int f = first; f <= newest; f++) {
+        const PongInput *in = &ctx->localInputs[f % INPUT_RING];
+        bool touchChanged = in->touchY != prev.touchY;
+        put8(&w, (Uint8)(in->buttons | (touchChanged ? INPUT_TOUCH_CHANGED : 0)));
+        if (touchChanged) put16(&w, (Uint16)in->touchY);
+        prev = *in;
+    }
+
+    if (w.len > w.cap) {
+        printf("[Net] ERROR: input packet too large (%d frames)\n", count);
+        return;
+    }
+    net_send_packet(ctx, PACKET_INPUT, payload, w.len);
+}
+
+static void receive_inputs(GameContext *ctx, NetReader *r) {
+    ctx->remoteAdvantage = (Sint8)get8(r);
+    int acked = (Sint32)get32(r);
+    int first = (Sint32)get32(r);
+    int count = get8(r);
+    if (r->overflow) return;
+
+    if (acked > ctx->localAcked) ctx->localAcked = acked;
+
+    // Delta base: the input before `first`, which we must already hold.
+    // Otherwise something was lost; the peer resends from our ack.
+    if (first > ctx->remoteFrame + 1 || first <= ctx->remoteFrame - (INPUT_RING - 1)) return;
+    PongInput prev = first > 0 ? ctx->remoteInputs[(first - 1) % INPUT_RING] : (PongInput){0, 0, -1};
+
+    for (int i = 0; i < count; i++) {
+        int f = first + i;
+        Uint8 bits = get8(r);
+        PongInput input = {(Uint8)(bits & (INPUT_UP | INPUT_DOWN)), 0, prev.touchY};
+        if (bits & INPUT_TOUCH_CHANGED) input.touchY = (Sint16)get16(r);
+        if (r->overflow) return;
+        prev = input;
+
+        if (f <= ctx->remoteFrame) continue;        // already have it
+        ctx->remoteInputs[f % INPUT_RING] = input;
+        ctx->remoteFrame = f;
+        ctx->lastRemote = input;
+
+        // Already simulated with a guess: rewind if the guess was wrong
+        if (f < ctx->sim.frame && !inputs_equal(&ctx->remoteUsed[f % INPUT_RING], &input)) {
+            if (ctx->rollbackFrom < 0 || f < ctx->rollbackFrom) ctx->rollbackFrom = f;
+        }
+    }
+}
+
+static void net_handle_packet(GameContext *ctx, const NetHeader *h, const Uint8 *payload) {
+    // Stale or replayed (seq compared with wraparound)
+    if ((Sint16)(h->seq - ctx->remoteSeq) <= 0 && ctx->remoteSeq != 0) return;
+    ctx->remoteSeq = h->seq;
+
+    if ((Sint16)(h->ack - ctx->ackedSeq) > 0 && (Sint16)(ctx->sendSeq - h->ack) >= 0) {
+        ctx->ackedSeq = h->ack;
+        if ((Uint16)(ctx->sendSeq - h->ack) < NET_SEQ_WINDOW) {
+            float sample = (float)(ctx->netTick - ctx->sentTick[h->ack % NET_SEQ_WINDOW]);
+            ctx->rtt = ctx->rtt > 0 ? ctx->rtt + (sample - ctx->rtt) * 0.125f : sample;
+        }
+    }
 
-    GamePacket out = {
-        ctx->matchId,
-        (Sint16)((ctx->playerType == 1) ? ctx->paddle1Y : ctx->paddle2Y),
-        ctx->ballX, ctx->ballY,
-        ctx->ballVelX, ctx->ballVelY,
-        ctx->localReady,
-        ctx->state,
-        ctx->score1, ctx->score2
-    };
-    SDLNet_TCP_Send(ctx->socket, &out, sizeof out);
+    NetReader r = {payload, h->length, 0, false};
+    unsigned matchId = get32(&r);
+    Uint16 round = get16(&r);
+    if (r.overflow) return;
+
+    ctx->remoteMatchId = matchId;
+    ctx->playerType = (ctx->matchId >= matchId) ? 1 : 2;
+
+    if (h->type == PACKET_HELLO) {
+        ctx->remoteReady = get8(&r);
+        ctx->remoteLobbyRound = round;
+    } else if (h->type == PACKET_INPUT) {
+        // The peer committed to the next round before seeing us un-ready
+        if (ctx->state == GAME_WAITING && round == (Uint16)(ctx->round + 1)) session_start(ctx);
+        if (ctx->state == GAME_PLAYING && round == (Uint16)ctx->round) receive_inputs(ctx, &r);
+    }
+}
 
+static void net_receive(GameContext *ctx) {
     while (SDLNet_CheckSockets(ctx->socketSet, 0) > 0 && SDLNet_SocketReady(ctx->socket)) {
-        GamePacket in;
-        int n = SDLNet_TCP_Recv(ctx->socket, &in, sizeof in);
-        if (n != sizeof in) {
-            SDLNet_TCP_Close(ctx->socket);
-            SDLNet_FreeSocketSet(ctx->socketSet);
-            ctx->connected = false;
-            ctx->state = GAME_DISCONNECT;
+        int n = SDLNet_TCP_Recv(ctx->socket, ctx->recvBuf + ctx->recvLen, NET_RECV_BUFFER - ctx->recvLen);
+        if (n <= 0) {
+            net_disconnect(ctx);
             return;
         }
+        ctx->recvLen += n;
+
+        // Consume every complete packet, keep the tail for the next read
+        int pos = 0;
+        while (ctx->recvLen - pos >= (int)sizeof(NetHeader)) {
+            NetReader r = {ctx->recvBuf + pos, ctx->recvLen - pos, 0, false};
+            NetHeader h;
+            h.magic = get16(&r);
+            if (h.magic != NET_MAGIC) { pos++; continue; }     // resync
+            h.type = get8(&r);
+            h.length = get8(&r);
+            h.seq = get16(&r);
+            h.ack = get16(&r);
+            if (ctx->recvLen - pos - r.pos < h.length) break;  // partial packet
+
+            net_handle_packet(ctx, &h, ctx->recvBuf + pos + r.pos);
+            pos += r.pos + h.length;
+        }
+        memmove(ctx->recvBuf, ctx->recvBuf + pos, (size_t)(ctx->recvLen - pos));
+        ctx->recvLen -= pos;
+    }
+}
+
+// Fixed cadence independent of the frame rate; the round's last inputs go
+// out immediately
+static void net_send(GameContext *ctx) {
+    ctx->netTick++;
+    if (ctx->state == GAME_PLAYING) {
+        if (ctx->netTick % NET_SEND_INTERVAL == 0) net_send_inputs(ctx);
+    } else if (ctx->localReady != ctx->sentReady || ctx->netTick % NET_HELLO_INTERVAL == 0) {
+        net_send_hello(ctx);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Server-authoritative mode
+// ----------------------------------------------------------------------------
+
+static void auth_send(GameContext *ctx, const Uint8 *data, int length) {
+    if (SDLNet_TCP_Send(ctx->socket, data, length) < length) {
+        net_disconnect(ctx);
+        return;
+    }
+    ctx->bytesSent += length;
+    ctx->packetsSent++;
+}
 
-        bool host = ctx->matchId >= in.matchId;
-        ctx->playerType = host ? 1 : 2;
+static void auth_send_control(GameContext *ctx, const char *json) {
+    Uint8 buf[AUTH_MAX_JSON];
+    int length = (int)strlen(json);
+    buf[0] = AUTH_TAG_CONTROL;
+    memcpy(buf + 1, json, (size_t)length);
+    auth_send(ctx, buf, length + 1);
+}
 
-        if (host) ctx->paddle2Y = in.paddleY;
-        else ctx->paddle1Y = in.paddleY;
+// Only changes: the server keeps each player's last input
+static void auth_send_input(GameContext *ctx) {
+    PongInput in = read_local_input(ctx);
+    if (ctx->authIndex < 0 || inputs_equal(&in, &ctx->authSent)) return;
+
+    Uint8 buf[4];
+    NetWriter w = {buf, 0, sizeof buf};
+    put8(&w, AUTH_INPUT);
+    put8(&w, in.buttons);
+    put16(&w, (Uint16)in.touchY);
+    auth_send(ctx, buf, w.len);
+    ctx->authSent = in;
+}
 
-        ctx->remoteReady = in.ready;
+// Length of the JSON object at p (through its closing brace), -1 if incomplete
+static int json_object_length(const Uint8 *p, int len) {
+    int depth = 0;
+    bool inString = false;
+    for (int i = 0; i < len; i++) {
+        if (inString) {
+            if (p[i] == '\\') i++;
+            else if (p[i] == '"') inString = false;
+        } else if (p[i] == '"') {
+            inString = true;
+        } else if (p[i] == '{') {
+            depth++;
+        } else if (p[i] == '}' && --depth == 0) {
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+// Integer member of a JSON.stringify'd object (no whitespace), or fallback
+static int json_int(const char *json, const char *key, int fallback) {
+    char pattern[40];
+    snprintf(pattern, sizeof pattern, "\"%s\":", key);
+    const char *p = strstr(json, pattern);
+    return p ? atoi(p + strlen(pattern)) : fallback;
+}
+
+static void auth_handle_json(GameContext *ctx, const char *json) {
+    if (strstr(json, "\"type\":\"game_start\"")) {
+        ctx->authIndex = json_int(json, "playerIndex", 0);
+        ctx->playerType = ctx->authIndex == 0 ? 1 : 2;
+        ctx->authSent = (PongInput){0xff, 0, -2};   // send the first input whatever it is
+        ctx->state = GAME_PLAYING;
+        printf("[Auth] match started (%s paddle, server tick %d Hz)\n",
+               ctx->authIndex == 0 ? "left" : "right", json_int(json, "tickHz", 0));
+
+        // The server's rules win; say so if this build would play differently
+        int ballSpeed = json_int(json, "ballSpeed", BALL_SPEED_X);
+        int paddleSpeed = json_int(json, "paddleSpeed", PADDLE_SPEED);
+        int maxScore = json_int(json, "maxScore", MAX_SCORE);
+        if (ballSpeed != BALL_SPEED_X || ballSpeed != BALL_SPEED_Y || paddleSpeed != PADDLE_SPEED || maxScore != MAX_SCORE)
+            printf("[Auth] server rules differ from this build (ball speed %d vs %d, paddle speed %d vs %d, max score %d vs %d)\n",
+                   ballSpeed, BALL_SPEED_X, paddleSpeed, PADDLE_SPEED, maxScore, MAX_SCORE);
+    } else if (strstr(json, "\"type\":\"waiting\"")) {
+        printf("[Auth] waiting for an opponent...\n");
+    } else if (strstr(json, "\"type\":\"player_left\"")) {
+        printf("[Auth] opponent left, queueing again\n");
+        net_disconnect(ctx);                        // the reconnect re-queues
+    } else if (strstr(json, "\"type\":\"error\"")) {
+        printf("[Auth] server error: %s\n", json);
+    }
+}
 
-        if (host) {
-            ctx->ballOwner = true;
-            if (ctx->state == GAME_WAITING && ctx->localReady && ctx->remoteReady) {
-                ctx->state = GAME_PLAYING;
-                ctx->ballVelX = (rand() & 1) ? BALL_SPEED_X : -BALL_SPEED_X;
-                ctx->ballVelY = (rand() & 1) ? BALL_SPEED_Y : -BALL_SPEED_Y;
+static void auth_apply_snapshot(GameContext *ctx, const Uint8 *data) {
+    NetReader r = {data + 1, AUTH_SNAPSHOT_SIZE - 1, 0, false};
+    PongState *s = &ctx->sim;
+    s->state = (GameState)get8(&r);
+    s->frame = (int)get32(&r);
+    s->paddleY[0] = (Sint16)get16(&r);
+    s->paddleY[1] = (Sint16)get16(&r);
+    s->ballX = (Sint16)get16(&r);
+    s->ballY = (Sint16)get16(&r);
+    s->ballVelX = (Sint8)get8(&r);
+    s->ballVelY = (Sint8)get8(&r);
+    s->score[0] = get8(&r);
+    s->score[1] = get8(&r);
+}
+
+static void auth_receive(GameContext *ctx) {
+    while (SDLNet_CheckSockets(ctx->socketSet, 0) > 0 && SDLNet_SocketReady(ctx->socket)) {
+        int n = SDLNet_TCP_Recv(ctx->socket, ctx->recvBuf + ctx->recvLen, NET_RECV_BUFFER - ctx->recvLen);
+        if (n <= 0) {
+            net_disconnect(ctx);
+            return;
+        }
+        ctx->recvLen += n;
+
+        // Snapshots and JSON objects back to back; keep a partial one
+        int pos = 0;
+        while (pos < ctx->recvLen) {
+            const Uint8 *p = ctx->recvBuf + pos;
+            int left = ctx->recvLen - pos;
+
+            if (p[0] == AUTH_SNAPSHOT) {
+                if (left < AUTH_SNAPSHOT_SIZE) break;
+                if (ctx->authIndex >= 0) auth_apply_snapshot(ctx, p);
+                pos += AUTH_SNAPSHOT_SIZE;
+            } else if (p[0] == '{') {
+                int length = json_object_length(p, left);
+                if (length < 0) {
+                    if (left == NET_RECV_BUFFER) pos = ctx->recvLen;   // can never complete
+                    break;
+                }
+                if (length < AUTH_MAX_JSON) {
+                    char json[AUTH_MAX_JSON];
+                    memcpy(json, p, (size_t)length);
+                    json[length] = '\0';
+                    auth_handle_json(ctx, json);
+                    if (!ctx->connected) return;
+                }
+                pos += length;
+            } else {
+                pos++;                                  // resync
             }
-        } else {
-            ctx->ballOwner = false;
-            ctx->ballX = in.ballX;
-            ctx->ballY = in.ballY;
-            ctx->ballVelX = in.velX;
-            ctx->ballVelY = in.velY;
-            ctx->state = (GameState)in.state;
-            ctx->score1 = in.score1;
-            ctx->score2 = in.score2;
         }
+        memmove(ctx->recvBuf, ctx->recvBuf + pos, (size_t)(ctx->recvLen - pos));
+        ctx->recvLen -= pos;
+    }
+}
+
+// One tick: (re)join the quick-auth queue, then inputs out, snapshots in
+static void auth_tick(GameContext *ctx) {
+    if (!ctx->connected) {
+        net_try_connect(ctx);
+        if (!ctx->connected) return;
+        ctx->state = GAME_WAITING;
+        ctx->authIndex = -1;
+        auth_send_control(ctx, "{\"type\":\"quick_match\",\"authoritative\":true}");
+        if (!ctx->connected) return;
     }
+    auth_receive(ctx);
+    if (ctx->connected) auth_send_input(ctx);
 }
 
+static void toggle_mode(GameContext *ctx) {
+    ctx->authoritative = !ctx->authoritative;
+    printf("[Net] mode: %s\n", ctx->authoritative ? "server-authoritative (quick-auth queue)" : "rollback (binary relay)");
+    if (ctx->connected) net_disconnect(ctx);
+    ctx->localReady = ctx->remoteReady = false;
+    ctx->authIndex = -1;
+}
+
+// ----------------------------------------------------------------------------
+// Input + frame
+// ----------------------------------------------------------------------------
+
 static void handle_input(GameContext *ctx) {
     SDL_Event e;
     while (SDL_PollEvent(&e)) {
@@ -115,6 +685,7 @@ static void handle_input(GameContext *ctx) {
                 if (e.key.keysym.sym == SDLK_UP || e.key.keysym.sym == SDLK_w) ctx->keyUpHeld = true;
                 if (e.key.keysym.sym == SDLK_DOWN || e.key.keysym.sym == SDLK_s) ctx->keyDownHeld = true;
                 if (e.key.keysym.sym == SDLK_SPACE && ctx->state == GAME_WAITING) ctx->localReady ^= 1;
+                if (e.key.keysym.sym == SDLK_m) toggle_mode(ctx);
             }
             break;
         case SDL_KEYUP:
@@ -128,14 +699,11 @@ static void handle_input(GameContext *ctx) {
             if (ctx->state == GAME_WAITING && !ctx->localReady) ctx->localReady = true;
             ctx->touchActive = true;
             ctx->fingerId = e.tfinger.fingerId;
-            int *pY = (ctx->playerType == 1) ? &ctx->paddle1Y : &ctx->paddle2Y;
-            *pY = (int)(e.tfinger.y * WINDOW_HEIGHT) - PADDLE_HEIGHT / 2;
+            ctx->touchY = (int)(e.tfinger.y * WINDOW_HEIGHT) - PADDLE_HEIGHT / 2;
             break;
         case SDL_FINGERMOTION:
-            if (ctx->touchActive && e.tfinger.fingerId == ctx->fingerId) {
-                int *pY = (ctx->playerType == 1) ? &ctx->paddle1Y : &ctx->paddle2Y;
-                *pY = (int)(e.tfinger.y * WINDOW_HEIGHT) - PADDLE_HEIGHT / 2;
-            }
+            if (ctx->touchActive && e.tfinger.fingerId == ctx->fingerId)
+                ctx->touchY = (int)(e.tfinger.y * WINDOW_HEIGHT) - PADDLE_HEIGHT / 2;
             break;
         case SDL_FINGERUP:
             if (ctx->touchActive && e.tfinger.fingerId == ctx->fingerId) ctx->touchActive = false;
@@ -144,71 +712,52 @@ static void handle_input(GameContext *ctx) {
     }
 }
 
-static void move_paddle_keys(GameContext *ctx) {
-    int dy = (ctx->keyDownHeld - ctx->keyUpHeld) * PADDLE_SPEED;
-    if (dy) {
-        int *pY = (ctx->playerType == 1) ? &ctx->paddle1Y : &ctx->paddle2Y;
-        *pY += dy;
-        if (*pY < 0) *pY = 0;
-        if (*pY > WINDOW_HEIGHT - PADDLE_HEIGHT) *pY = WINDOW_HEIGHT - PADDLE_HEIGHT;
+// One fixed tick of a running round
+static void update_session(GameContext *ctx) {
+    if (!ctx->connected) {
+        // Solo: the other paddle never moves, nothing to predict
+        ctx->localInputs[ctx->sim.frame % INPUT_RING] = read_local_input(ctx);
+        ctx->remoteInputs[ctx->sim.frame % INPUT_RING] = (PongInput){0, 0, -1};
+        ctx->remoteFrame = ctx->sim.frame;
+        session_step(ctx);
+        if (ctx->sim.state == GAME_VICTORY) session_end(ctx);
+        return;
     }
-}
 
-static void reset_ball(GameContext *ctx) {
-    ctx->ballX = (WINDOW_WIDTH - BALL_SIZE) / 2;
-    ctx->ballY = (WINDOW_HEIGHT - BALL_SIZE) / 2;
-    ctx->ballVelX = ctx->ballVelY = 0;
-}
+    session_rollback(ctx);
 
-static void serve_ball(GameContext *ctx) {
-    ctx->state = GAME_PLAYING;
-    ctx->ballVelX = (rand() & 1) ? BALL_SPEED_X : -BALL_SPEED_X;
-    ctx->ballVelY = (rand() & 1) ? BALL_SPEED_Y : -BALL_SPEED_Y;
-}
+    int behind = ctx->sim.frame - (ctx->remoteFrame + 1);
+    bool window_full = behind >= ROLLBACK_FRAMES - 1;
+    bool too_far_ahead = behind - ctx->remoteAdvantage >= SYNC_MIN_ADVANTAGE && ctx->sim.frame % SYNC_INTERVAL == 0;
 
-static void register_goal(GameContext *ctx, bool leftPlayerScored) {
-    if (leftPlayerScored) ctx->score1++; else ctx->score2++;
-
-    if (ctx->score1 == MAX_SCORE || ctx->score2 == MAX_SCORE) {
-        ctx->state = GAME_VICTORY;
-        ctx->score1 = ctx->score2 = 0;
-        ctx->localReady = ctx->remoteReady = false;
-        reset_ball(ctx);
-        ctx->state = GAME_WAITING;
+    if (window_full || too_far_ahead || ctx->sim.state == GAME_VICTORY) {
+        ctx->stallFrames += ctx->sim.state != GAME_VICTORY;
     } else {
-        ctx->state = GAME_SCORE;
-        ctx->scoreDelayFrames = GOAL_DELAY_FRAMES;
-        reset_ball(ctx);
+        ctx->localInputs[ctx->sim.frame % INPUT_RING] = read_local_input(ctx);
+        session_step(ctx);
     }
-}
-
-static void update_physics(GameContext *ctx) {
-    if (ctx->state == GAME_PLAYING && ctx->ballOwner) {
-        ctx->ballX += ctx->ballVelX;
-        ctx->ballY += ctx->ballVelY;
-
-        if (ctx->ballY <= 0 || ctx->ballY + BALL_SIZE >= WINDOW_HEIGHT)
-            ctx->ballVelY = (ctx->ballVelY > 0) ? -BALL_SPEED_Y : BALL_SPEED_Y;
 
+    // The round ends once the winning frame no longer depends on a guess
+    if (ctx->sim.state == GAME_VICTORY && ctx->remoteFrame >= ctx->sim.victoryFrame) session_end(ctx);
+}
 
-        SDL_Rect p1 = {20, ctx->paddle1Y, PADDLE_WIDTH, PADDLE_HEIGHT};
-        SDL_Rect p2 = {WINDOW_WIDTH - 20 - PADDLE_WIDTH, ctx->paddle2Y, PADDLE_WIDTH, PADDLE_HEIGHT};
-        SDL_Rect b = {ctx->ballX, ctx->ballY, BALL_SIZE, BALL_SIZE};
-
-        if (SDL_HasIntersection(&b, &p1) && ctx->ballVelX < 0) ctx->ballVelX = BALL_SPEED_X;
-        if (SDL_HasIntersection(&b, &p2) && ctx->ballVelX > 0) ctx->ballVelX = -BALL_SPEED_X;
-
-        if (ctx->ballX < -BALL_SIZE) register_goal(ctx, false);
-        else if (ctx->ballX > WINDOW_WIDTH) register_goal(ctx, true);
+static void update_lobby(GameContext *ctx) {
+    // Paddle moves locally only, the round restarts from the centre
+    PongInput in = read_local_input(ctx);
+    apply_input(&ctx->sim.paddleY[local_paddle(ctx)], &in);
 
-    } else if (ctx->state == GAME_SCORE && ctx->ballOwner) {
-        if (--ctx->scoreDelayFrames <= 0) serve_ball(ctx);
+    if (!ctx->connected) {
+        if (ctx->localReady) {
+            ctx->playerType = 1;
+            session_start(ctx);
+        }
+        return;
     }
 
-    ctx->paddle1Rect.y = ctx->paddle1Y;
-    ctx->paddle2Rect.y = ctx->paddle2Y;
-    ctx->ballRect.x = ctx->ballX;
-    ctx->ballRect.y = ctx->ballY;
+    // Both ready, and the peer's hello is from the lobby we're in
+    if (ctx->localReady && ctx->remoteReady && ctx->remoteMatchId &&
+        ctx->remoteLobbyRound == ctx->round)
+        session_start(ctx);
 }
 
 static void draw_paddle(SDL_Renderer *r, const SDL_Rect *rect, bool isLeftPaddle, bool isPlayerPaddle) {
@@ -257,14 +806,39 @@ static void draw_score(SDL_Renderer *r, int side, int score) {
 }
 
 
+// Follows `target` exactly while it moves at most `step` per frame (or
+// teleports, e.g. a serve), eases in a rollback correction otherwise
+static void ease_toward(float *drawn, int target, int step) {
+    float diff = (float)target - *drawn;
+    float dist = diff < 0 ? -diff : diff;
+    if (dist <= (float)step || dist > WINDOW_WIDTH / 4) *drawn = (float)target;
+    else *drawn += diff * CORRECTION_BLEND;
+}
+
+static void smooth_positions(GameContext *ctx) {
+    const PongState *s = &ctx->sim;
+    int local = local_paddle(ctx);
+    int ballStep = BALL_SPEED_X > BALL_SPEED_Y ? BALL_SPEED_X : BALL_SPEED_Y;
+    int paddleStep = PADDLE_SPEED;
+    if (ctx->authoritative) ballStep = paddleStep = WINDOW_WIDTH;   // snapshots: nothing to correct
+
+    ctx->drawPaddleY[local] = (float)s->paddleY[local];     // never predicted
+    ease_toward(&ctx->drawPaddleY[1 - local], s->paddleY[1 - local], paddleStep);
+    ease_toward(&ctx->drawBallX, s->ballX, ballStep);
+    ease_toward(&ctx->drawBallY, s->ballY, ballStep);
+}
+
 static void render_game(GameContext *ctx) {
     SDL_Renderer *r = ctx->renderer;
+    const PongState *s = &ctx->sim;
+
+    smooth_positions(ctx);
 
     set_color(r, COLOR_BG);
     SDL_RenderClear(r);
 
-    SDL_Rect leftPad = {20, ctx->paddle1Y, PADDLE_WIDTH, PADDLE_HEIGHT};
-    SDL_Rect rightPad = {WINDOW_WIDTH - 20 - PADDLE_WIDTH, ctx->paddle2Y, PADDLE_WIDTH, PADDLE_HEIGHT};
+    SDL_Rect leftPad = {20, (int)ctx->drawPaddleY[0], PADDLE_WIDTH, PADDLE_HEIGHT};
+    SDL_Rect rightPad = {WINDOW_WIDTH - 20 - PADDLE_WIDTH, (int)ctx->drawPaddleY[1], PADDLE_WIDTH, PADDLE_HEIGHT};
 
     bool leftIsPlayer = (ctx->playerType == 1);
     bool rightIsPlayer = (ctx->playerType == 2);
@@ -273,10 +847,11 @@ static void render_game(GameContext *ctx) {
     draw_paddle(r, &rightPad, false, rightIsPlayer);
 
     set_color(r, COLOR_BALL);
-    SDL_RenderFillRect(r, &ctx->ballRect);
+    SDL_Rect ball = {(int)ctx->drawBallX, (int)ctx->drawBallY, BALL_SIZE, BALL_SIZE};
+    SDL_RenderFillRect(r, &ball);
 
-    draw_score(r, 1, ctx->score1);
-    draw_score(r, 2, ctx->score2);
+    draw_score(r, 1, s->score[0]);
+    draw_score(r, 2, s->score[1]);
 
     int dashOffset = (ctx->state != GAME_WAITING) ? ctx->dashOffset : 0;
     set_color(r, COLOR_DASH);
@@ -288,42 +863,29 @@ static void render_game(GameContext *ctx) {
     SDL_RenderPresent(r);
 }
 
-EMSCRIPTEN_KEEPALIVE
-void update_and_render(GameContext *ctx) {
-    if (!ctx->initialized) {
-        srand((unsigned)time(NULL));
-        ctx->paddle1Y = ctx->paddle2Y = (WINDOW_HEIGHT - PADDLE_HEIGHT) / 2;
-        reset_ball(ctx);
-        ctx->paddle1Rect = (SDL_Rect){20, ctx->paddle1Y, PADDLE_WIDTH, PADDLE_HEIGHT};
-        ctx->paddle2Rect = (SDL_Rect){WINDOW_WIDTH - 20 - PADDLE_WIDTH, ctx->paddle2Y, PADDLE_WIDTH, PADDLE_HEIGHT};
-        ctx->ballRect = (SDL_Rect){ctx->ballX, ctx->ballY, BALL_SIZE, BALL_SIZE};
-        ctx->state = GAME_WAITING;
-        ctx->dashOffset = 0;
-        ctx->initialized = true;
-    }
-
-    handle_input(ctx);
-    move_paddle_keys(ctx);
-
-    if (!ctx->connected && ctx->state == GAME_WAITING && ctx->localReady) {
-        ctx->remoteReady = true;
-        ctx->ballOwner = true;
-        serve_ball(ctx);
-    }
-
+// One fixed tick: network plus a lobby or session step
+static void tick(GameContext *ctx) {
     if (ctx->state != GAME_WAITING)
         ctx->dashOffset = (ctx->dashOffset + DASH_SPEED) % 24;
 
+    if (ctx->authoritative) {
+        auth_tick(ctx);
+        return;
+    }
+
     switch (ctx->state) {
     case GAME_WAITING:
         net_try_connect(ctx);
-        net_exchange(ctx);
+        if (ctx->connected) net_receive(ctx);
+        if (ctx->state == GAME_WAITING) update_lobby(ctx);
+        if (ctx->connected) net_send(ctx);
         break;
     case GAME_PLAYING:
     case GAME_SCORE:
     case GAME_VICTORY:
-        net_exchange(ctx);
-        update_physics(ctx);
+        if (ctx->connected) net_receive(ctx);
+        if (ctx->state == GAME_PLAYING) update_session(ctx);
+        if (ctx->connected) net_send(ctx);
         break;
     case GAME_DISCONNECT:
         net_try_connect(ctx);
@@ -333,6 +895,37 @@ void update_and_render(GameContext *ctx) {
         }
         break;
     }
+}
+
+EMSCRIPTEN_KEEPALIVE
+void update_and_render(GameContext *ctx) {
+    if (!ctx->initialized) {
+        srand((unsigned)time(NULL));
+        sim_reset(&ctx->sim, 1);
+        ctx->sim.state = GAME_WAITING;
+        reset_ball(&ctx->sim);
+        ctx->state = GAME_WAITING;
+        ctx->dashOffset = 0;
+        ctx->initialized = true;
+    }
+
+    handle_input(ctx);
+
+    // Ticks due since the last frame: none on some frames of a fast display,
+    // several after a slow one. The clock lives in ctx so a hot-reload doesn't
+    // produce a giant first delta.
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (ctx->lastCounter == 0 || now < ctx->lastCounter) {
+        ctx->lastCounter = now;
+        ctx->tickAccumulator = TICK_DT;
+    }
+    ctx->tickAccumulator += (double)(now - ctx->lastCounter) / (double)SDL_GetPerformanceFrequency();
+    ctx->lastCounter = now;
+    if (ctx->tickAccumulator > MAX_CATCHUP_TICKS * TICK_DT)
+        ctx->tickAccumulator = MAX_CATCHUP_TICKS * TICK_DT;
+
+    for (; ctx->tickAccumulator >= TICK_DT; ctx->tickAccumulator -= TICK_DT)
+        tick(ctx);
 
     render_game(ctx);
 }
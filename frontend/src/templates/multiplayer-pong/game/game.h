@@ -1,12 +1,32 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <stdbool.h>
+
 #define WINDOW_WIDTH   640
 #define WINDOW_HEIGHT  480
 #define PADDLE_WIDTH   10
 #define PADDLE_HEIGHT  80
 #define BALL_SIZE      10
 
+// Rollback netcode: both peers run the same deterministic fixed-tick sim and
+// only exchange inputs tagged with frame numbers. The remote paddle is
+// predicted (last input repeated); when a late input disagrees, the sim is
+// rewound to the stored state of that frame and re-simulated.
+#define ROLLBACK_FRAMES    16                     // state history = max prediction depth
+#define INPUT_RING         (ROLLBACK_FRAMES * 2)  // remote may run ahead of us by a window
+
+// Wire protocol: a byte stream of framed packets, [NetHeader][payload].
+// Inputs are resent from the last frame the peer acked, each one encoded
+// against the one before it, so a partial read, a lost first message or a
+// reconnect never loses a frame.
+#define NET_MAGIC          0x4750                 // "PG"
+#define NET_SEND_INTERVAL  2                      // frames between input packets (latency vs bandwidth)
+#define NET_HELLO_INTERVAL 15                     // lobby keep-alive, frames
+#define NET_MAX_PAYLOAD    192
+#define NET_RECV_BUFFER    1024                   // reassembly buffer for partial reads
+#define NET_SEQ_WINDOW     64                     // send times kept for RTT from acks
+
 typedef enum {
     GAME_WAITING,
     GAME_PLAYING,
@@ -15,34 +35,93 @@ typedef enum {
     GAME_DISCONNECT
 } GameState;
 
+#define INPUT_UP    0x01
+#define INPUT_DOWN  0x02
+
+// One paddle's input for one frame (sent over the wire, keep it small)
 typedef struct {
-    SDL_Renderer *renderer;
+    Uint8  buttons;       // INPUT_UP | INPUT_DOWN
+    Uint8  pad;
+    Sint16 touchY;        // paddle top from touch, -1: no touch
+} PongInput;
 
-    int  paddle1Y, paddle2Y;
-    int  ballX, ballY;
-    int  ballVelX, ballVelY;
+// Everything the simulation reads or writes; plain ints, copied by value for
+// the rollback history. Paddle 0 is the left one (player 1).
+typedef struct {
+    int frame;            // frames simulated so far
+    GameState state;      // GAME_PLAYING, GAME_SCORE or GAME_VICTORY
+    int paddleY[2];
+    int ballX, ballY;
+    int ballVelX, ballVelY;
+    int score[2];
+    int scoreDelayFrames;
+    int victoryFrame;
+    Uint32 rng;
+} PongState;
 
-    SDL_Rect paddle1Rect, paddle2Rect, ballRect;
+typedef struct {
+    SDL_Renderer *renderer;
 
     TCPsocket        socket;
     SDLNet_SocketSet socketSet;
     bool             connected;
-    unsigned         matchId;
-    int              playerType;
-    bool             ballOwner;
+    unsigned         matchId, remoteMatchId;
+    int              playerType;      // 1: left paddle (higher matchId), 2: right, 0: unknown
 
-    bool localReady, remoteReady;
+    // Server-authoritative mode (M toggles): backend/authority.js runs the
+    // match, this client only sends inputs and draws the server's snapshots
+    bool      authoritative;
+    int       authIndex;              // our player index in the server's match, -1: not started
+    PongInput authSent;               // last input sent
 
+    // Lobby: GAME_WAITING until both sides are ready, then GAME_PLAYING while
+    // a round's session runs (the sim has its own state)
     GameState state;
-    int score1, score2;
-    int scoreDelayFrames;
+    bool localReady, remoteReady;
+    int round;                        // stamps packets; bumped when a session starts
+    int remoteLobbyRound;             // round the peer last said hello from
+
+    PongState sim;
+    PongState history[ROLLBACK_FRAMES];          // state at the start of frame f, slot f % ROLLBACK_FRAMES
+    PongInput localInputs[INPUT_RING];
+    PongInput remoteInputs[INPUT_RING];          // received (f <= remoteFrame)
+    PongInput remoteUsed[INPUT_RING];            // what the sim used for frame f (maybe predicted)
+    int remoteFrame;                             // newest remote frame received, -1: none
+    PongInput lastRemote;                        // prediction source
+    int rollbackFrom;                            // earliest mispredicted frame, -1: none
+    int remoteAdvantage;                         // peer's frame lead over us, as it sees it
+
+    // Connection: framing, sequence numbers, acks
+    Uint8  recvBuf[NET_RECV_BUFFER];
+    int    recvLen;
+    Uint16 sendSeq;                              // last packet we sent
+    Uint16 remoteSeq;                            // newest packet received (older ones are stale)
+    Uint16 ackedSeq;                             // newest of ours the peer acked
+    int    sentTick[NET_SEQ_WINDOW];             // netTick a seq was sent at, slot seq % NET_SEQ_WINDOW
+    int    netTick;                              // frames since connecting
+    int    localAcked;                           // newest of our input frames the peer has, -1: none
+    bool   sentReady;                            // ready flag in our last hello
+    float  rtt;                                  // smoothed round trip, frames
+
+    // Round stats
+    int rollbacks, resimFrames, maxRollback, stallFrames;
+    int bytesSent, packetsSent;
+
+    // Render-only: drawn positions ease into rollback corrections
+    float drawBallX, drawBallY;
+    float drawPaddleY[2];
 
     bool keyUpHeld, keyDownHeld;
     bool touchActive;
     SDL_FingerID fingerId;
+    int touchY;
 
     int dashOffset;
 
+    // Fixed tick clock (see update_and_render)
+    Uint64 lastCounter;
+    double tickAccumulator;
+
     bool initialized;
 
 } GameContext;
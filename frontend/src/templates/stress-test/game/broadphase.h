@@ -0,0 +1,132 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+// ----------------------------------------------------------------------------
+// Uniform-grid broadphase
+//
+// Rebuilt from scratch every step (no incremental state to go stale across a
+// hot-reload or a timeline seek). Built with a counting sort into two flat
+// arrays in frame-scratch memory:
+//
+//   cell_start[c] .. cell_start[c + 1]  ->  items[] (entity ids in cell c)
+//                                          box_x/y/w/h[] (their boxes, SoA)
+//
+// The box copies sit next to the ids in cell order, so a query streams one
+// contiguous run per cell through k_aabb_first_overlap (simd_kernels.h)
+// instead of gathering from the entity pool.
+//
+// Boxes are inserted in the order given, so ids inside a cell are ascending
+// when the caller passes them ascending. Queries are therefore deterministic
+// and "lowest id wins" can stop early.
+//
+// Boxes outside the grid bounds are clamped into the edge cells, so the grid
+// only needs to cover the play area for correctness.
+//
+// Header-only, no globals (hot-reload safe).
+// ----------------------------------------------------------------------------
+
+#include <stdbool.h>
+
+#include "base_arena.h"
+
+typedef struct {
+    float x, y, w, h;
+    int id;
+} BpBox;
+
+typedef struct {
+    float origin_x, origin_y;
+    float inv_cell;
+    int cols, rows;
+    int *cell_start;     // cols * rows + 1 offsets into items
+    int *items;
+    float *box_x, *box_y, *box_w, *box_h;   // parallel to items
+    int item_count;
+} Broadphase;
+
+typedef struct {
+    int x0, y0, x1, y1;  // inclusive
+} BpCellRange;
+
+static inline int bp_clampi(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+static inline BpCellRange bp_cells(const Broadphase *bp, float x, float y, float w, float h) {
+    BpCellRange r = { 0, 0, -1, -1 };
+    if (bp->cols == 0) return r;   // empty grid (failed build): no cells
+    r.x0 = bp_clampi((int)((x - bp->origin_x) * bp->inv_cell), 0, bp->cols - 1);
+    r.y0 = bp_clampi((int)((y - bp->origin_y) * bp->inv_cell), 0, bp->rows - 1);
+    r.x1 = bp_clampi((int)((x + w - bp->origin_x) * bp->inv_cell), 0, bp->cols - 1);
+    r.y1 = bp_clampi((int)((y + h - bp->origin_y) * bp->inv_cell), 0, bp->rows - 1);
+    return r;
+}
+
+// Returns false if `scratch` is too small; the grid is then empty.
+static inline bool bp_build(Broadphase *bp, Arena *scratch, const BpBox *boxes, int count,
+                            float origin_x, float origin_y, float width, float height, float cell_size) {
+    bp->origin_x = origin_x;
+    bp->origin_y = origin_y;
+    bp->inv_cell = 1.0f / cell_size;
+    bp->cols = (int)(width / cell_size) + 1;
+    bp->rows = (int)(height / cell_size) + 1;
+    bp->item_count = 0;
+
+    int cells = bp->cols * bp->rows;
+    bp->cell_start = arena_push_array(scratch, int, cells + 1);
+    int *cursor = arena_push_array(scratch, int, cells);
+    if (!bp->cell_start || !cursor) {
+        bp->cols = bp->rows = 0;
+        return false;
+    }
+
+    // pass 1: count entries per cell
+    for (int i = 0; i < count; i++) {
+        BpCellRange r = bp_cells(bp, boxes[i].x, boxes[i].y, boxes[i].w, boxes[i].h);
+        for (int cy = r.y0; cy <= r.y1; cy++)
+            for (int cx = r.x0; cx <= r.x1; cx++)
+                bp->cell_start[cy * bp->cols + cx + 1]++;
+    }
+
+    // prefix sum -> offsets
+    for (int c = 0; c < cells; c++) {
+        bp->cell_start[c + 1] += bp->cell_start[c];
+        cursor[c] = bp->cell_start[c];
+    }
+    bp->item_count = bp->cell_start[cells];
+
+    bp->items = arena_push_array(scratch, int, bp->item_count);
+    bp->box_x = arena_push_array(scratch, float, bp->item_count);
+    bp->box_y = arena_push_array(scratch, float, bp->item_count);
+    bp->box_w = arena_push_array(scratch, float, bp->item_count);
+    bp->box_h = arena_push_array(scratch, float, bp->item_count);
+    if ((!bp->items || !bp->box_x || !bp->box_y || !bp->box_w || !bp->box_h) && bp->item_count > 0) {
+        bp->cols = bp->rows = 0;
+        bp->item_count = 0;
+        return false;
+    }
+
+    // pass 2: scatter ids + boxes (keeps input order within each cell)
+    for (int i = 0; i < count; i++) {
+        BpCellRange r = bp_cells(bp, boxes[i].x, boxes[i].y, boxes[i].w, boxes[i].h);
+        for (int cy = r.y0; cy <= r.y1; cy++) {
+            for (int cx = r.x0; cx <= r.x1; cx++) {
+                int slot = cursor[cy * bp->cols + cx]++;
+                bp->items[slot] = boxes[i].id;
+                bp->box_x[slot] = boxes[i].x;
+                bp->box_y[slot] = boxes[i].y;
+                bp->box_w[slot] = boxes[i].w;
+                bp->box_h[slot] = boxes[i].h;
+            }
+        }
+    }
+    return true;
+}
+
+// Entries [begin, end) of one cell, indexing items[] and box_*[] alike; an
+// entity spanning several cells appears in each
+static inline void bp_cell_span(const Broadphase *bp, int cx, int cy, int *begin, int *end) {
+    int c = cy * bp->cols + cx;
+    *begin = bp->cell_start[c];
+    *end = bp->cell_start[c + 1];
+}
+
+#endif
@@ -0,0 +1,503 @@
+#include <emscripten.h>
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "game.h"
+#include "render_queue.h"
+#include "broadphase.h"
+#include "entity_pool.h"
+#include "simd_kernels.h"
+
+// -----------------------------------------------------------------------------
+// STRESS TEST
+// A standard workload for comparing builds, profiles and backends: thousands
+// of moving boxes bouncing off the walls and each other, drawn through the
+// render queue, with update / render / present timed separately.
+//
+// - One sim step per displayed frame (no fixed-timestep accumulator): the
+//   work per frame is what's measured, and the bench script counts frames.
+// - B runs the scripted benchmark: fixed seed, fixed entity-count schedule,
+//   keyboard ignored. The position checksum printed per phase must match
+//   between builds, otherwise they didn't run the same workload.
+//
+// LIVE CODING RULES
+// - No gameplay-critical globals (all runtime state lives in GameContext* ctx).
+// - Globals in this file are static const (hotreload-safe).
+// -----------------------------------------------------------------------------
+
+// Change this when you want an easy "I know the new code is running" signal.
+static const int BUILD_ID = 1;
+
+// Render layers (render_queue.h only keeps order between layers)
+enum {
+    LAYER_BACKGROUND,
+    LAYER_WORLD,
+    LAYER_HUD,
+    LAYER_HUD_OVERLAY
+};
+
+static const SDL_Color BG_COLOR          = { 8, 10, 18, 255 };
+static const SDL_Color COLOR_BORDER      = { 50, 50, 70, 255 };
+static const SDL_Color COLOR_ENTITY      = { 99, 102, 241, 255 };
+static const SDL_Color COLOR_ENTITY_HIT  = { 248, 113, 113, 255 };
+static const SDL_Color COLOR_HUD_PANEL   = { 0, 0, 0, 190 };
+static const SDL_Color COLOR_HUD_BUDGET  = { 148, 163, 184, 255 };
+static const SDL_Color COLOR_HIST        = { 203, 213, 225, 255 };
+static const SDL_Color COLOR_BENCH       = { 234, 179, 8, 255 };
+static const SDL_Color TIMING_COLORS[TIMING_COUNT] = {
+    { 34, 197, 94, 255 },    // update
+    { 59, 130, 246, 255 },   // render
+    { 245, 158, 11, 255 },   // present
+};
+static const char *const TIMING_NAMES[TIMING_COUNT] = { "update", "render", "present" };
+
+// Entities
+static const int   ENTITY_SIZE = 4;
+static const float ENTITY_SPEED_MAX = 2.5f;
+static const int   START_COUNT = 2000;
+static const int   MIN_COUNT = 250;
+
+// Collision grid: a few entity widths per cell
+static const float BROADPHASE_CELL_SIZE = 16.0f;
+
+// Everything one frame can queue: entities + HUD
+#define RENDER_QUEUE_CAPACITY (MAX_ENTITIES + FRAME_HIST_BUCKETS + 32)
+
+// HUD scale: a full bar is one 60Hz frame
+static const float HUD_BUDGET_US = 16667.0f;
+static const float TIMING_SMOOTHING = 0.1f;
+
+// Scripted benchmark
+static const unsigned int BENCH_SEED = 0xC0FFEEu;
+static const int BENCH_COUNTS[] = { 1000, 2000, 4000, 8000, 16000 };
+#define BENCH_PHASES ((int)(sizeof(BENCH_COUNTS) / sizeof(BENCH_COUNTS[0])))
+
+// deterministic rng (stored in ctx, so bench runs are repeatable)
+static unsigned int xorshift32(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+static float frand(unsigned int *state, float a, float b) {
+    unsigned int r = xorshift32(state);
+    float t = (r / 4294967295.0f);
+    return a + t * (b - a);
+}
+
+// entities_push/remove/sweep (entity_pool.h)
+DEFINE_SOA_POOL(Entities, ENTITY_FIELDS, MAX_ENTITIES, entities)
+
+// ----------------------------------------------------------------------------
+// Game memory: one block, reserved on first run, kept across hot-reloads.
+// Layout: [frame scratch]
+// ----------------------------------------------------------------------------
+
+static size_t game_memory_size(void) {
+    return arena_size_for(FRAME_SCRATCH_SIZE);
+}
+
+// Returns false if the block couldn't be reserved (the frame is skipped)
+static bool memory_init_if_needed(GameContext *ctx) {
+    if (ctx->arena.base) return true;
+
+    size_t size = game_memory_size();
+    void *block = malloc(size);
+    if (!block) {
+        printf("[Memory] ERROR: failed to reserve %d KB\n", (int)(size / 1024));
+        return false;
+    }
+    arena_init(&ctx->arena, block, size);
+    ctx->frame_arena = arena_sub(&ctx->arena, FRAME_SCRATCH_SIZE);
+
+    printf("Game memory: %d KB (scratch %d KB, %s kernels)\n",
+           (int)(ctx->arena.used / 1024), (int)(FRAME_SCRATCH_SIZE / 1024), SIMD_KERNELS_BACKEND);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// World
+// ----------------------------------------------------------------------------
+
+static void spawn_entity(GameContext *ctx) {
+    Entities *e = &ctx->entities;
+    int i = entities_push(e);
+    if (i < 0) return;
+
+    e->alive[i] = true;
+    e->x[i] = frand(&ctx->rng_state, 0.0f, (float)(WINDOW_WIDTH - ENTITY_SIZE));
+    e->y[i] = frand(&ctx->rng_state, 0.0f, (float)(WINDOW_HEIGHT - ENTITY_SIZE));
+
+    // no libm trig here: the checksum must match across toolchains too
+    e->vx[i] = frand(&ctx->rng_state, -ENTITY_SPEED_MAX, ENTITY_SPEED_MAX);
+    e->vy[i] = frand(&ctx->rng_state, -ENTITY_SPEED_MAX, ENTITY_SPEED_MAX);
+}
+
+static void clear_frame_hist(GameContext *ctx) {
+    memset(ctx->frame_hist, 0, sizeof(ctx->frame_hist));
+}
+
+// Grows by spawning (continues the rng stream), shrinks by dropping the tail
+static void set_entity_count(GameContext *ctx, int count) {
+    if (count < 0) count = 0;
+    if (count > MAX_ENTITIES) count = MAX_ENTITIES;
+
+    ctx->target_count = count;
+    while (ctx->entities.count < count) spawn_entity(ctx);
+    if (ctx->entities.count > count) ctx->entities.count = count;
+
+    clear_frame_hist(ctx);
+}
+
+static void reset_world(GameContext *ctx, unsigned int seed, int count) {
+    ctx->rng_state = seed;
+    memset(&ctx->entities, 0, sizeof(ctx->entities));
+    ctx->collisions = 0;
+    set_entity_count(ctx, count);
+}
+
+// ----------------------------------------------------------------------------
+// Scripted benchmark
+// ----------------------------------------------------------------------------
+
+static void bench_start(GameContext *ctx) {
+    ctx->bench_active = true;
+    ctx->bench_phase = 0;
+    ctx->bench_frame = 0;
+    ctx->bench_collisions = 0;
+    reset_world(ctx, BENCH_SEED, BENCH_COUNTS[0]);
+
+    printf("[Bench] start: %d phases x %d frames, %s kernels, BUILD_ID %d\n",
+           BENCH_PHASES, BENCH_PHASE_FRAMES, SIMD_KERNELS_BACKEND, BUILD_ID);
+}
+
+static int compare_float(const void *a, const void *b) {
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Hash of the positions' bit patterns: equal across builds iff the sim matched
+static unsigned int world_checksum(const Entities *e) {
+    unsigned int h = 2166136261u;
+    for (int i = 0; i < e->count; i++) {
+        unsigned int bits[2];
+        memcpy(&bits[0], &e->x[i], sizeof(float));
+        memcpy(&bits[1], &e->y[i], sizeof(float));
+        h = (h ^ bits[0]) * 16777619u;
+        h = (h ^ bits[1]) * 16777619u;
+    }
+    return h;
+}
+
+static void bench_report_phase(GameContext *ctx) {
+    float *sorted = arena_push_array(&ctx->frame_arena, float, BENCH_PHASE_FRAMES);
+    if (!sorted) return;
+
+    // The native SDL stub's clock only moves between frames (the host
+    // advances it), so every phase reads 0 there: report draw work only and
+    // leave frame cost to the host (Headless prints wall-clock ns/frame)
+    bool clock_moved = false;
+    for (int t = 0; t < TIMING_COUNT && !clock_moved; t++) {
+        for (int i = 0; i < BENCH_PHASE_FRAMES; i++) {
+            if (ctx->bench_samples[t][i] > 0.0f) { clock_moved = true; break; }
+        }
+    }
+
+    printf("[Bench] %5d entities |", ctx->entities.count);
+    if (!clock_moved) printf(" timings n/a (clock frozen within a frame) |");
+    for (int t = 0; t < TIMING_COUNT && clock_moved; t++) {
+        memcpy(sorted, ctx->bench_samples[t], sizeof(float) * BENCH_PHASE_FRAMES);
+        qsort(sorted, BENCH_PHASE_FRAMES, sizeof(float), compare_float);
+        float p50 = sorted[BENCH_PHASE_FRAMES / 2];
+        float p99 = sorted[(BENCH_PHASE_FRAMES * 99) / 100];
+        printf(" %s p50 %.0f p99 %.0f us |", TIMING_NAMES[t], p50, p99);
+    }
+    printf(" collisions %lld | checksum %08x\n", ctx->bench_collisions, world_checksum(&ctx->entities));
+}
+
+// Called once per displayed frame, after the timings are in
+static void bench_end_frame(GameContext *ctx) {
+    if (!ctx->bench_active) return;
+
+    for (int t = 0; t < TIMING_COUNT; t++) {
+        ctx->bench_samples[t][ctx->bench_frame] = ctx->timing_us[t];
+    }
+    ctx->bench_collisions += ctx->collisions;
+
+    if (++ctx->bench_frame < BENCH_PHASE_FRAMES) return;
+
+    bench_report_phase(ctx);
+    ctx->bench_frame = 0;
+    ctx->bench_collisions = 0;
+
+    if (++ctx->bench_phase == BENCH_PHASES) {
+        ctx->bench_active = false;
+        printf("[Bench] done\n");
+        return;
+    }
+    set_entity_count(ctx, BENCH_COUNTS[ctx->bench_phase]);
+}
+
+// ----------------------------------------------------------------------------
+// Input
+// ----------------------------------------------------------------------------
+
+static void handle_events(GameContext *ctx) {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type != SDL_KEYDOWN || event.key.repeat != 0) continue;
+
+        SDL_Keycode key = event.key.keysym.sym;
+        if (key == SDLK_b) {
+            bench_start(ctx);
+            continue;
+        }
+
+        // The bench script owns the world while it runs
+        if (ctx->bench_active) continue;
+
+        if (key == SDLK_UP) {
+            set_entity_count(ctx, ctx->target_count * 2);
+            printf("[Stress] %d entities\n", ctx->entities.count);
+        } else if (key == SDLK_DOWN) {
+            int count = ctx->target_count / 2;
+            set_entity_count(ctx, count < MIN_COUNT ? MIN_COUNT : count);
+            printf("[Stress] %d entities\n", ctx->entities.count);
+        } else if (key == SDLK_r) {
+            reset_world(ctx, BENCH_SEED, ctx->target_count);
+            printf("[R] Reset\n");
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Update
+// ----------------------------------------------------------------------------
+
+// Bounce off the walls: integration and wall scans are simd_kernels.h batches
+static void move_entities(Entities *e) {
+    float max_x = (float)(WINDOW_WIDTH - ENTITY_SIZE);
+    float max_y = (float)(WINDOW_HEIGHT - ENTITY_SIZE);
+    int n = e->count;
+
+    k_add(e->x, e->vx, n);
+    k_add(e->y, e->vy, n);
+
+    for (int i = k_find_lt(e->x, 0.0f, 0, n); i < n; i = k_find_lt(e->x, 0.0f, i + 1, n))  e->vx[i] = fabsf(e->vx[i]);
+    for (int i = k_find_gt(e->x, max_x, 0, n); i < n; i = k_find_gt(e->x, max_x, i + 1, n)) e->vx[i] = -fabsf(e->vx[i]);
+    for (int i = k_find_lt(e->y, 0.0f, 0, n); i < n; i = k_find_lt(e->y, 0.0f, i + 1, n))  e->vy[i] = fabsf(e->vy[i]);
+    for (int i = k_find_gt(e->y, max_y, 0, n); i < n; i = k_find_gt(e->y, max_y, i + 1, n)) e->vy[i] = -fabsf(e->vy[i]);
+
+    k_clamp(e->x, 0.0f, max_x, n);
+    k_clamp(e->y, 0.0f, max_y, n);
+}
+
+// Every entity touching another one reverses. Each entity only writes its own
+// velocity, so the result doesn't depend on the order pairs are found in.
+static void collide_entities(GameContext *ctx) {
+    Entities *e = &ctx->entities;
+    float size = (float)ENTITY_SIZE;
+
+    ArenaTemp scratch = arena_temp_begin(&ctx->frame_arena);
+
+    BpBox *boxes = arena_push_array(&ctx->frame_arena, BpBox, e->count > 0 ? e->count : 1);
+    Broadphase grid;
+    if (!boxes) {
+        printf("[Broadphase] ERROR: frame scratch too small for %d entities\n", e->count);
+        arena_temp_end(scratch);
+        return;
+    }
+    for (int i = 0; i < e->count; i++) boxes[i] = (BpBox){ e->x[i], e->y[i], size, size, i };
+
+    if (!bp_build(&grid, &ctx->frame_arena, boxes, e->count,
+                  0.0f, 0.0f, (float)WINDOW_WIDTH, (float)WINDOW_HEIGHT, BROADPHASE_CELL_SIZE)) {
+        printf("[Broadphase] ERROR: frame scratch too small for %d entities\n", e->count);
+    }
+
+    memset(e->hit, 0, sizeof(bool) * (size_t)e->count);
+    ctx->collisions = 0;
+
+    for (int i = 0; i < e->count; i++) {
+        BpCellRange cr = bp_cells(&grid, e->x[i], e->y[i], size, size);
+        for (int cy = cr.y0; cy <= cr.y1 && !e->hit[i]; cy++) {
+            for (int cx = cr.x0; cx <= cr.x1 && !e->hit[i]; cx++) {
+                int begin, end;
+                bp_cell_span(&grid, cx, cy, &begin, &end);
+                for (int k = begin; ; k++) {
+                    k = k_aabb_first_overlap(e->x[i], e->y[i], size, size,
+                                             grid.box_x, grid.box_y, grid.box_w, grid.box_h, k, end);
+                    if (k == end) break;
+                    if (grid.items[k] == i) continue;   // itself
+                    e->hit[i] = true;
+                    break;
+                }
+            }
+        }
+        if (e->hit[i]) {
+            e->vx[i] = -e->vx[i];
+            e->vy[i] = -e->vy[i];
+            ctx->collisions++;
+        }
+    }
+
+    arena_temp_end(scratch);
+}
+
+static void update(GameContext *ctx) {
+    move_entities(&ctx->entities);
+    collide_entities(ctx);
+
+    // console ticker (the bench prints its own per-phase report)
+    ctx->console_tick++;
+    if (ctx->console_tick >= 120) {
+        ctx->console_tick = 0;
+        if (!ctx->bench_active) {
+            printf("[Stress] %d entities | update %.2f ms | render %.2f ms | present %.2f ms | collisions %d\n",
+                   ctx->entities.count,
+                   ctx->timing_avg_us[TIMING_UPDATE] / 1000.0f,
+                   ctx->timing_avg_us[TIMING_RENDER] / 1000.0f,
+                   ctx->timing_avg_us[TIMING_PRESENT] / 1000.0f,
+                   ctx->collisions);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Render
+// ----------------------------------------------------------------------------
+
+static int hud_bar_width(float us, int full) {
+    int w = (int)(us / HUD_BUDGET_US * (float)full);
+    return w < 1 ? 1 : (w > full ? full : w);
+}
+
+// Shape-only HUD: one bar per timing phase (full width = 16.7 ms), then the
+// frame-time histogram (1 ms buckets, tick at 16 ms) and the bench progress
+static void render_hud(GameContext *ctx, RenderQueue *rq) {
+    const int px = 10, py = 10, bar_w = 200, bar_h = 8;
+    const int hist_y = py + 8 + TIMING_COUNT * (bar_h + 4) + 6, hist_h = 40;
+
+    rq_fill_rect(rq, LAYER_HUD, COLOR_HUD_PANEL,
+                 (SDL_Rect){ px, py, bar_w + 16, hist_y - py + hist_h + 18 });
+
+    for (int t = 0; t < TIMING_COUNT; t++) {
+        int y = py + 8 + t * (bar_h + 4);
+        rq_fill_rect(rq, LAYER_HUD_OVERLAY, TIMING_COLORS[t],
+                     (SDL_Rect){ px + 8, y, hud_bar_width(ctx->timing_avg_us[t], bar_w), bar_h });
+    }
+    rq_draw_rect(rq, LAYER_HUD_OVERLAY, COLOR_HUD_BUDGET,
+                 (SDL_Rect){ px + 8, py + 8, bar_w, TIMING_COUNT * (bar_h + 4) - 4 });
+
+    unsigned int peak = 1;
+    for (int b = 0; b < FRAME_HIST_BUCKETS; b++) {
+        if (ctx->frame_hist[b] > peak) peak = ctx->frame_hist[b];
+    }
+    const int bucket_w = bar_w / FRAME_HIST_BUCKETS;
+    for (int b = 0; b < FRAME_HIST_BUCKETS; b++) {
+        if (ctx->frame_hist[b] == 0) continue;
+        int h = (int)((float)ctx->frame_hist[b] / (float)peak * (float)hist_h);
+        if (h < 1) h = 1;
+        rq_fill_rect(rq, LAYER_HUD_OVERLAY, COLOR_HIST,
+                     (SDL_Rect){ px + 8 + b * bucket_w, hist_y + hist_h - h, bucket_w - 1, h });
+    }
+    rq_fill_rect(rq, LAYER_HUD_OVERLAY, COLOR_HUD_BUDGET,
+                 (SDL_Rect){ px + 8 + 16 * bucket_w, hist_y, 1, hist_h });
+
+    if (ctx->bench_active) {
+        int done = ctx->bench_phase * BENCH_PHASE_FRAMES + ctx->bench_frame;
+        int total = BENCH_PHASES * BENCH_PHASE_FRAMES;
+        rq_fill_rect(rq, LAYER_HUD_OVERLAY, COLOR_BENCH,
+                     (SDL_Rect){ px + 8, hist_y + hist_h + 8, bar_w * done / total, 4 });
+    }
+}
+
+static void render(GameContext *ctx) {
+    SDL_Renderer *ren = ctx->renderer;
+
+    SDL_SetRenderDrawColor(ren, BG_COLOR.r, BG_COLOR.g, BG_COLOR.b, 255);
+    SDL_RenderClear(ren);
+
+    // everything is queued and submitted in batches (render_queue.h)
+    RenderQueue rq;
+    rq_begin(&rq, &ctx->frame_arena, RENDER_QUEUE_CAPACITY);
+
+    rq_draw_rect(&rq, LAYER_BACKGROUND, COLOR_BORDER, (SDL_Rect){ 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT });
+
+    const Entities *e = &ctx->entities;
+    for (int i = 0; i < e->count; i++) {
+        rq_fill_rect(&rq, LAYER_WORLD, e->hit[i] ? COLOR_ENTITY_HIT : COLOR_ENTITY,
+                     (SDL_Rect){ (int)e->x[i], (int)e->y[i], ENTITY_SIZE, ENTITY_SIZE });
+    }
+
+    render_hud(ctx, &rq);
+
+    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
+    rq_flush(&rq, ren);
+}
+
+// ----------------------------------------------------------------------------
+// Frame timing
+// ----------------------------------------------------------------------------
+
+static float elapsed_us(Uint64 from, Uint64 to, double freq) {
+    return (float)((double)(to - from) * 1000000.0 / freq);
+}
+
+static void record_timings(GameContext *ctx, const Uint64 stamps[TIMING_COUNT + 1]) {
+    double freq = (double)SDL_GetPerformanceFrequency();
+    float frame_us = 0.0f;
+
+    for (int t = 0; t < TIMING_COUNT; t++) {
+        float us = elapsed_us(stamps[t], stamps[t + 1], freq);
+        ctx->timing_us[t] = us;
+        ctx->timing_avg_us[t] += (us - ctx->timing_avg_us[t]) * TIMING_SMOOTHING;
+        frame_us += us;
+    }
+
+    int bucket = (int)(frame_us / 1000.0f);
+    if (bucket >= FRAME_HIST_BUCKETS) bucket = FRAME_HIST_BUCKETS - 1;
+    ctx->frame_hist[bucket]++;
+}
+
+// ----------------------------------------------------------------------------
+// Main entry point (called by sdl_app.c each frame)
+// ----------------------------------------------------------------------------
+
+EMSCRIPTEN_KEEPALIVE
+void update_and_render(GameContext *ctx) {
+    if (!memory_init_if_needed(ctx)) return;
+    arena_reset(&ctx->frame_arena);
+
+    if (!ctx->initialized) {
+        reset_world(ctx, BENCH_SEED, START_COUNT);
+        ctx->initialized = true;
+
+        printf("=== STRESS TEST ===\n");
+        printf("BUILD_ID: %d\n", BUILD_ID);
+        printf("Entities: Up/Down (x2 / /2, max %d)\n", MAX_ENTITIES);
+        printf("Benchmark: B (scripted, deterministic)\n");
+        printf("Reset: R\n");
+        printf("HUD: update / render / present vs 16.7 ms, frame-time histogram (1 ms buckets)\n");
+        printf("===================\n");
+    }
+
+    handle_events(ctx);
+
+    Uint64 stamps[TIMING_COUNT + 1];
+    stamps[TIMING_UPDATE] = SDL_GetPerformanceCounter();
+    update(ctx);
+    stamps[TIMING_RENDER] = SDL_GetPerformanceCounter();
+    render(ctx);
+    stamps[TIMING_PRESENT] = SDL_GetPerformanceCounter();
+    SDL_RenderPresent(ctx->renderer);
+    stamps[TIMING_COUNT] = SDL_GetPerformanceCounter();
+
+    record_timings(ctx, stamps);
+    bench_end_frame(ctx);
+}
@@ -0,0 +1,76 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "base_arena.h"
+
+#define WINDOW_WIDTH   640
+#define WINDOW_HEIGHT  480
+
+// Entity limit; the live count is changed at runtime (Up/Down, bench script)
+#define MAX_ENTITIES   16384
+
+// Per-frame scratch memory (reset at the top of update_and_render): render
+// queue + flush rects, collision grid ids + boxes, all sized per entity
+#define FRAME_SCRATCH_SIZE  (256 * 1024 + MAX_ENTITIES * 192)
+
+// Frame-time histogram: 1 ms buckets, the last one collects everything slower
+#define FRAME_HIST_BUCKETS  34
+
+// Scripted benchmark: samples kept per phase for the percentiles
+#define BENCH_PHASE_FRAMES  300
+
+// Moving boxes, struct-of-arrays (see entity_pool.h / simd_kernels.h)
+#define ENTITY_FIELDS(X) \
+    X(float, x) X(float, y) X(float, vx) X(float, vy) X(bool, hit) X(bool, alive)
+
+#define ENTITY_ARRAY(type, name) type name[MAX_ENTITIES];
+
+typedef struct {
+    ENTITY_FIELDS(ENTITY_ARRAY)
+    int count;
+} Entities;
+
+// Frame phases timed separately (HUD bars, bench percentiles)
+typedef enum {
+    TIMING_UPDATE,
+    TIMING_RENDER,
+    TIMING_PRESENT,
+    TIMING_COUNT
+} TimingPhase;
+
+typedef struct {
+    SDL_Renderer *renderer;
+
+    // Live-coding friendly: all runtime state is stored here
+    bool initialized;
+
+    // World
+    unsigned int rng_state;
+    Entities entities;
+    int target_count;
+    int collisions;              // entities touching another one this step
+
+    // Frame timing in microseconds: last frame and smoothed (HUD)
+    float timing_us[TIMING_COUNT];
+    float timing_avg_us[TIMING_COUNT];
+    unsigned int frame_hist[FRAME_HIST_BUCKETS];
+
+    // Scripted benchmark (B): fixed seed + fixed count schedule, ignores input
+    bool bench_active;
+    int bench_phase;
+    int bench_frame;
+    float bench_samples[TIMING_COUNT][BENCH_PHASE_FRAMES];
+    long long bench_collisions;
+
+    // Game memory: every buffer the game owns lives in this one block
+    Arena arena;                 // base == NULL until first run
+    Arena frame_arena;           // scratch carved from arena, reset each frame
+
+    // debug/console ticker
+    int console_tick;
+} GameContext;
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+// ----------------------------------------------------------------------------
+// Render queue
+//
+// Collects the frame's primitives in frame-scratch memory, then submits them
+// in bulk: runs of same-coloured rects go out as one SDL_RenderFillRects /
+// SDL_RenderDrawRects call, and every circle in a layer becomes one
+// SDL_RenderGeometry triangle batch (colour is per-vertex, so no state change).
+//
+// Commands are sorted by (layer, kind, colour); submission order is kept for
+// equal keys. Layers are the only ordering guarantee: primitives that must
+// overlap in a specific order go on different layers.
+//
+// Header-only, no globals (hot-reload safe).
+// ----------------------------------------------------------------------------
+
+#include <SDL2/SDL.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "base_arena.h"
+
+#define RQ_CIRCLE_SEGMENTS 20
+
+typedef enum {
+    RQ_FILL_RECT,
+    RQ_DRAW_RECT,
+    RQ_CIRCLE
+} RenderCmdKind;
+
+typedef struct {
+    Uint64 key;          // layer | kind | rgba, see rq_key
+    int seq;             // submission order, tie-break for a stable sort
+    SDL_Rect rect;       // circles: x, y = centre, w = radius
+    SDL_Color color;
+} RenderCmd;
+
+typedef struct {
+    RenderCmd *cmds;
+    int count;
+    int capacity;
+    int dropped;         // commands that didn't fit this frame
+    int draw_calls;      // submitted by the last rq_flush
+    Arena *scratch;
+} RenderQueue;
+
+static inline Uint64 rq_key(int layer, RenderCmdKind kind, SDL_Color c) {
+    Uint32 rgba = ((Uint32)c.r << 24) | ((Uint32)c.g << 16) | ((Uint32)c.b << 8) | c.a;
+    return ((Uint64)(layer & 0xFF) << 40) | ((Uint64)kind << 32) | rgba;
+}
+
+static inline int rq_layer_of(Uint64 key) { return (int)((key >> 40) & 0xFF); }
+static inline RenderCmdKind rq_kind_of(Uint64 key) { return (RenderCmdKind)((key >> 32) & 0xFF); }
+
+// The command buffer comes from `scratch` (frame arena) and is valid until it resets
+static inline void rq_begin(RenderQueue *q, Arena *scratch, int capacity) {
+    q->scratch = scratch;
+    q->cmds = arena_push_array(scratch, RenderCmd, capacity);
+    q->capacity = q->cmds ? capacity : 0;
+    q->count = 0;
+    q->dropped = 0;
+    q->draw_calls = 0;
+}
+
+static inline void rq_push(RenderQueue *q, int layer, RenderCmdKind kind, SDL_Color color, SDL_Rect rect) {
+    if (q->count == q->capacity) { q->dropped++; return; }
+    RenderCmd *c = &q->cmds[q->count];
+    c->key = rq_key(layer, kind, color);
+    c->seq = q->count;
+    c->rect = rect;
+    c->color = color;
+    q->count++;
+}
+
+static inline void rq_fill_rect(RenderQueue *q, int layer, SDL_Color color, SDL_Rect rect) {
+    rq_push(q, layer, RQ_FILL_RECT, color, rect);
+}
+
+static inline void rq_draw_rect(RenderQueue *q, int layer, SDL_Color color, SDL_Rect rect) {
+    rq_push(q, layer, RQ_DRAW_RECT, color, rect);
+}
+
+static inline void rq_circle(RenderQueue *q, int layer, SDL_Color color, int cx, int cy, int r) {
+    rq_push(q, layer, RQ_CIRCLE, color, (SDL_Rect){ cx, cy, r, r });
+}
+
+static int rq_compare(const void *a, const void *b) {
+    const RenderCmd *x = (const RenderCmd*)a, *y = (const RenderCmd*)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return x->seq - y->seq;
+}
+
+// One SDL_RenderGeometry call for circles [first, last): triangle fans sharing
+// a single vertex/index buffer.
+static inline int rq_flush_circles(RenderQueue *q, SDL_Renderer *ren, int first, int last) {
+    int n = last - first;
+    int verts_per = RQ_CIRCLE_SEGMENTS + 1;
+    SDL_Vertex *verts = arena_push_array(q->scratch, SDL_Vertex, n * verts_per);
+    int *indices = arena_push_array(q->scratch, int, n * RQ_CIRCLE_SEGMENTS * 3);
+    if (!verts || !indices) return 0;
+
+    // Unit circle by rotation, computed once per batch
+    float step = 6.28318530718f / RQ_CIRCLE_SEGMENTS;
+    float cs = cosf(step), sn = sinf(step);
+
+    SDL_Vertex *v = verts;
+    int *idx = indices;
+    for (int i = 0; i < n; i++) {
+        const RenderCmd *c = &q->cmds[first + i];
+        float cx = (float)c->rect.x, cy = (float)c->rect.y, r = (float)c->rect.w;
+        int base = i * verts_per;
+
+        v->position = (SDL_FPoint){ cx, cy };
+        v->color = c->color;
+        v++;
+
+        float ux = 1.0f, uy = 0.0f;
+        for (int s = 0; s < RQ_CIRCLE_SEGMENTS; s++) {
+            v->position = (SDL_FPoint){ cx + ux * r, cy + uy * r };
+            v->color = c->color;
+            v++;
+
+            float nx = ux * cs - uy * sn;
+            uy = ux * sn + uy * cs;
+            ux = nx;
+
+            *idx++ = base;
+            *idx++ = base + 1 + s;
+            *idx++ = base + 1 + (s + 1) % RQ_CIRCLE_SEGMENTS;
+        }
+    }
+
+    SDL_RenderGeometry(ren, NULL, verts, n * verts_per, indices, n * RQ_CIRCLE_SEGMENTS * 3);
+    return 1;
+}
+
+static inline void rq_flush(RenderQueue *q, SDL_Renderer *ren) {
+    q->draw_calls = 0;
+    if (q->count == 0) return;
+
+    qsort(q->cmds, q->count, sizeof(RenderCmd), rq_compare);
+
+    ArenaTemp temp = arena_temp_begin(q->scratch);
+    int i = 0;
+    while (i < q->count) {
+        Uint64 key = q->cmds[i].key;
+        RenderCmdKind kind = rq_kind_of(key);
+        int j = i + 1;
+
+        if (kind == RQ_CIRCLE) {
+            // Circles batch across colours: extend the run to the whole layer
+            int layer = rq_layer_of(key);
+            while (j < q->count && rq_kind_of(q->cmds[j].key) == RQ_CIRCLE &&
+                   rq_layer_of(q->cmds[j].key) == layer) j++;
+            q->draw_calls += rq_flush_circles(q, ren, i, j);
+        } else {
+            while (j < q->count && q->cmds[j].key == key) j++;
+
+            SDL_Rect *rects = arena_push_array(q->scratch, SDL_Rect, j - i);
+            if (rects) {
+                for (int k = i; k < j; k++) rects[k - i] = q->cmds[k].rect;
+                SDL_Color c = q->cmds[i].color;
+                SDL_SetRenderDrawColor(ren, c.r, c.g, c.b, c.a);
+                if (kind == RQ_FILL_RECT) SDL_RenderFillRects(ren, rects, j - i);
+                else                      SDL_RenderDrawRects(ren, rects, j - i);
+                q->draw_calls++;
+            }
+        }
+        i = j;
+    }
+    arena_temp_end(temp);
+
+    q->count = 0;
+}
+
+#endif